@@ -231,6 +231,10 @@ typedef enum
 #define RAM_D2 __attribute__ ((section(".RAM_D2_buf"), used)) 
 #define RAM_D3 __attribute__ ((section(".RAM_D3_buf"), used)) 
 
+// DMA buffers in AXI SRAM: cache line aligned and padded, so cache
+// maintenance by address never touches a neighbouring variable
+#define RAM_D1_DMA __attribute__ ((section(".RAM_D1_dma"), aligned(32), used))
+
 
 #include "system_stm32h7xx.h"
 #include <stdint.h>
@@ -0,0 +1,602 @@
+/**
+ * @file bench_mem.c
+ * @brief Bandwidth and latency of each H743 RAM: bench mem
+ * @author Mikhael Kaa (Михаил Каа)
+ * @date 17.10.2026
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "ucmd.h"
+#include "bench_mem.h"
+#include "mem_xfer.h"
+#ifdef BAREMETAL
+#include <unistd.h>
+#include "stm32h743xx.h"
+#include "job.h"
+#else
+#include <time.h>
+#endif
+
+#undef ENDL // microrl config.h has its own
+#ifdef BAREMETAL
+#define ENDL "\r\n"
+#else
+#define ENDL "\n"
+#endif // BAREMETAL
+
+// Chase stride, one load per D-cache line
+#define BENCH_LINE 32U
+
+typedef enum bench_test
+{
+    BENCH_READ = 0,
+    BENCH_WRITE,
+    BENCH_COPY,
+    BENCH_FILL,
+    BENCH_CHASE,
+} bench_test_t;
+
+static const char* const bench_test_names[] = {"read", "write", "copy", "fill", "chase"};
+
+typedef enum bench_fmt
+{
+    BENCH_BOTH = 0,
+    BENCH_TABLE,
+    BENCH_CSV,
+} bench_fmt_t;
+
+static const char* const bench_fmt_names[] = {"both", "table", "csv", NULL};
+
+/**
+ * struct bench_row - One measurement
+ * @region: Index in bench_regions
+ * @cache: D-cache was on
+ * @test: bench_test_t
+ * @engine: mem_xfer_engine_t, MEM_XFER_CPU or MEM_XFER_MDMA
+ * @bits: Access width
+ * @bytes: Read, written or copied by one run
+ * @cycles: Fastest run
+ * @steps: Chase, loads per run
+ */
+typedef struct bench_row
+{
+    uint8_t  region;
+    uint8_t  cache;
+    uint8_t  test;
+    uint8_t  engine;
+    uint8_t  bits;
+    uint32_t bytes;
+    uint32_t cycles;
+    uint32_t steps;
+} bench_row_t;
+
+// read and write at 4 widths, copy and fill on 2 engines, chase
+#define BENCH_ROWS_REGION (4 + 4 + 2 + 2 + 1)
+
+// Time base, CPU clocks on the target
+#ifdef BAREMETAL
+#define BENCH_CLOCK() (DWT->CYCCNT)
+#define BENCH_HZ      SystemCoreClock
+
+static inline uint32_t bench_lock(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    return primask;
+}
+
+static inline void bench_unlock(uint32_t primask)
+{
+    __set_PRIMASK(primask);
+}
+#else
+static uint32_t bench_clock(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec);
+}
+#define BENCH_CLOCK() bench_clock()
+#define BENCH_HZ      1000000000U
+
+static inline uint32_t bench_lock(void)
+{
+    return 0;
+}
+
+static inline void bench_unlock(uint32_t primask)
+{
+    (void)primask;
+}
+#endif // BAREMETAL
+
+/*
+ * Where each region is measured: from its free end (linker script) up
+ * to BENCH_MEM_LEN. DTCM holds data, bss, heap and stack, it gets a heap
+ * buffer that must end below the stack. The host has the heap only
+ */
+typedef struct bench_region
+{
+    const char*    name;
+    const uint8_t* free; // NULL: heap
+    uintptr_t      end;
+} bench_region_t;
+
+#ifdef BAREMETAL
+extern uint8_t __itcm_free[];
+extern uint8_t __ram_d1_free[];
+extern uint8_t __ram_d2_free[];
+extern uint8_t __ram_d3_free[];
+
+static const bench_region_t bench_regions[] = {
+    {"itcm", __itcm_free, 0x00010000},     {"dtcm", NULL, 0},
+    {"ram_d1", __ram_d1_free, 0x24080000}, {"ram_d2", __ram_d2_free, 0x30048000},
+    {"ram_d3", __ram_d3_free, 0x38010000},
+};
+static const char* const bench_region_names[] = {"itcm", "dtcm", "ram_d1", "ram_d2", "ram_d3", "all", NULL};
+#else
+static const bench_region_t bench_regions[]     = {{"heap", NULL, 0}};
+static const char* const    bench_region_names[] = {"heap", "all", NULL};
+#endif // BAREMETAL
+
+#define BENCH_REGIONS (sizeof(bench_regions) / sizeof(bench_regions[0]))
+
+#ifdef BAREMETAL
+extern uint8_t _estack[];
+extern uint8_t _Min_Stack_Size[];
+
+// Stack kept below the current SP, for the calls and interrupts on top
+#define BENCH_STACK_GAP 4096U
+
+// The nosys _sbrk() grows the heap into the stack unchecked: bytes from
+// the break up to the stack
+static uint32_t bench_heap_room(void)
+{
+    uintptr_t top = (uintptr_t)_estack - (uintptr_t)_Min_Stack_Size;
+    uintptr_t sp  = __get_MSP() - BENCH_STACK_GAP;
+    uintptr_t brk = (uintptr_t)sbrk(0);
+
+    top = sp < top ? sp : top;
+    return top > brk ? (uint32_t)(top - brk) : 0U;
+}
+#else
+static uint32_t bench_heap_room(void)
+{
+    return UINT32_MAX;
+}
+#endif // BAREMETAL
+
+// Cache on and off per region
+#define BENCH_ROWS (BENCH_REGIONS * 2U * BENCH_ROWS_REGION)
+
+/**
+ * struct bench_mem_state - One bench mem run, the job keeps a pointer
+ * @region: Next to measure
+ * @last: Last to measure
+ * @fmt: bench_fmt_t
+ * @count: Rows so far
+ * @row: Kept for the CSV block at the end
+ */
+typedef struct bench_mem_state
+{
+    uint8_t     region;
+    uint8_t     last;
+    uint8_t     fmt;
+    uint16_t    count;
+    bench_row_t row[BENCH_ROWS];
+} bench_mem_state_t;
+
+static bench_mem_state_t bench_mem_run_state;
+
+// Reads feed it, so they can't be optimised away
+static volatile uint32_t bench_sink;
+
+// Sweeps for one width, four accesses per iteration, @len a multiple of 32
+#define BENCH_KERNELS(W, T)                                                   \
+    static uint32_t bench_read##W(uintptr_t a, uint32_t len)                  \
+    {                                                                         \
+        const volatile T* p   = (const volatile T*)a;                         \
+        const volatile T* end = (const volatile T*)(a + len);                 \
+        T                 acc = 0;                                            \
+        for (; p < end; p += 4)                                               \
+        {                                                                     \
+            acc ^= (T)(p[0] ^ p[1] ^ p[2] ^ p[3]);                            \
+        }                                                                     \
+        return (uint32_t)acc;                                                 \
+    }                                                                         \
+                                                                              \
+    static uint32_t bench_write##W(uintptr_t a, uint32_t len)                 \
+    {                                                                         \
+        volatile T* p   = (volatile T*)a;                                     \
+        volatile T* end = (volatile T*)(a + len);                             \
+        const T     v   = (T)0xa5a5a5a5a5a5a5a5ULL;                           \
+        for (; p < end; p += 4)                                               \
+        {                                                                     \
+            p[0] = v;                                                         \
+            p[1] = v;                                                         \
+            p[2] = v;                                                         \
+            p[3] = v;                                                         \
+        }                                                                     \
+        return 0;                                                             \
+    }
+
+BENCH_KERNELS(8, uint8_t)
+BENCH_KERNELS(16, uint16_t)
+BENCH_KERNELS(32, uint32_t)
+BENCH_KERNELS(64, uint64_t)
+
+typedef uint32_t (*bench_fn_t)(uintptr_t a, uint32_t len);
+
+static const struct
+{
+    uint8_t    bits;
+    bench_fn_t read;
+    bench_fn_t write;
+} bench_widths[] = {
+    {8, bench_read8, bench_write8},
+    {16, bench_read16, bench_write16},
+    {32, bench_read32, bench_write32},
+    {64, bench_read64, bench_write64},
+};
+
+static uint32_t bench_cpu(bench_fn_t fn, uintptr_t a, uint32_t len)
+{
+    uint32_t best = UINT32_MAX;
+
+    for (int r = 0; r < BENCH_MEM_REPS; r++)
+    {
+        uint32_t irq = bench_lock();
+        uint32_t t0  = BENCH_CLOCK();
+        bench_sink ^= fn(a, len);
+        uint32_t c = BENCH_CLOCK() - t0;
+        bench_unlock(irq);
+        best = c < best ? c : best;
+    }
+    return best;
+}
+
+// Copy the lower half to the upper one or fill it all, 0 if the engine
+// can't run it now (MDMA busy)
+static uint32_t bench_xfer(int op, int engine, uintptr_t a, uint32_t len)
+{
+    uint32_t   best = UINT32_MAX;
+    mem_xfer_t x;
+
+    for (int r = 0; r < BENCH_MEM_REPS; r++)
+    {
+        x = (mem_xfer_t){.dst = a, .src = a, .len = len, .pattern = 0x5aa55aa5U, .op = (uint8_t)op};
+        if (op == MEM_XFER_COPY)
+        {
+            x.dst = a + len / 2U;
+            x.len = len / 2U;
+        }
+        // The MDMA completion is an interrupt, it runs unlocked
+        uint32_t irq = engine == MEM_XFER_CPU ? bench_lock() : 0;
+        int      ret = mem_xfer_start(&x, engine);
+        bench_unlock(irq);
+        if (ret < 0)
+        {
+            return 0;
+        }
+        while (x.status == -EINPROGRESS)
+        {
+        }
+        if (x.status < 0)
+        {
+            return 0;
+        }
+        best = x.cycles < best ? x.cycles : best;
+    }
+    return best;
+}
+
+// One cycle through all lines in random order (Sattolo's shuffle), so
+// every load depends on the one before and the prefetcher can't help
+static void bench_chase_init(uintptr_t a, uint32_t n)
+{
+    uint32_t seed = 0x2545f491U;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        *(uint32_t*)(a + i * BENCH_LINE) = i;
+    }
+    for (uint32_t i = n - 1U; i > 0; i--)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        uint32_t  j  = seed % i;
+        uint32_t* si = (uint32_t*)(a + i * BENCH_LINE);
+        uint32_t* sj = (uint32_t*)(a + j * BENCH_LINE);
+        uint32_t  t  = *si;
+        *si          = *sj;
+        *sj          = t;
+    }
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint32_t next                    = *(uint32_t*)(a + i * BENCH_LINE);
+        *(uintptr_t*)(a + i * BENCH_LINE) = a + next * BENCH_LINE;
+    }
+}
+
+// @steps a multiple of 4
+static uint32_t bench_chase(uintptr_t a, uint32_t steps)
+{
+    uint32_t best = UINT32_MAX;
+
+    for (int r = 0; r < BENCH_MEM_REPS; r++)
+    {
+        uintptr_t p   = a;
+        uint32_t  irq = bench_lock();
+        uint32_t  t0  = BENCH_CLOCK();
+        for (uint32_t i = 0; i < steps; i += 4U)
+        {
+            p = *(volatile uintptr_t*)p;
+            p = *(volatile uintptr_t*)p;
+            p = *(volatile uintptr_t*)p;
+            p = *(volatile uintptr_t*)p;
+        }
+        uint32_t c = BENCH_CLOCK() - t0;
+        bench_unlock(irq);
+        bench_sink ^= (uint32_t)p;
+        best = c < best ? c : best;
+    }
+    return best;
+}
+
+static void bench_print(FILE* out, const bench_row_t* r, int csv)
+{
+    // integer math, MB/s * 10 and ns * 10
+    uint64_t mbps10 = r->cycles ? (uint64_t)r->bytes * 10U * BENCH_HZ / r->cycles / 1000000U : 0;
+    uint64_t ns10   = r->steps ? (uint64_t)r->cycles * 10000000000ULL / BENCH_HZ / r->steps : 0;
+
+    if (csv)
+    {
+        fprintf(out, "csv,%s,%s,%s,%s,%u,%lu,%lu,", bench_regions[r->region].name, r->cache ? "on" : "off",
+                bench_test_names[r->test], mem_xfer_engine_names[r->engine], r->bits, (unsigned long)r->bytes,
+                (unsigned long)r->cycles);
+        if (r->test == BENCH_CHASE)
+        {
+            fprintf(out, ",%lu.%lu" ENDL, (unsigned long)(ns10 / 10U), (unsigned long)(ns10 % 10U));
+        }
+        else
+        {
+            fprintf(out, "%lu.%lu," ENDL, (unsigned long)(mbps10 / 10U), (unsigned long)(mbps10 % 10U));
+        }
+        return;
+    }
+
+    fprintf(out, "%-7s %-5s %-5s %-6s %4u ", bench_regions[r->region].name, r->cache ? "on" : "off",
+            bench_test_names[r->test], mem_xfer_engine_names[r->engine], r->bits);
+    if (r->test == BENCH_CHASE)
+    {
+        fprintf(out, "%10s %7lu.%lu" ENDL, "-", (unsigned long)(ns10 / 10U), (unsigned long)(ns10 % 10U));
+    }
+    else
+    {
+        fprintf(out, "%8lu.%lu %9s" ENDL, (unsigned long)(mbps10 / 10U), (unsigned long)(mbps10 % 10U), "-");
+    }
+}
+
+static void bench_add(FILE* out, bench_mem_state_t* st, bench_row_t row)
+{
+    if (row.cycles == 0 || st->count >= BENCH_ROWS)
+    {
+        return;
+    }
+    st->row[st->count++] = row;
+    if (st->fmt != BENCH_CSV)
+    {
+        bench_print(out, &row, 0);
+    }
+}
+
+// All tests on one buffer with the D-cache as it is now
+static void bench_run(FILE* out, bench_mem_state_t* st, uint8_t region, uint8_t cache, uintptr_t a, uint32_t len)
+{
+    bench_row_t row = {.region = region, .cache = cache, .engine = MEM_XFER_CPU, .bytes = len};
+
+    for (size_t w = 0; w < sizeof(bench_widths) / sizeof(bench_widths[0]); w++)
+    {
+        row.bits   = bench_widths[w].bits;
+        row.test   = BENCH_READ;
+        row.cycles = bench_cpu(bench_widths[w].read, a, len);
+        bench_add(out, st, row);
+        row.test   = BENCH_WRITE;
+        row.cycles = bench_cpu(bench_widths[w].write, a, len);
+        bench_add(out, st, row);
+    }
+
+    // mem_xfer moves 64 bit words on the CPU, the MDMA in 64 bit beats
+    row.bits = 64;
+    for (uint8_t engine = MEM_XFER_CPU; engine <= MEM_XFER_MDMA; engine++)
+    {
+        row.engine = engine;
+        row.test   = BENCH_COPY;
+        row.bytes  = len / 2U;
+        row.cycles = bench_xfer(MEM_XFER_COPY, engine, a, len);
+        bench_add(out, st, row);
+        row.test   = BENCH_FILL;
+        row.bytes  = len;
+        row.cycles = bench_xfer(MEM_XFER_FILL, engine, a, len);
+        bench_add(out, st, row);
+    }
+
+    // Two laps, the first one warms the cache where it can
+    uint32_t lines = len / BENCH_LINE;
+    bench_chase_init(a, lines);
+    row.engine = MEM_XFER_CPU;
+    row.test   = BENCH_CHASE;
+    row.bits   = (uint8_t)(sizeof(uintptr_t) * 8U);
+    row.bytes  = 0;
+    row.steps  = lines * 2U;
+    row.cycles = bench_chase(a, row.steps);
+    bench_add(out, st, row);
+}
+
+// Measure one region with the cache on, then off
+static void bench_region(FILE* out, bench_mem_state_t* st, uint8_t region)
+{
+    const bench_region_t* r    = &bench_regions[region];
+    void*                 heap = NULL;
+    uintptr_t             a;
+    uint32_t              len;
+
+    if (r->free == NULL)
+    {
+        // A block from the free list sits below the break, a new one
+        // moves it up by the size and a chunk header
+        uint32_t room = bench_heap_room();
+
+        for (len = BENCH_MEM_LEN; len >= 4096U && heap == NULL; len /= 2U)
+        {
+            if (len + 2U * BENCH_LINE <= room)
+            {
+                heap = malloc(len + BENCH_LINE);
+            }
+        }
+        if (heap == NULL)
+        {
+            fprintf(out, "%-7s no heap below the stack for a buffer" ENDL, r->name);
+            return;
+        }
+        len *= 2U;
+        a = ((uintptr_t)heap + BENCH_LINE - 1U) & ~(uintptr_t)(BENCH_LINE - 1U);
+    }
+    else
+    {
+        a   = ((uintptr_t)r->free + BENCH_LINE - 1U) & ~(uintptr_t)(BENCH_LINE - 1U);
+        len = r->end > a ? (uint32_t)(r->end - a) : 0U;
+        len = (len > BENCH_MEM_LEN ? BENCH_MEM_LEN : len) & ~(2U * BENCH_LINE - 1U);
+        if (len < 4096U)
+        {
+            fprintf(out, "%-7s only %lu bytes free" ENDL, r->name, (unsigned long)len);
+            return;
+        }
+    }
+
+#ifdef BAREMETAL
+    if (SCB->CCR & SCB_CCR_DC_Msk)
+    {
+        bench_run(out, st, region, 1, a, len);
+
+        // SCB_DisableDCache() turns the cache off before it cleans it, a
+        // store of an interrupt in between would be overwritten by a
+        // stale dirty line. The enable is locked the same way
+        uint32_t irq = bench_lock();
+        SCB_DisableDCache();
+        bench_unlock(irq);
+        bench_run(out, st, region, 0, a, len);
+        irq = bench_lock();
+        SCB_EnableDCache();
+        bench_unlock(irq);
+    }
+    else
+    {
+        bench_run(out, st, region, 0, a, len);
+    }
+#else
+    bench_run(out, st, region, 1, a, len);
+#endif // BAREMETAL
+
+    free(heap);
+}
+
+static void bench_header(FILE* out, const bench_mem_state_t* st)
+{
+    if (st->fmt != BENCH_CSV)
+    {
+        fprintf(out, "%lu bytes per region, best of %d, copy counts bytes copied" ENDL, (unsigned long)BENCH_MEM_LEN,
+                BENCH_MEM_REPS);
+        fprintf(out, "region  cache test  engine bits       MB/s   ns/load" ENDL);
+    }
+}
+
+static void bench_csv(FILE* out, const bench_mem_state_t* st)
+{
+    if (st->fmt == BENCH_TABLE)
+    {
+        return;
+    }
+    fprintf(out, "csv,region,cache,test,engine,bits,bytes,cycles,mbps,ns" ENDL);
+    for (uint16_t i = 0; i < st->count; i++)
+    {
+        bench_print(out, &st->row[i], 1);
+    }
+}
+
+static const uarg_spec_t bench_mem_args =
+    UARG_SPEC("bench mem", UARG_OPT_ENUM("[region|all]", bench_region_names, BENCH_REGIONS),
+              UARG_OPT_ENUM("[both|table|csv]", bench_fmt_names, BENCH_BOTH));
+
+#ifdef BAREMETAL
+// One region per slice, a region takes some ms
+static int bench_mem_job(job_t* job)
+{
+    bench_mem_state_t* st = *(bench_mem_state_t**)job->data;
+
+    JOB_BEGIN(job);
+    job->total = (uint32_t)(st->last - st->region + 1U);
+    bench_header(job->session->out, st);
+    while (st->region <= st->last)
+    {
+        bench_region(job->session->out, st, st->region);
+        st->region++;
+        job->done++;
+        JOB_YIELD(job);
+    }
+    bench_csv(job->session->out, st);
+    JOB_END(job);
+}
+#endif // BAREMETAL
+
+static int bench_cmd_mem(ucmd_session_t* s, int argc, char* argv[])
+{
+    bench_mem_state_t* st = &bench_mem_run_state;
+    uarg_val_t         v[2];
+
+    if (uarg_parse(s->out, &bench_mem_args, argc, argv, v) < 0)
+    {
+        return -EINVAL;
+    }
+#ifdef BAREMETAL
+    if (job_find(bench_mem_job) >= 0)
+    {
+        fprintf(s->out, "bench mem is already running" ENDL);
+        return -EBUSY;
+    }
+#endif
+    st->count  = 0;
+    st->fmt    = (uint8_t)v[1].u;
+    st->region = v[0].u < BENCH_REGIONS ? (uint8_t)v[0].u : 0U;
+    st->last   = v[0].u < BENCH_REGIONS ? (uint8_t)v[0].u : (uint8_t)(BENCH_REGIONS - 1U);
+
+#ifdef BAREMETAL
+    int id = job_start(s, "bench mem", bench_mem_job, &st, sizeof(st));
+    if (id < 0)
+    {
+        fprintf(s->out, "Can't start job: %d" ENDL, id);
+        return id;
+    }
+#else
+    bench_header(s->out, st);
+    for (; st->region <= st->last; st->region++)
+    {
+        bench_region(s->out, st, st->region);
+    }
+    bench_csv(s->out, st);
+#endif
+    return 0;
+}
+
+UCMD_REGISTER(bench, "bench", NULL, "benchmarks, use bench help");
+UCMD_REGISTER_ARGS(bench_mem, "bench.mem", bench_cmd_mem, "RAM bandwidth and latency, overwrites free RAM",
+                   bench_mem_args);
+
+#undef ENDL
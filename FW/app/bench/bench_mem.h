@@ -0,0 +1,30 @@
+/**
+ * @file bench_mem.h
+ * @brief Bandwidth and latency of each H743 RAM: bench mem
+ * @author Mikhael Kaa (Михаил Каа)
+ * @date 17.10.2026
+ */
+
+#ifndef _BENCH_MEM_
+#define _BENCH_MEM_
+
+#include <stdint.h>
+
+// The bench commands register themselves (bench.mem), see UCMD_REGISTER
+// in ucmd.h
+//
+// Per region, with the D-cache on and off:
+//   read, write - CPU sweeps with 8, 16, 32 and 64 bit accesses
+//   copy, fill  - CPU (mem_xfer, 64 bit) against the MDMA
+//   chase       - dependent loads over a random cycle of cache lines
+// The buffer is the free end of the region (dtcm: heap), it is
+// overwritten. Times are the best of BENCH_MEM_REPS runs, in CPU clocks
+// (DWT CYCCNT) with interrupts off, MDMA runs include cache maintenance
+
+// Buffer per region, the lower half is copied to the upper one
+#define BENCH_MEM_LEN  (64U * 1024U)
+
+// Runs per measurement, the fastest counts
+#define BENCH_MEM_REPS 4
+
+#endif /* _BENCH_MEM_ */
@@ -60,13 +60,20 @@ use Ctrl+A(B,F,P,N,A,E,H,K,U,C) see README, but decrease code memory.*/
 #define _USE_ESC_SEQ
 
 /*
-Use snprintf from you standard complier library, but it gives some overhead.
-If not defined, use my own u16int_to_str variant, it's save about 800 byte of code size
-on AVR (avr-gcc build).
-Try to build with and without, and compare total code size for tune library.
+Include <stdio.h>, only _HISTORY_DEBUG needs it now: ESC sequences are built
+by out_esc() straight into the output buffer, without snprintf.
 */
 #define _USE_LIBC_STDIO
 
+/*
+Output buffer length. Echo, cursor moves and line redraws collect here and go
+to the 'print' callback in one piece: before 'execute' and 'sigint' callbacks,
+when full and on microrl_flush(), call it after feeding each input batch.
+Set 0 to print every fragment at once.*/
+#ifndef _OUT_BUF_LEN
+#define _OUT_BUF_LEN (128U)
+#endif
+
 /*
 Enable 'interrupt signal' callback, if user press Ctrl+C */
 #define _USE_CTLR_C
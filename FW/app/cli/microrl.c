@@ -212,104 +212,130 @@ static int split (microrl_t * pThis, int limit, char const ** tkn_arr)
 
 
 //*****************************************************************************
-inline static void print_prompt (microrl_t * pThis)
+void microrl_flush (microrl_t * pThis)
 {
-    pThis->print (pThis->prompt_str);
+#if _OUT_BUF_LEN > 0
+    if (pThis->out_len > 0) {
+        pThis->out [pThis->out_len] = '\0';
+        pThis->print (pThis->out);
+        pThis->out_len = 0;
+    }
+#else
+    (void)pThis;
+#endif
 }
 
 //*****************************************************************************
-inline static void terminal_backspace (microrl_t * pThis)
+// all terminal output goes through here, see _OUT_BUF_LEN
+static void out_str (microrl_t * pThis, const char * str)
 {
-        pThis->print ("\033[D \033[D");
+#if _OUT_BUF_LEN > 0
+    while (*str) {
+        if (pThis->out_len >= (int)_OUT_BUF_LEN - 1)
+            microrl_flush (pThis);
+        pThis->out [pThis->out_len++] = *str++;
+    }
+#else
+    pThis->print (str);
+#endif
 }
 
 //*****************************************************************************
-inline static void terminal_newline (microrl_t * pThis)
+static void out_mem (microrl_t * pThis, const char * buf, int len)
+{
+#if _OUT_BUF_LEN > 0
+    while (len > 0) {
+        int n = (int)_OUT_BUF_LEN - 1 - pThis->out_len;
+        if (n == 0) {
+            microrl_flush (pThis);
+            continue;
+        }
+        if (n > len)
+            n = len;
+        memcpy (pThis->out + pThis->out_len, buf, (size_t)n);
+        pThis->out_len += n;
+        buf += n;
+        len -= n;
+    }
+#else
+    char str [2] = {0, 0};
+    for (int i = 0; i < len; i++) {
+        str [0] = buf [i];
+        pThis->print (str);
+    }
+#endif
+}
+
+//*****************************************************************************
+inline static void out_char (microrl_t * pThis, char ch)
 {
-    pThis->print (ENDL);
+    char str [] = {ch, '\0'};
+    out_str (pThis, str);
 }
 
-#ifndef _USE_LIBC_STDIO
 //*****************************************************************************
-// convert 16 bit value to string
-// 0 value not supported!!! just make empty string
-// Returns pointer to a buffer tail
-static char *u16bit_to_str (unsigned int nmb, char * buf)
+// ESC [ <n> <cmd>, no snprintf
+static void out_esc (microrl_t * pThis, unsigned int n, char cmd)
 {
-    char tmp_str [6] = {0,};
-    int i = 0, j;
-    if (nmb <= 0xFFFF) {
-        while (nmb > 0) {
-            tmp_str[i++] = (nmb % 10) + '0';
-            nmb /=10;
-        }
-        for (j = 0; j < i; ++j)
-            *(buf++) = tmp_str [i-j-1];
-    }
-    *buf = '\0';
-    return buf;
+    char str [16];
+    char * p = str + sizeof (str);
+
+    *--p = '\0';
+    *--p = cmd;
+    do {
+        *--p = (char)('0' + n % 10U);
+        n /= 10U;
+    } while (n);
+    *--p = '[';
+    *--p = '\033';
+    out_str (pThis, p);
+}
+
+//*****************************************************************************
+inline static void print_prompt (microrl_t * pThis)
+{
+    out_str (pThis, pThis->prompt_str);
+}
+
+//*****************************************************************************
+inline static void terminal_backspace (microrl_t * pThis)
+{
+        out_str (pThis, "\033[D \033[D");
 }
-#endif
 
+//*****************************************************************************
+inline static void terminal_newline (microrl_t * pThis)
+{
+    out_str (pThis, ENDL);
+}
 
 //*****************************************************************************
 // set cursor at position from begin cmdline (after prompt) + offset
 static void terminal_move_cursor (microrl_t * pThis, int offset)
 {
-    char str[16] = {0,};
-#ifdef _USE_LIBC_STDIO 
-    if (offset > 0) {
-        snprintf (str, 16, "\033[%dC", offset);
-    } else if (offset < 0) {
-        snprintf (str, 16, "\033[%dD", -(offset));
-    }
-#else 
-    char *endstr;
-    strcpy (str, "\033[");
-    if (offset > 0) {
-        endstr = u16bit_to_str ((unsigned int)offset, str+2);
-        strcpy (endstr, "C");
-    } else if (offset < 0) {
-        endstr = u16bit_to_str ((unsigned int)(-offset), str+2);
-        strcpy (endstr, "D");
-    } else
-        return;
-#endif	
-    pThis->print (str);
+    if (offset > 0)
+        out_esc (pThis, (unsigned int)offset, 'C');
+    else if (offset < 0)
+        out_esc (pThis, (unsigned int)(-offset), 'D');
 }
 
 //*****************************************************************************
 static void terminal_reset_cursor (microrl_t * pThis)
 {
-    char str[16];
-#ifdef _USE_LIBC_STDIO
-    snprintf (str, 16, "\033[%dD\033[%dC", \
-                        _COMMAND_LINE_LEN + _PROMPT_LEN + 2, _PROMPT_LEN);
-
-#else
-    char *endstr;
-    strcpy (str, "\033[");
-    endstr = u16bit_to_str ((unsigned int)(_COMMAND_LINE_LEN + _PROMPT_LEN + 2),str+2);
-    strcpy (endstr, "D\033["); endstr += 3;
-    endstr = u16bit_to_str ((unsigned int)_PROMPT_LEN, endstr);
-    strcpy (endstr, "C");
-#endif
-    pThis->print (str);
+    out_esc (pThis, _COMMAND_LINE_LEN + _PROMPT_LEN + 2, 'D');
+    out_esc (pThis, _PROMPT_LEN, 'C');
 }
 
 //*****************************************************************************
 // print cmdline to screen, replace '\0' to wihitespace 
 static void terminal_print_line (microrl_t * pThis, int pos, int cursor)
 {
-    pThis->print ("\033[K");    // delete all from cursor to end
+    out_str (pThis, "\033[K");    // delete all from cursor to end
 
-    char nch [] = {0,0};
     int i;
     for (i = pos; i < pThis->cmdlen; i++) {
-        nch [0] = pThis->cmdline [i];
-        if (nch[0] == '\0')
-            nch[0] = ' ';
-        pThis->print (nch);
+        char ch = pThis->cmdline [i];
+        out_char (pThis, ch == '\0' ? ' ' : ch);
     }
     
     terminal_reset_cursor (pThis);
@@ -335,6 +361,9 @@ void microrl_init (microrl_t * pThis, void (*print) (const char *))
 #endif
     pThis->prompt_str = prompt_default;
     pThis->print = print;
+#if _OUT_BUF_LEN > 0
+    pThis->out_len = 0;
+#endif
 #ifdef _ENABLE_INIT_PROMPT
     print_prompt (pThis);
 #endif
@@ -429,7 +458,7 @@ static int escape_process (microrl_t * pThis, char ch)
 
 //*****************************************************************************
 // insert len char of text at cursor position
-static int microrl_insert_text (microrl_t * pThis, char * text, int len)
+static int microrl_insert_text (microrl_t * pThis, const char * text, int len)
 {
     int i;
     if (pThis->cmdlen + len < (int)_COMMAND_LINE_LEN) {
@@ -500,7 +529,7 @@ static void microrl_get_complite (microrl_t * pThis)
         return;
     
     int status = split (pThis, pThis->cursor, tkn_arr);
-    if (pThis->cmdline[pThis->cursor-1] == '\0')
+    if (pThis->cursor == 0 || pThis->cmdline[pThis->cursor-1] == '\0')
         tkn_arr[status++] = "";
     compl_token = pThis->get_completion (status, tkn_arr);
     if (compl_token[0] != NULL) {
@@ -513,8 +542,8 @@ static void microrl_get_complite (microrl_t * pThis)
             len = common_len (compl_token);
             terminal_newline (pThis);
             while (compl_token [i] != NULL) {
-                pThis->print (compl_token[i]);
-                pThis->print (" ");
+                out_str (pThis, compl_token[i]);
+                out_str (pThis, " ");
                 i++;
             }
             terminal_newline (pThis);
@@ -545,10 +574,11 @@ void new_line_handler(microrl_t * pThis){
 #endif
     status = split (pThis, pThis->cmdlen, tkn_arr);
     if (status == -1){
-        //          pThis->print ("ERROR: Max token amount exseed\n");
-        pThis->print ("ERROR:too many tokens");
-        pThis->print (ENDL);
+        //          out_str (pThis, "ERROR: Max token amount exseed\n");
+        out_str (pThis, "ERROR:too many tokens");
+        out_str (pThis, ENDL);
     }
+    microrl_flush (pThis);  // echo before the command output
     if ((status > 0) && (pThis->execute != NULL))
         pThis->execute (status, tkn_arr);
     print_prompt (pThis);
@@ -560,6 +590,38 @@ void new_line_handler(microrl_t * pThis){
 #endif
 }
 
+//*****************************************************************************
+// Bulk input. A run of printable chars typed at the end of the line is
+// stored and echoed in one piece, without the per char redraw; anything
+// else goes through microrl_insert_char
+void microrl_insert_str (microrl_t * pThis, const char * str, int len)
+{
+    int i = 0;
+
+    while (i < len) {
+        int run = 0;
+        int fast = pThis->cursor == pThis->cmdlen &&
+                   !(pThis->cmdlen == 0 && str[i] == ' ');
+#ifdef _USE_ESC_SEQ
+        fast = fast && !pThis->escape;
+#endif
+        if (fast) {
+            int room = (int)_COMMAND_LINE_LEN - 1 - pThis->cmdlen;
+            while (i + run < len && run < room &&
+                   !IS_CONTROL_CHAR (str[i + run]) && str[i + run] != KEY_DEL)
+                run++;
+        }
+
+        if (run > 0) {
+            microrl_insert_text (pThis, str + i, run);
+            out_mem (pThis, str + i, run);
+            i += run;
+        } else {
+            microrl_insert_char (pThis, str[i++]);
+        }
+    }
+}
+
 //*****************************************************************************
 
 void microrl_insert_char (microrl_t * pThis, int ch)
@@ -631,7 +693,7 @@ void microrl_insert_char (microrl_t * pThis, int ch)
             break;
             //-----------------------------------------------------
             case KEY_VT:  // ^K
-                pThis->print ("\033[K");
+                out_str (pThis, "\033[K");
                 pThis->cmdlen = pThis->cursor;
             break;
             //-----------------------------------------------------
@@ -686,16 +748,22 @@ void microrl_insert_char (microrl_t * pThis, int ch)
             //-----------------------------------------------------
 #ifdef _USE_CTLR_C
             case KEY_ETX:
-            if (pThis->sigint != NULL)
+            if (pThis->sigint != NULL) {
+                microrl_flush (pThis);
                 pThis->sigint();
+            }
             break;
 #endif
             //-----------------------------------------------------
             default:
             if (((ch == ' ') && (pThis->cmdlen == 0)) || IS_CONTROL_CHAR(ch))
                 break;
-            if (microrl_insert_text (pThis, (char*)&ch, 1))
-                terminal_print_line (pThis, pThis->cursor-1, pThis->cursor);
+            if (microrl_insert_text (pThis, (char*)&ch, 1)) {
+                if (pThis->cursor == pThis->cmdlen)
+                    out_char (pThis, (char)ch);   // typed at the end, plain echo
+                else
+                    terminal_print_line (pThis, pThis->cursor-1, pThis->cursor);
+            }
             
             break;
         }
@@ -82,6 +82,10 @@ typedef struct {
 	int (*execute) (int argc, const char * const * argv );            // ptr to 'execute' callback
 	char ** (*get_completion) (int argc, const char * const * argv ); // ptr to 'completion' callback
 	void (*print) (const char *);                                     // ptr to 'print' callback
+#if _OUT_BUF_LEN > 0
+	char out [_OUT_BUF_LEN];           // pending output, see microrl_flush
+	int out_len;
+#endif
 #ifdef _USE_CTLR_C
 	void (*sigint) (void);
 #endif
@@ -90,6 +94,9 @@ typedef struct {
 // init internal data, calls once at start up
 void microrl_init (microrl_t * pThis, void (*print)(const char*));
 
+// send buffered output to 'print' callback, call after each input batch
+void microrl_flush (microrl_t * pThis);
+
 // set echo mode (true/false), using for disabling echo for password input
 // echo mode will enabled after user press Enter.
 void microrl_set_echo (int);
@@ -114,4 +121,8 @@ void microrl_set_sigint_callback (microrl_t * pThis, void (*sigintf)(void));
 // insert char to cmdline (for example call in usart RX interrupt)
 void microrl_insert_char (microrl_t * pThis, int ch);
 
+// insert a received chunk, same as microrl_insert_char for each byte but
+// pasted text is stored and echoed a run at a time
+void microrl_insert_str (microrl_t * pThis, const char * str, int len);
+
 #endif
@@ -0,0 +1,335 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * uarg.c - Typed command argument parser
+ * 
+ * Copyright (c) 2025 Michael Kaa
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Commands describe their arguments with a uarg_spec_t and get them
+ * converted and range checked in one call, with the same messages for
+ * every command. The converters are plain digit loops, no scanf.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include "uarg.h"
+
+#ifdef BAREMETAL
+#define ENDL "\r\n"
+#else
+#define ENDL "\n"
+#endif
+
+int uarg_hex(const char *s, uint32_t *out)
+{
+    uint32_t v = 0;
+
+    if (s[0] == '0' && (s[1] | 0x20) == 'x') {
+        s += 2;
+    }
+    if (*s == '\0') {
+        return -EINVAL;
+    }
+
+    for (; *s; s++) {
+        uint32_t c = (uint8_t)*s;
+        uint32_t d;
+
+        if (c - '0' < 10U) {
+            d = c - '0';
+        } else if ((c | 0x20) - 'a' < 6U) {
+            d = (c | 0x20) - 'a' + 10U;
+        } else {
+            return -EINVAL;
+        }
+        if (v >> 28) {
+            return -ERANGE;
+        }
+        v = (v << 4) | d;
+    }
+
+    *out = v;
+    return 0;
+}
+
+int uarg_dec(const char *s, uint32_t *out)
+{
+    uint32_t v = 0;
+
+    if (*s == '\0') {
+        return -EINVAL;
+    }
+
+    for (; *s; s++) {
+        uint32_t d = (uint32_t)(uint8_t)*s - '0';
+
+        if (d >= 10U) {
+            return -EINVAL;
+        }
+        if (v > (UINT32_MAX - d) / 10U) {
+            return -ERANGE;
+        }
+        v = v * 10U + d;
+    }
+
+    *out = v;
+    return 0;
+}
+
+int uarg_num(const char *s, uint32_t *out)
+{
+    if (s[0] == '0' && (s[1] | 0x20) == 'x') {
+        return uarg_hex(s, out);
+    }
+    return uarg_dec(s, out);
+}
+
+static const uarg_region_t *uarg_region(const uarg_t *a, const char *s)
+{
+    for (const uarg_region_t *r = a->table; r && r->name; r++) {
+        if (strcmp(r->name, s) == 0) {
+            return r;
+        }
+    }
+    return NULL;
+}
+
+static int uarg_in_range(const uarg_t *a, uint32_t v)
+{
+    return v >= a->min && (a->max == 0 || v <= a->max);
+}
+
+// What word @word of the argument accepts, for messages
+static void uarg_print_expect(FILE *out, const uarg_t *a, int word)
+{
+    const char *const *names;
+    const uarg_region_t *r;
+
+    if (a->type == UARG_T_RANGE && word == 1) {
+        fprintf(out, "hex length");
+        if (a->max) {
+            fprintf(out, " %lx..%lx", (unsigned long)a->min, (unsigned long)a->max);
+        }
+        fprintf(out, " inside the address space");
+        return;
+    }
+
+    switch (a->type) {
+    case UARG_T_HEX:
+    case UARG_T_DEC:
+    case UARG_T_NUM:
+        fprintf(out, a->type == UARG_T_HEX ? "hex" : a->type == UARG_T_DEC ? "decimal" : "number");
+        if (a->max) {
+            fprintf(out, a->type == UARG_T_HEX ? " %lx..%lx" : " %lu..%lu",
+                   (unsigned long)a->min, (unsigned long)a->max);
+        }
+        break;
+    case UARG_T_ENUM:
+        fprintf(out, "one of");
+        for (names = a->table; *names; names++) {
+            fprintf(out, " %s", *names);
+        }
+        break;
+    case UARG_T_ADDR:
+    case UARG_T_RANGE:
+        fprintf(out, "hex address");
+        if (a->table) {
+            fprintf(out, " or");
+            for (r = a->table; r->name; r++) {
+                fprintf(out, " %s", r->name);
+            }
+        }
+        break;
+    default:
+        fprintf(out, "text");
+        break;
+    }
+}
+
+// Number of words taken, -EINVAL with the offending word in *@bad, or
+// -ENODATA if a range lacks its length
+static int uarg_one(const uarg_t *a, int argc, char **argv, uarg_val_t *val, int *bad)
+{
+    const uarg_region_t *r;
+    int ret = 0;
+
+    switch (a->type) {
+    case UARG_T_HEX:
+        ret = uarg_hex(argv[0], &val->u);
+        break;
+    case UARG_T_DEC:
+        ret = uarg_dec(argv[0], &val->u);
+        break;
+    case UARG_T_NUM:
+        ret = uarg_num(argv[0], &val->u);
+        break;
+
+    case UARG_T_ENUM: {
+        const char *const *names = a->table;
+        for (uint32_t i = 0; names[i]; i++) {
+            if (strcmp(names[i], argv[0]) == 0) {
+                val->u = i;
+                return 1;
+            }
+        }
+        return -EINVAL;
+    }
+
+    case UARG_T_ADDR:
+        r = uarg_region(a, argv[0]);
+        if (r) {
+            val->u = r->base;
+            return 1;
+        }
+        return uarg_hex(argv[0], &val->u) < 0 ? -EINVAL : 1;
+
+    case UARG_T_RANGE:
+        r = uarg_region(a, argv[0]);
+        if (r) {
+            // The whole region: the next word belongs to the next
+            // argument ("mem crc flash sw", "mem dump itcm 8")
+            val[0].u = r->base;
+            val[1].u = r->size;
+            return uarg_in_range(a, val[1].u) ? 1 : -EINVAL;
+        }
+        if (uarg_hex(argv[0], &val[0].u) < 0) {
+            return -EINVAL;
+        }
+        if (argc < 2) {
+            return -ENODATA;
+        }
+        *bad = 1;
+        if (uarg_hex(argv[1], &val[1].u) < 0 || !uarg_in_range(a, val[1].u)) {
+            return -EINVAL;
+        }
+        if (val[1].u && val[0].u + (val[1].u - 1U) < val[0].u) {
+            return -EINVAL;
+        }
+        return 2;
+
+    default:
+        val->s = argv[0];
+        return 1;
+    }
+
+    if (ret < 0 || !uarg_in_range(a, val->u)) {
+        return -EINVAL;
+    }
+    return 1;
+}
+
+void uarg_print_args(FILE *out, const uarg_spec_t *spec)
+{
+    for (uint8_t i = 0; i < spec->count; i++) {
+        fprintf(out, " %s", spec->args[i].name);
+    }
+}
+
+void uarg_usage(FILE *out, const uarg_spec_t *spec)
+{
+    fprintf(out, "usage: %s", spec->cmd);
+    uarg_print_args(out, spec);
+    fprintf(out, ENDL);
+}
+
+int uarg_parse(FILE *out, const uarg_spec_t *spec, int argc, char **argv, uarg_val_t *val)
+{
+    int pos = 1;
+
+    for (uint8_t i = 0; i < spec->count; i++) {
+        const uarg_t *a = &spec->args[i];
+        int width = a->type == UARG_T_RANGE ? 2 : 1;
+
+        if (pos >= argc) {
+            if (!a->optional) {
+                fprintf(out, "%s: missing %s" ENDL, spec->cmd, a->name);
+                uarg_usage(out, spec);
+                return -EINVAL;
+            }
+            val[0].u = a->def;
+            if (width == 2) {
+                val[1].u = 0;
+            }
+            val += width;
+            continue;
+        }
+
+        int bad = 0;
+        int used = uarg_one(a, argc - pos, argv + pos, val, &bad);
+        if (used == -ENODATA) {
+            fprintf(out, "%s: missing length of %s" ENDL, spec->cmd, a->name);
+            uarg_usage(out, spec);
+            return -EINVAL;
+        }
+        if (used < 0) {
+            fprintf(out, "%s: bad %s '%s', expected ", spec->cmd, a->name, argv[pos + bad]);
+            uarg_print_expect(out, a, bad);
+            fprintf(out, ENDL);
+            return -EINVAL;
+        }
+        pos += used;
+        val += width;
+    }
+
+    if (pos < argc) {
+        fprintf(out, "%s: unexpected '%s'" ENDL, spec->cmd, argv[pos]);
+        uarg_usage(out, spec);
+        return -EINVAL;
+    }
+    return 0;
+}
+
+void uarg_complete(const uarg_spec_t *spec, int argn, const char *const *words,
+                   void (*add)(const char *word))
+{
+    const char *prefix = words[argn - 1];
+    size_t len = strlen(prefix);
+    int pos = 1;
+
+    for (uint8_t i = 0; i < spec->count; i++) {
+        const uarg_t *a = &spec->args[i];
+
+        if (pos == argn) {
+            if (a->type == UARG_T_ENUM) {
+                for (const char *const *names = a->table; *names; names++) {
+                    if (strncmp(*names, prefix, len) == 0) {
+                        add(*names);
+                    }
+                }
+            } else if (a->type == UARG_T_ADDR || a->type == UARG_T_RANGE) {
+                for (const uarg_region_t *r = a->table; r && r->name; r++) {
+                    if (strncmp(r->name, prefix, len) == 0) {
+                        add(r->name);
+                    }
+                }
+            }
+            return;
+        }
+        // A region name stands for the whole range, one word
+        pos += (a->type == UARG_T_RANGE && !uarg_region(a, words[pos - 1])) ? 2 : 1;
+    }
+}
+
+#undef ENDL
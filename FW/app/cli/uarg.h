@@ -0,0 +1,126 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * uarg.h - Typed command argument parser
+ *
+ * Copyright (c) 2025 Michael Kaa
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _UARG_H
+#define _UARG_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <errno.h>
+
+typedef enum uarg_type {
+    UARG_T_HEX,     // hex, 0x prefix optional
+    UARG_T_DEC,     // decimal
+    UARG_T_NUM,     // decimal, hex with 0x prefix
+    UARG_T_ENUM,    // one of @table names, the value is the index
+    UARG_T_ADDR,    // hex or a region name
+    UARG_T_RANGE,   // <adr> <len> or a whole <region>, two values: base, len
+    UARG_T_STR,
+} uarg_type_t;
+
+// Named address range for UARG_T_ADDR/UARG_T_RANGE
+typedef struct uarg_region {
+    const char *name;
+    uint32_t base;
+    uint32_t size;
+} uarg_region_t;
+
+/**
+ * struct uarg - One argument
+ * @name: For usage and errors, "<len>", "[count]" if optional
+ * @type: uarg_type_t
+ * @optional: May be omitted, then @def is used. Only trailing ones
+ * @min: Lowest value, length for UARG_T_RANGE
+ * @max: Highest value, 0 for no limit
+ * @def: Value when omitted
+ * @table: NULL terminated names (UARG_T_ENUM) or regions (UARG_T_ADDR,
+ *         UARG_T_RANGE, terminated by a NULL name)
+ */
+typedef struct uarg {
+    const char *name;
+    uint8_t type;
+    uint8_t optional;
+    uint32_t min;
+    uint32_t max;
+    uint32_t def;
+    const void *table;
+} uarg_t;
+
+typedef union uarg_val {
+    uint32_t u;
+    const char *s;
+} uarg_val_t;
+
+// Arguments of one command
+typedef struct uarg_spec {
+    const char *cmd;        // "mem dump", for messages
+    const uarg_t *args;
+    uint8_t count;
+} uarg_spec_t;
+
+#define UARG_SPEC(name, ...) { \
+    .cmd   = name, \
+    .args  = (const uarg_t[]){ __VA_ARGS__ }, \
+    .count = sizeof((const uarg_t[]){ __VA_ARGS__ }) / sizeof(uarg_t), \
+}
+
+#define UARG_HEX(n, lo, hi)      { .name = n, .type = UARG_T_HEX, .min = lo, .max = hi }
+#define UARG_DEC(n, lo, hi)      { .name = n, .type = UARG_T_DEC, .min = lo, .max = hi }
+#define UARG_NUM(n, lo, hi)      { .name = n, .type = UARG_T_NUM, .min = lo, .max = hi }
+#define UARG_ENUM(n, names)      { .name = n, .type = UARG_T_ENUM, .table = names }
+#define UARG_ADDR(n, regions)    { .name = n, .type = UARG_T_ADDR, .table = regions }
+#define UARG_RANGE(n, regions, lo, hi) \
+    { .name = n, .type = UARG_T_RANGE, .min = lo, .max = hi, .table = regions }
+#define UARG_STR(n)              { .name = n, .type = UARG_T_STR }
+
+#define UARG_OPT_HEX(n, lo, hi, d) { .name = n, .type = UARG_T_HEX, .optional = 1, .min = lo, .max = hi, .def = d }
+#define UARG_OPT_DEC(n, lo, hi, d) { .name = n, .type = UARG_T_DEC, .optional = 1, .min = lo, .max = hi, .def = d }
+#define UARG_OPT_ENUM(n, names, d) { .name = n, .type = UARG_T_ENUM, .optional = 1, .def = d, .table = names }
+
+/**
+ * Parse argv[1..] (argv[0] is the command word) into @val, one value per
+ * argument, two for UARG_T_RANGE. On error prints what is wrong and the
+ * usage to @out, returns -EINVAL
+ */
+int uarg_parse(FILE *out, const uarg_spec_t *spec, int argc, char **argv, uarg_val_t *val);
+
+// "usage: mem dump <adr> <len>"
+void uarg_usage(FILE *out, const uarg_spec_t *spec);
+
+// " <adr> <len> [count]"
+void uarg_print_args(FILE *out, const uarg_spec_t *spec);
+
+// Offer enum and region names for word @argn (1 based) through @add.
+// @words are the words after the command, the last one is the prefix
+void uarg_complete(const uarg_spec_t *spec, int argn, const char *const *words,
+                   void (*add)(const char *word));
+
+// Converters, 0 or -EINVAL/-ERANGE
+int uarg_hex(const char *s, uint32_t *out);
+int uarg_dec(const char *s, uint32_t *out);
+int uarg_num(const char *s, uint32_t *out);
+
+#endif /* _UARG_H */
@@ -1,125 +1,400 @@
-
+#define _GNU_SOURCE // fopencookie
 #include <string.h> // strcmp
 #include <stdio.h>  // printf
 #include <stdint.h>
+#include <errno.h>
+#include <unistd.h> // read
 #include "term_gxf.h"
 #include "ucmd.h"
 #include "microrl.h"
-#include "microrl.h"
+#include "dev_interface.h"
+
+// Linker script, .ucmd section
+extern const command_t __ucmd_start[];
+extern const command_t __ucmd_end[];
+
+const command_t *ucmd_table(size_t *count)
+{
+  *count = (size_t)(__ucmd_end - __ucmd_start);
+  return __ucmd_start;
+}
+
+// strcmp(path, words joined by '.') without building the joined string
+static int ucmd_path_cmp(const char *path, const char *const *words, int n)
+{
+  for (int i = 0; i < n; i++) {
+    const char *w = words[i];
+
+    if (i) {
+      if (*path != '.') return (unsigned char)*path - '.';
+      path++;
+    }
+    for (; *w; w++, path++) {
+      if (*path != *w) return (unsigned char)*path - (unsigned char)*w;
+    }
+  }
+  return (unsigned char)*path;
+}
+
+const command_t *ucmd_find_words(const command_t list[], size_t count,
+                                 const char *const *words, int n)
+{
+  size_t lo = 0;
+  size_t hi = count;
+
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    int r = ucmd_path_cmp(list[mid].cmd, words, n);
+    if (r == 0) return &list[mid];
+    if (r > 0) hi = mid;
+    else lo = mid + 1;
+  }
+  return NULL;
+}
+
+const command_t *ucmd_find(const command_t list[], size_t count, const char *path)
+{
+  return ucmd_find_words(list, count, &path, 1);
+}
+
+// Names starting with a prefix are one contiguous run of the sorted list
+const command_t *ucmd_find_prefix(const command_t list[], size_t count,
+                                  const char *prefix, size_t *matches)
+{
+  size_t len = strlen(prefix);
+  size_t lo = 0;
+  size_t hi = count;
+
+  // first name >= prefix
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (strcmp(list[mid].cmd, prefix) < 0) lo = mid + 1;
+    else hi = mid;
+  }
+  size_t first = lo;
+
+  // first name past the run
+  hi = count;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (strncmp(list[mid].cmd, prefix, len) == 0) lo = mid + 1;
+    else hi = mid;
+  }
+
+  if (matches) *matches = lo - first;
+  return lo > first ? &list[first] : NULL;
+}
 
-int ucmd_parse(command_t cmd_list[], int argc, const char **argv)
+// "mem.dump" -> "mem dump"
+static void ucmd_print_path(FILE *out, const char *path)
+{
+  for (; *path; path++) {
+    fputc(*path == '.' ? ' ' : *path, out);
+  }
+}
+
+// "mem dump <adr> <len>   help text"
+static void ucmd_print_cmd(FILE *out, const command_t *c)
+{
+  ucmd_print_path(out, c->cmd);
+  if (c->args) uarg_print_args(out, c->args);
+  fprintf(out, " \t%s\r\n", c->help);
+}
+
+// Subcommands of @node, one level down
+static void ucmd_print_sub(FILE *out, const command_t list[], size_t count, const command_t *node)
+{
+  size_t n = 0;
+  size_t len = strlen(node->cmd);
+  const command_t *c = ucmd_find_prefix(list, count, node->cmd, &n);
+
+  // The run starting with the node path holds "<path>.<word>" and
+  // siblings like "<path>-x", keep the direct children
+  for (size_t i = 0; i < n; i++) {
+    if (c[i].cmd[len] != '.' || strchr(c[i].cmd + len + 1, '.')) continue;
+    ucmd_print_cmd(out, &c[i]);
+  }
+}
+
+int ucmd_parse(ucmd_session_t *s, const command_t list[], size_t count,
+               int argc, const char **argv)
 {
   if (!argv) return 0;        // return 0 for empty commands
-  if (!cmd_list) return UCMD_CMD_NOT_FOUND;   // obviously not found, no list
-  int retval = 0;
-
-  if (argc) {
-    command_t *c = NULL;
-    for (command_t *p = cmd_list; p->cmd; p++)
-      if (strcmp(p->cmd, &argv[0][0]) == 0) c = p;
-    if (c) retval = c->fn(argc, (char**)argv);
-    else retval = UCMD_CMD_NOT_FOUND;
-  }
-
-  return retval;
-}
-
-extern command_t cmd_list[];
-// Пример cmd_list.
-// command_t cmd_list[] = {
-//   {
-//     .cmd  = "help",
-//     .help = "print available commands with their help text",
-//     .fn   = print_help_cb,
-//   },
-//   {
-//     .cmd  = "reset",
-//     .help = "reset mcu",
-//     .fn   = ucmd_mcu_reset,
-//   }, 
-//   {
-//     .cmd  = "mem",
-//     .help = "memory man, use mem help",
-//     .fn   = ucmd_mem,
-//   },
-//   {
-//     .cmd  = "time",
-//     .help = "rtc time. to set type time hh mm ss",
-//     .fn   = ucmd_time,
-//   },
-  
-//   {}, // null list terminator DON'T FORGET THIS!
-// };
-
-int ucmd_execute(int argc, char **argv) {
+  if (!list) return UCMD_CMD_NOT_FOUND;   // obviously not found, no list
+  if (!argc) return 0;
+
+  const command_t *node = ucmd_find_words(list, count, argv, 1);
+  if (!node) return UCMD_CMD_NOT_FOUND;
+
+  // Descend while the next word names a subcommand
+  int depth = 1;
+  while (depth < argc) {
+    const command_t *sub = ucmd_find_words(list, count, argv, depth + 1);
+    if (!sub) break;
+    node = sub;
+    depth++;
+  }
+
+  if (node->fn) return node->fn(s, argc - depth + 1, (char**)argv + depth - 1);
+
+  // Group: list what's below, unknown words are an error
+  if (depth < argc && strcmp(argv[depth], "help") != 0) return UCMD_CMD_NOT_FOUND;
+  ucmd_print_cmd(s->out, node);
+  ucmd_print_sub(s->out, list, count, node);
+  return 0;
+}
+
+static int ucmd_execute(ucmd_session_t *s, int argc, const char *const *argv) {
   int ret = 0;
-  ret = ucmd_parse(cmd_list, argc, (const char **)argv);
+  size_t count;
+  const command_t *list = ucmd_table(&count);
+
+  ret = ucmd_parse(s, list, count, argc, (const char **)argv);
   if(ret == UCMD_CMD_NOT_FOUND){
-    static uint8_t gssu = 0;
-    if(gssu++ < 6)  {
-      printf("unknown command");
+    if(s->unknown++ < 6)  {
+      fprintf(s->out, "unknown command");
       for(int i = 0; i < argc; i++) {
-        printf(" %s", (char*)&argv[i][0]);
+        fprintf(s->out, " %s", argv[i]);
       }
-      printf(", try help\r\n");
+      fprintf(s->out, ", try help\r\n");
     } else {
-      gssu = 0;
-      set_display_atrib(F_RED);
-      printf("GO SLEEP, STUPID USER!\r\n");
-      resetcolor();
+      s->unknown = 0;
+      fset_display_atrib(s->out, F_RED);
+      fprintf(s->out, "GO SLEEP, STUPID USER!\r\n");
+      fresetcolor(s->out);
     }
   }
   return ret; 
 }
 
-int print_help_cb(int argc, char *argv[])
+// help [command words], top level commands without arguments
+int print_help_cb(ucmd_session_t *s, int argc, char *argv[])
 {
-  (void)argc;
-  (void)argv;
-    
-  command_t *p = cmd_list;
-  while (p->cmd) {
-    printf("%s \t%s\r\n", p->cmd, p->help);
-    p++;
+  size_t count;
+  const command_t *list = ucmd_table(&count);
+
+  if (argc > 1) {
+    const command_t *node = ucmd_find_words(list, count, (const char *const *)argv + 1, argc - 1);
+    if (!node) {
+      return UCMD_CMD_NOT_FOUND;
+    }
+    ucmd_print_cmd(s->out, node);
+    ucmd_print_sub(s->out, list, count, node);
+    return 0;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    if (strchr(list[i].cmd, '.')) continue;
+    ucmd_print_cmd(s->out, &list[i]);
   }
   return 0;
 }
 
-void ucmd_default_print(const char * str) {
-  printf ("%s", str);
+UCMD_REGISTER(help, "help", print_help_cb, "print available commands, help [command]");
+
+static const char *ucmd_compl[UCMD_COMPLETE_MAX + 1];
+static int ucmd_compl_n;
+
+void ucmd_complete_add(const char *word)
+{
+  if (ucmd_compl_n < UCMD_COMPLETE_MAX) ucmd_compl[ucmd_compl_n++] = word;
 }
-  
-void default_sigint(void) {
-  printf("default_sigint\r\n");
+
+void ucmd_complete_list(const char *const *words, const char *prefix)
+{
+  size_t len = strlen(prefix);
+
+  for (; *words; words++) {
+    if (strncmp(*words, prefix, len) == 0) ucmd_complete_add(*words);
+  }
 }
 
-static volatile uint8_t ucmd_default_rx;
-static microrl_t default_rl;
+// Children of @node (top level if NULL) whose word starts with @prefix.
+// They are one run of the sorted table, found by ucmd_find_prefix()
+static void ucmd_complete_sub(const command_t list[], size_t count,
+                              const command_t *node, const char *prefix)
+{
+  char path[_COMMAND_LINE_LEN];
+  size_t base = 0;
+  size_t n = 0;
+
+  if (node) {
+    base = strlen(node->cmd) + 1;
+    snprintf(path, sizeof(path), "%s.%s", node->cmd, prefix);
+  } else {
+    snprintf(path, sizeof(path), "%s", prefix);
+  }
 
-void ucmd_default_init(void) {
-  ucmd_default_rx = 0;
-  // microrl_t * prl = &default_rl;
+  const command_t *c = ucmd_find_prefix(list, count, path, &n);
+  for (size_t i = 0; i < n; i++) {
+    const char *word = c[i].cmd + base;
+    if (strchr(word, '.')) continue;  // deeper level
+    ucmd_complete_add(word);
+  }
+}
+
+char **ucmd_complete(int argc, const char *const *argv)
+{
+  size_t count;
+  const command_t *list = ucmd_table(&count);
+  const command_t *node = NULL;
+  const char *prefix = argc ? argv[argc - 1] : "";
+  int depth = 0;
+
+  ucmd_compl_n = 0;
+
+  // Words before the cursor that name nodes
+  while (depth < argc - 1) {
+    const command_t *sub = ucmd_find_words(list, count, argv, depth + 1);
+    if (!sub) break;
+    node = sub;
+    depth++;
+  }
+
+  if (depth >= argc - 1) ucmd_complete_sub(list, count, node, prefix);
+  if (node && node->complete) node->complete(argc - depth, prefix);
+  if (node && node->args && argc > depth) uarg_complete(node->args, argc - depth, argv + depth, ucmd_complete_add);
+
+  ucmd_compl[ucmd_compl_n] = NULL;
+  return (char **)ucmd_compl;
+}
+
+// microrl callbacks carry no context, the session being fed is here.
+// Sessions run in tasks, which don't preempt each other
+static ucmd_session_t *ucmd_cur;
+
+static void ucmd_session_print(const char * str) {
+  fputs(str, ucmd_cur->out);
+}
+
+static int ucmd_session_execute(int argc, const char * const * argv) {
+  return ucmd_execute(ucmd_cur, argc, argv);
+}
+
+static void ucmd_session_sigint(void) {
+  ucmd_session_t *s = ucmd_cur;
+
+  if (s->sigint) s->sigint(s);
+  else default_sigint(s);
+}
+
+void default_sigint(ucmd_session_t *s) {
+  fprintf(s->out, "^C\r\n");
+}
+
+// Output stream of a session without one, writes go to the interface
+static cookie_write_function_t ucmd_session_write;
+
+static ssize_t ucmd_session_write(void *cookie, const char *buf, size_t size) {
+  const ucmd_session_t *s = cookie;
+  int ret = s->io->write(buf, size);
+
+  return ret < 0 ? -1 : ret;
+}
+
+int ucmd_session_init(ucmd_session_t *s, const char *name,
+                      const struct interface *io, FILE *out) {
+  if (s == NULL || io == NULL || io->read == NULL) return -EINVAL;
+  if (out == NULL && io->write == NULL) return -EINVAL;
+
+  memset(s, 0, sizeof(*s));
+  s->name = name;
+  s->io = io;
+  s->out = out;
+  if (out == NULL) {
+    cookie_io_functions_t fns = { .write = ucmd_session_write };
+
+    s->out = fopencookie(s, "w", fns);
+    if (s->out == NULL) return -ENOMEM;
+    setvbuf(s->out, s->obuf, _IOLBF, sizeof(s->obuf));
+  }
+
+  ucmd_cur = s;
   // call init with ptr to microrl instance and print callback
-  microrl_init(&default_rl, ucmd_default_print);
+  microrl_init(&s->rl, ucmd_session_print);
   // set callback for execute
-  microrl_set_execute_callback(&default_rl, (int (*)(int, const char * const*))ucmd_execute);
+  microrl_set_execute_callback(&s->rl, ucmd_session_execute);
   // set callback for completion (optionally)
-  // microrl_set_complete_callback (prl, complet);
+  microrl_set_complete_callback(&s->rl, ucmd_complete);
   // set callback for ctrl+c handling (optionally)
-  microrl_set_sigint_callback(&default_rl, default_sigint);
-  // microrl_insert_char(prl, '\r');
-  microrl_insert_char(&default_rl, '\n');
-  microrl_insert_char(&default_rl, '\n');  
+  microrl_set_sigint_callback(&s->rl, ucmd_session_sigint);
+  microrl_insert_char(&s->rl, '\n');
+  microrl_insert_char(&s->rl, '\n');
+  microrl_flush(&s->rl);
+  fflush(s->out);
+  return 0;
+}
+
+int ucmd_session_proc(ucmd_session_t *s) {
+  char buf[64];
+  int total = 0;
+  int n;
+
+  ucmd_cur = s;
+
+  // Drain the RX ring, a short read means it is empty. Only the first
+  // read may sleep if the input is blocking (or one more after an exact
+  // multiple of the buffer)
+  do {
+    n = s->io->read(buf, sizeof(buf));
+    if (n <= 0) break;
+    int taken = s->raw ? s->raw(s, buf, n) : 0;
+    if (taken < n) microrl_insert_str(&s->rl, buf + taken, n - taken);
+    total += n;
+  } while (n == (int)sizeof(buf));
+
+  // echo of the whole batch in one write
+  microrl_flush(&s->rl);
+  fflush(s->out);
+  return total;
+}
+
+void ucmd_session_set_raw(ucmd_session_t *s,
+                          int (*raw)(ucmd_session_t *s, const char *buf, int len),
+                          void *ctx) {
+  int was_raw = s->raw != NULL;
+
+  s->raw = raw;
+  s->raw_ctx = ctx;
+  // The line is empty since the command that went raw
+  if (raw == NULL && was_raw) {
+    fputs(s->rl.prompt_str, s->out);
+    fflush(s->out);
+  }
+}
+
+void ucmd_session_set_sigint(ucmd_session_t *s, void (*sigint)(ucmd_session_t *s)) {
+  s->sigint = sigint;
+}
+
+static int ucmd_stdio_read(void *buf, size_t len) {
+  int n = (int)read(STDIN_FILENO, buf, len);
+
+  if (n < 0) return errno == EAGAIN ? 0 : -errno;
+  return n;
 }
 
-void ucmd_default_proc(void) {
-  // ucmd_default_rx = 0;
-  scanf("%c", &ucmd_default_rx);
-  microrl_insert_char(&default_rl, ucmd_default_rx);
+static int ucmd_stdio_write(const void *buf, size_t len) {
+  size_t n = fwrite(buf, 1, len, stdout);
+
+  return n ? (int)n : -EIO;
 }
 
+const interface_t ucmd_stdio = {
+  .read = ucmd_stdio_read,
+  .write = ucmd_stdio_write,
+};
 
-void ucmd_set_sigint(void (*sigintf)(void)) {
-  microrl_set_sigint_callback(&default_rl, sigintf);
+ucmd_session_t ucmd_default;
+
+void ucmd_default_init(void) {
+  ucmd_session_init(&ucmd_default, "console", &ucmd_stdio, stdout);
 }
 
+int ucmd_default_proc(void) {
+  return ucmd_session_proc(&ucmd_default);
+}
+
+void ucmd_set_sigint(void (*sigintf)(ucmd_session_t *s)) {
+  ucmd_session_set_sigint(&ucmd_default, sigintf);
+}
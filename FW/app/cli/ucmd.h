@@ -2,35 +2,177 @@
 #define _UCMD_H_
 
 #include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "microrl.h"
+#include "uarg.h"
 
 #define UCMD_CMD_NOT_FOUND INT_MIN
 
-typedef int (*command_cb)(int, char **);
+// Line buffer of a session output stream
+#ifndef UCMD_OUT_BUF_LEN
+#define UCMD_OUT_BUF_LEN 128
+#endif
+
+struct interface;
+typedef struct ucmd_session ucmd_session_t;
+
+/**
+ * struct ucmd_session - One console: line editor, input and output
+ * @rl: Line editor state
+ * @io: Input, read without blocking. Also the output if @out was not
+ *      given to ucmd_session_init()
+ * @out: Where the commands of this session print
+ * @name: For messages
+ * @sigint: Ctrl+C handler, may be NULL
+ * @unknown: Unknown commands in a row
+ * @raw: Takes the input instead of the line editor while set, see
+ *       ucmd_session_set_raw()
+ * @raw_ctx: For @raw
+ *
+ * Sessions are independent, each one is fed by its own task with
+ * ucmd_session_proc(). Commands get the session they were typed on and
+ * print with fprintf(s->out, ...), never to stdout.
+ */
+struct ucmd_session {
+    microrl_t rl;
+    const struct interface *io;
+    FILE *out;
+    const char *name;
+    void (*sigint)(ucmd_session_t *s);
+    uint8_t unknown;
+    int (*raw)(ucmd_session_t *s, const char *buf, int len);
+    void *raw_ctx;
+    char obuf[UCMD_OUT_BUF_LEN];
+};
+
+typedef int (*command_cb)(ucmd_session_t *s, int argc, char **argv);
+
+/**
+ * Argument completer, offers the values of argument @argn (1 is the word
+ * after the command) that start with @prefix through ucmd_complete_add()
+ */
+typedef void (*ucmd_complete_cb)(int argn, const char *prefix);
 
 typedef struct command {
-    const char *cmd;    /**< the command string to match against */
+    const char *cmd;    /**< command path, words joined by '.', "mem.dump" */
     const char *help;   /**< the help text associated with cmd */
-    command_cb fn;      /**< the function to call when cmd is matched */
+    command_cb fn;      /**< the function to call when cmd is matched, NULL for a group */
+    ucmd_complete_cb complete; /**< argument completer, may be NULL */
+    const uarg_spec_t *args;   /**< argument spec for help and completion, may be NULL */
 } command_t;
 
+// Most candidates one TAB offers
+#define UCMD_COMPLETE_MAX 32
+
+/**
+ * Register a command from its own module, there is no central list.
+ * The linker collects the descriptors from the .ucmd.<path> sections
+ * sorted by name, so the table comes out sorted by path. A path
+ * registered twice fails the build (Makefile, from the map file).
+ *
+ * Subcommands are nodes below their parent: "mem.dump" runs on
+ * "mem dump ...". The deepest node matching the leading words gets
+ * argv starting at its own word, every level needs its own node. A node
+ * without a handler groups its subcommands and lists them.
+ */
+#define UCMD_REGISTER(id, path, handler, text) \
+    UCMD_REGISTER_EX(id, path, handler, text, NULL, NULL)
+
+// Same, with an argument completer
+#define UCMD_REGISTER_COMPLETE(id, path, handler, text, completer) \
+    UCMD_REGISTER_EX(id, path, handler, text, completer, NULL)
+
+// Same, with an argument spec (uarg.h), it completes enum and region names
+#define UCMD_REGISTER_ARGS(id, path, handler, text, spec) \
+    UCMD_REGISTER_EX(id, path, handler, text, NULL, &(spec))
+
+#define UCMD_REGISTER_EX(id, path, handler, text, completer, spec) \
+    static const command_t ucmd_cmd_##id \
+    __attribute__((section(".ucmd." path), used, aligned(4))) = { \
+        .cmd      = path, \
+        .help     = text, \
+        .fn       = handler, \
+        .complete = completer, \
+        .args     = spec, \
+    }
+
+// The registered commands, sorted by path
+const command_t *ucmd_table(size_t *count);
+
+/**
+ * Start a session reading @io. Output goes to @out if given (stdout for
+ * the stdio console), else to @io->write through a line buffered stream.
+ * Prints the first prompt. Returns 0 or negative errno
+ */
+int ucmd_session_init(ucmd_session_t *s, const char *name,
+                      const struct interface *io, FILE *out);
+
+// Feed what @s->io has received to the line editor, call on RX events.
+// Returns bytes taken
+int ucmd_session_proc(ucmd_session_t *s);
+
+/**
+ * Hand the input of @s to @raw, for binary transfers. @raw gets what was
+ * received and returns how much it took, the rest goes to the line
+ * editor (the transfer ended in the middle). NULL gives the input back
+ * and prints a new prompt. Output stays with the caller, nothing is
+ * echoed meanwhile
+ */
+void ucmd_session_set_raw(ucmd_session_t *s,
+                          int (*raw)(ucmd_session_t *s, const char *buf, int len),
+                          void *ctx);
+
+// Ctrl+C handler of @s
+void ucmd_session_set_sigint(ucmd_session_t *s, void (*sigint)(ucmd_session_t *s));
+
+// stdin/stdout as an interface, read doesn't block if stdin doesn't
+extern const struct interface ucmd_stdio;
+
+// The stdio console: a session on ucmd_stdio printing to stdout
+extern ucmd_session_t ucmd_default;
+
 // Init.
 void ucmd_default_init(void);
 
-// call in loop.
-void ucmd_default_proc(void);
+// call in loop or on RX event, returns bytes taken from stdin.
+int ucmd_default_proc(void);
+
+
+// @list must be sorted by path, lookup is a binary search per level
+int ucmd_parse(ucmd_session_t *s, const command_t list[], size_t count,
+               int argc, const char **argv);
+
+// Exact match of a path, NULL if none
+const command_t *ucmd_find(const command_t list[], size_t count, const char *path);
+
+// Node for the first @n words, compared as if joined by '.', NULL if none
+const command_t *ucmd_find_words(const command_t list[], size_t count,
+                                 const char *const *words, int n);
 
+// First command starting with @prefix, *@matches gets the number of
+// consecutive entries that do. NULL if none
+const command_t *ucmd_find_prefix(const command_t list[], size_t count,
+                                  const char *prefix, size_t *matches);
 
-int ucmd_parse(command_t[], int argc, const char **argv);
+int print_help_cb(ucmd_session_t *s, int argc, char *argv[]);
 
-int print_help_cb(int argc, char *argv[]);
+// TAB completion for microrl: subcommands from the table, arguments from
+// the command completer. Returns a NULL terminated candidate list
+char **ucmd_complete(int argc, const char *const *argv);
 
-void ucmd_default_print(const char * str);
+// For completers, @word must stay valid until the next TAB
+void ucmd_complete_add(const char *word);
 
-void default_sigint(void);
+// Offer the entries of @words (NULL terminated) starting with @prefix
+void ucmd_complete_list(const char *const *words, const char *prefix);
 
+void default_sigint(ucmd_session_t *s);
 
-void ucmd_set_sigint(void (*sigintf)(void));
-void default_sigint(void);
+// Ctrl+C handler of the stdio console
+void ucmd_set_sigint(void (*sigintf)(ucmd_session_t *s));
 
 // https://github.com/thefekete/uCmd
 
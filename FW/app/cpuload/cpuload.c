@@ -0,0 +1,360 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * cpuload.c - CPU load, per task and per IRQ time accounting, top
+ * 
+ * Copyright (c) 2025 Michael Kaa
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Wall and idle time come from the SysTick clock (systime), which keeps
+ * counting in WFI. Task and handler time is taken with DWT CYCCNT, it
+ * only counts while the core runs, which is all those need. Both run at
+ * the core clock, so the shares are plain ratios.
+ *
+ * Handler time is also inside the time of whatever task it interrupted,
+ * task shares are inclusive.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "cpuload.h"
+#include "sched.h"
+#include "systime.h"
+#include "job.h"
+#include "ucmd.h"
+#include "term_gxf.h"
+
+#define ENDL "\r\n"
+
+// Handler accumulators, written by the handlers
+static cpuload_irq_t irq_acc[CPULOAD_VECTORS];
+
+// Last complete window
+static struct {
+    uint32_t seq;
+    uint64_t wall;
+    uint64_t idle;
+    uint64_t task[SCHED_MAX_TASKS];
+    uint32_t runs[SCHED_MAX_TASKS];
+    cpuload_irq_t irq[CPULOAD_VECTORS];
+    uint32_t irq_peak[CPULOAD_VECTORS];  // max since boot
+} win;
+
+// Totals at the start of the current window
+static uint64_t start_wall;
+static uint64_t start_idle;
+static uint64_t start_task[SCHED_MAX_TASKS];
+static uint32_t start_runs[SCHED_MAX_TASKS];
+
+static systimer_t cpuload_timer;
+
+static inline uint32_t irq_lock(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    return primask;
+}
+
+static inline void irq_unlock(uint32_t primask)
+{
+    __set_PRIMASK(primask);
+}
+
+void cpuload_irq_exit(uint32_t start)
+{
+    uint32_t spent = DWT->CYCCNT - start;
+    uint32_t vect = SCB->ICSR & SCB_ICSR_VECTACTIVE_Msk;
+
+    if (vect >= CPULOAD_VECTORS) {
+        return;
+    }
+
+    // A handler is not reentered, only another vector can preempt this
+    cpuload_irq_t *acc = &irq_acc[vect];
+    acc->cycles += spent;
+    acc->count++;
+    if (spent > acc->max) {
+        acc->max = spent;
+    }
+}
+
+// Timer task context, tasks don't preempt each other so the sched
+// counters are consistent here
+static void cpuload_roll(void *ctx)
+{
+    uint64_t wall = systime_cycles();
+    uint64_t idle = systime_idle_cycles();
+    sched_info_t info;
+
+    (void)ctx;
+
+    uint32_t primask = irq_lock();
+    memcpy(win.irq, irq_acc, sizeof(win.irq));
+    memset(irq_acc, 0, sizeof(irq_acc));
+    irq_unlock(primask);
+
+    for (uint32_t v = 0; v < CPULOAD_VECTORS; v++) {
+        if (win.irq[v].max > win.irq_peak[v]) {
+            win.irq_peak[v] = win.irq[v].max;
+        }
+    }
+
+    for (int id = 0; id < SCHED_MAX_TASKS; id++) {
+        if (sched_task_info(id, &info) < 0) {
+            win.task[id] = 0;
+            win.runs[id] = 0;
+            continue;
+        }
+        win.task[id] = info.cycles - start_task[id];
+        win.runs[id] = info.runs - start_runs[id];
+        start_task[id] = info.cycles;
+        start_runs[id] = info.runs;
+    }
+
+    win.wall = wall - start_wall;
+    win.idle = idle - start_idle;
+    start_wall = wall;
+    start_idle = idle;
+    win.seq++;
+}
+
+int cpuload_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    start_wall = systime_cycles();
+    start_idle = systime_idle_cycles();
+
+    return systimer_start(&cpuload_timer, CPULOAD_WINDOW_MS, CPULOAD_WINDOW_MS,
+                          cpuload_roll, NULL, 0);
+}
+
+static uint32_t cpuload_share(uint64_t part, uint64_t whole)
+{
+    if (whole == 0) {
+        return 0;
+    }
+    if (part > whole) {
+        part = whole;
+    }
+    return (uint32_t)((part * 1000U + whole / 2U) / whole);
+}
+
+uint32_t cpuload_permille(void)
+{
+    return 1000U - cpuload_share(win.idle, win.wall);
+}
+
+// top
+
+#define TOP_COLS      48
+#define TOP_TASK_ROWS SCHED_MAX_TASKS
+#define TOP_IRQ_ROWS  12
+#define TOP_ROWS      (4 + TOP_TASK_ROWS + TOP_IRQ_ROWS)
+#define TOP_POLL_MS   (CPULOAD_WINDOW_MS / 4U)
+
+static const struct {
+    int16_t irqn;
+    const char *name;
+} irq_names[] = {
+    { SysTick_IRQn,      "SysTick" },
+    { USART1_IRQn,       "USART1" },
+    { USART2_IRQn,       "USART2" },
+    { USART3_IRQn,       "USART3" },
+    { UART4_IRQn,        "UART4" },
+    { UART5_IRQn,        "UART5" },
+    { USART6_IRQn,       "USART6" },
+    { UART7_IRQn,        "UART7" },
+    { UART8_IRQn,        "UART8" },
+    { DMA1_Stream0_IRQn, "DMA1_S0" },
+    { DMA1_Stream1_IRQn, "DMA1_S1" },
+    { DMA1_Stream2_IRQn, "DMA1_S2" },
+    { DMA1_Stream3_IRQn, "DMA1_S3" },
+    { DMA1_Stream4_IRQn, "DMA1_S4" },
+    { DMA1_Stream5_IRQn, "DMA1_S5" },
+    { DMA1_Stream6_IRQn, "DMA1_S6" },
+    { DMA1_Stream7_IRQn, "DMA1_S7" },
+    { DMA2_Stream0_IRQn, "DMA2_S0" },
+    { DMA2_Stream1_IRQn, "DMA2_S1" },
+    { DMA2_Stream2_IRQn, "DMA2_S2" },
+    { DMA2_Stream3_IRQn, "DMA2_S3" },
+    { DMA2_Stream4_IRQn, "DMA2_S4" },
+    { DMA2_Stream5_IRQn, "DMA2_S5" },
+    { DMA2_Stream6_IRQn, "DMA2_S6" },
+    { DMA2_Stream7_IRQn, "DMA2_S7" },
+    { MDMA_IRQn,         "MDMA" },
+};
+
+// What is on the terminal, one string per row. Single instance, a
+// second top (from any session) is refused
+static char top_screen[TOP_ROWS][TOP_COLS + 1];
+static uint32_t top_seq;
+
+static const char *top_irq_name(uint32_t vect, char *buf, size_t size)
+{
+    int irqn = (int)vect - 16;
+
+    for (size_t i = 0; i < sizeof(irq_names) / sizeof(irq_names[0]); i++) {
+        if (irq_names[i].irqn == irqn) {
+            return irq_names[i].name;
+        }
+    }
+    snprintf(buf, size, "IRQ%d", irqn);
+    return buf;
+}
+
+static uint32_t top_us(uint32_t cycles)
+{
+    return (uint32_t)((uint64_t)cycles * 1000000U / SystemCoreClock);
+}
+
+// Send only the cells of @row that changed since the last draw
+static void top_put(FILE *out, int row, const char *text)
+{
+    char line[TOP_COLS + 1];
+    char *old = top_screen[row];
+    size_t len = strlen(text);
+    int col = 0;
+
+    if (len > TOP_COLS) {
+        len = TOP_COLS;
+    }
+    memset(line, ' ', TOP_COLS);
+    memcpy(line, text, len);
+    line[TOP_COLS] = '\0';
+
+    while (col < TOP_COLS) {
+        if (line[col] == old[col]) {
+            col++;
+            continue;
+        }
+        int end = col;
+        while (end < TOP_COLS && line[end] != old[end]) {
+            end++;
+        }
+        fgotoxy(out, col + 1, row + 1);
+        fprintf(out, "%.*s", end - col, &line[col]);
+        col = end;
+    }
+    memcpy(old, line, sizeof(line));
+}
+
+static void top_draw(FILE *out)
+{
+    char text[TOP_COLS + 16];
+    char name[12];
+    sched_info_t info;
+    uint32_t busy = cpuload_permille();
+    int row = 0;
+
+    snprintf(text, sizeof(text), "cpu %3lu.%lu%%  idle %3lu.%lu%%  window %lu ms",
+             busy / 10, busy % 10, (1000 - busy) / 10, (1000 - busy) % 10,
+             (unsigned long)(win.wall * 1000U / SystemCoreClock));
+    top_put(out, row++, text);
+    // Tasks keep only the longest run since boot, like the IRQ peak
+    top_put(out, row++, "TASK      PRIO  CPU%   RUNS PEAK us");
+
+    for (int id = 0; id < TOP_TASK_ROWS; id++) {
+        text[0] = '\0';
+        if (sched_task_info(id, &info) == 0) {
+            uint32_t share = cpuload_share(win.task[id], win.wall);
+            snprintf(text, sizeof(text), "%-8s %5u %3lu.%lu %6lu %7lu",
+                     info.name, info.prio, share / 10, share % 10,
+                     win.runs[id], top_us(info.max_cycles));
+        }
+        top_put(out, row++, text);
+    }
+
+    top_put(out, row++, "");
+    top_put(out, row++, "IRQ             CPU%  COUNT  MAX us PEAK us");
+
+    int shown = 0;
+    for (uint32_t v = 0; v < CPULOAD_VECTORS && shown < TOP_IRQ_ROWS; v++) {
+        const cpuload_irq_t *irq = &win.irq[v];
+
+        if (irq->count == 0 && win.irq_peak[v] == 0) {
+            continue;
+        }
+        uint32_t share = cpuload_share(irq->cycles, win.wall);
+        snprintf(text, sizeof(text), "%-14s %3lu.%lu %6lu %7lu %7lu",
+                 top_irq_name(v, name, sizeof(name)), share / 10, share % 10,
+                 irq->count, top_us(irq->max), top_us(win.irq_peak[v]));
+        top_put(out, row++, text);
+        shown++;
+    }
+    while (shown++ < TOP_IRQ_ROWS) {
+        top_put(out, row++, "");
+    }
+
+    // Park the cursor under the table for the prompt
+    fgotoxy(out, 1, TOP_ROWS + 1);
+    fflush(out);
+}
+
+static int top_job(job_t *j)
+{
+    JOB_BEGIN(j);
+
+    memset(top_screen, 0, sizeof(top_screen));
+    fclrscr(j->session->out);
+    top_seq = win.seq - 1U;
+
+    for (;;) {
+        if (top_seq != win.seq) {
+            top_seq = win.seq;
+            top_draw(j->session->out);
+        }
+        JOB_SLEEP(j, TOP_POLL_MS);
+    }
+
+    JOB_END(j);
+}
+
+int ucmd_top(ucmd_session_t *s, int argc, char **argv)
+{
+    (void)argv;
+
+    if (argc > 1) {
+        fprintf(s->out, "usage: top (Ctrl+C to stop)" ENDL);
+        return -EINVAL;
+    }
+
+    if (job_find(top_job) >= 0) {
+        fprintf(s->out, "top is already running" ENDL);
+        return -EBUSY;
+    }
+
+    int id = job_start(s, "top", top_job, NULL, 0);
+    if (id < 0) {
+        fprintf(s->out, "top: can't start (%d)" ENDL, id);
+        return id;
+    }
+    return 0;
+}
+
+UCMD_REGISTER(top, "top", ucmd_top, "cpu load per task and irq, Ctrl+C to stop");
@@ -0,0 +1,78 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * cpuload.h - CPU load, per task and per IRQ time accounting
+ *
+ * Copyright (c) 2025 Michael Kaa
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _CPULOAD_H
+#define _CPULOAD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <errno.h>
+
+#include "stm32h743xx.h"
+#include "ucmd.h"
+
+// Accounting window
+#ifndef CPULOAD_WINDOW_MS
+#define CPULOAD_WINDOW_MS 1000U
+#endif
+
+// Exception numbers tracked: 16 system + device IRQs
+#define CPULOAD_VECTORS (16U + 150U)
+
+/**
+ * struct cpuload_irq - Time spent in one handler
+ * @cycles: CPU cycles, nested handlers included
+ * @count: Entries
+ * @max: Longest entry, cycles
+ */
+typedef struct cpuload_irq {
+    uint32_t cycles;
+    uint32_t count;
+    uint32_t max;
+} cpuload_irq_t;
+
+// Enable DWT CYCCNT and start the window timer, after systimer_task_init()
+int cpuload_init(void);
+
+// Busy share of the last window, 0.1 % units
+uint32_t cpuload_permille(void);
+
+static inline uint32_t cpuload_irq_enter(void)
+{
+    return DWT->CYCCNT;
+}
+
+void cpuload_irq_exit(uint32_t start);
+
+// Wrap a handler body, the active exception number picks the slot
+#define CPULOAD_IRQ_ENTER() uint32_t cpuload_start_ = cpuload_irq_enter()
+#define CPULOAD_IRQ_EXIT()  cpuload_irq_exit(cpuload_start_)
+
+/**
+ * Live CPU view, redrawn every window until Ctrl+C: top
+ */
+int ucmd_top(ucmd_session_t *s, int argc, char **argv);
+
+#endif /* _CPULOAD_H */
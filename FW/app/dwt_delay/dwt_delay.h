@@ -1,21 +1,23 @@
-// DWT (Data Watchpoint and Trace) delay utilities for STM32F407
+// DWT (Data Watchpoint and Trace) delay utilities for STM32H743
 // Michael Kaa
 // 03.11.2025
 
 #ifndef DWT_DELAY_H
 #define DWT_DELAY_H
 
-#include "core_cm4.h"
+#include "stm32h743xx.h"
 
-#ifndef SystemCoreClock
-#define SystemCoreClock (168000000U)
-#endif
+// Частота берётся из SystemCoreClock (system_init.c)
+// CYCCNT не считает во время WFI, для времени есть systime.h
 
 // Инициализация DWT счётчика
 static inline void dwt_delay_init(void)
 {
     // Включаем тактирование DWT (требуется для доступа к счётчику циклов)
     CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+
+    // На Cortex-M7 регистры DWT закрыты Lock Access Register
+    DWT->LAR = 0xC5ACCE55U;
     
     // Сбрасываем счётчик и включаем его
     DWT->CYCCNT = 0;
@@ -0,0 +1,284 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * job.c - Resumable background jobs for CLI commands
+ * 
+ * Copyright (c) 2025 Michael Kaa
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * A command that would run for long starts a job instead and returns.
+ * The runner is a low priority scheduler task: it gives every job one
+ * slice and posts itself again, so the CLI task (higher priority) gets
+ * the CPU between slices whenever input arrives.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "job.h"
+#include "sched.h"
+#include "ucmd.h"
+
+#define ENDL "\r\n"
+
+static job_t jobs[JOB_MAX];
+static int job_task = -1;
+
+static void job_run(uint32_t events, void *ctx)
+{
+    int active = 0;
+
+    (void)events;
+    (void)ctx;
+
+    for (int id = 0; id < JOB_MAX; id++) {
+        job_t *j = &jobs[id];
+
+        if (!j->active) {
+            continue;
+        }
+
+        if (j->cancel) {
+            systimer_stop(&j->timer);
+            if (j->abort) {
+                j->abort(j);
+            }
+            fprintf(j->session->out, "[%d] cancelled %s" ENDL, id, j->name);
+            fflush(j->session->out);
+            j->active = 0;
+            continue;
+        }
+
+        if (j->sleeping) {
+            continue;
+        }
+
+        int ret = j->fn(j);
+
+        // Partial lines of the slice go out now, not with the next one
+        fflush(j->session->out);
+        if (ret == JOB_DONE) {
+            j->active = 0;
+        } else if (!j->sleeping) {
+            active++;
+        }
+    }
+
+    // Come back after whatever is more urgent
+    if (active) {
+        sched_post(job_task, SCHED_EV_USER);
+    }
+}
+
+// Timer task context
+static void job_wake(void *ctx)
+{
+    ((job_t *)ctx)->sleeping = 0;
+    sched_post(job_task, SCHED_EV_TIMER);
+}
+
+int job_find(job_fn_t fn)
+{
+    for (int id = 0; id < JOB_MAX; id++) {
+        if (jobs[id].active && !jobs[id].cancel && jobs[id].fn == fn) {
+            return id;
+        }
+    }
+    return -ESRCH;
+}
+
+void job_sleep(job_t *job, uint32_t ms)
+{
+    job->sleeping = 1;
+    if (systimer_start(&job->timer, ms, 0, job_wake, job, 0) < 0) {
+        job->sleeping = 0; // no timebase, just yield
+    }
+}
+
+void job_resume(int id)
+{
+    if (id < 0 || id >= JOB_MAX) {
+        return;
+    }
+    jobs[id].sleeping = 0;
+    sched_post(job_task, SCHED_EV_USER);
+}
+
+int job_init(uint8_t prio)
+{
+    if (job_task < 0) {
+        job_task = sched_task_add("jobs", prio, job_run, NULL);
+    }
+    return job_task < 0 ? job_task : 0;
+}
+
+int job_start(ucmd_session_t *s, const char *name, job_fn_t fn, const void *data, size_t size)
+{
+    if (s == NULL || fn == NULL || size > JOB_DATA_SIZE) {
+        return -EINVAL;
+    }
+    if (job_task < 0) {
+        return -ENODEV;
+    }
+
+    for (int id = 0; id < JOB_MAX; id++) {
+        job_t *j = &jobs[id];
+
+        if (j->active) {
+            continue;
+        }
+
+        memset(j, 0, sizeof(*j));
+        j->name = name;
+        j->session = s;
+        j->fn = fn;
+        if (data != NULL) {
+            memcpy(j->data, data, size);
+        }
+        j->active = 1;
+
+        sched_post(job_task, SCHED_EV_USER);
+        return id;
+    }
+
+    return -EBUSY;
+}
+
+int job_set_abort(int id, job_abort_fn_t abort)
+{
+    if (id < 0 || id >= JOB_MAX || !jobs[id].active) {
+        return -ESRCH;
+    }
+    jobs[id].abort = abort;
+    return 0;
+}
+
+int job_cancel(int id)
+{
+    if (id < 0 || id >= JOB_MAX || !jobs[id].active) {
+        return -ESRCH;
+    }
+    jobs[id].cancel = 1;
+    // A sleeping job is dropped right away
+    sched_post(job_task, SCHED_EV_USER);
+    return 0;
+}
+
+int job_cancel_all(void)
+{
+    int n = 0;
+
+    for (int id = 0; id < JOB_MAX; id++) {
+        if (job_cancel(id) == 0) {
+            n++;
+        }
+    }
+    return n;
+}
+
+void job_sigint(ucmd_session_t *s)
+{
+    int n = 0;
+
+    for (int id = 0; id < JOB_MAX; id++) {
+        if (jobs[id].active && jobs[id].session == s && job_cancel(id) == 0) {
+            n++;
+        }
+    }
+    if (n == 0) {
+        fprintf(s->out, "^C" ENDL);
+    }
+}
+
+static const uarg_spec_t jobs_kill_args = UARG_SPEC("jobs kill", UARG_DEC("<id>", 0, JOB_MAX - 1));
+
+static int ucmd_jobs_kill(ucmd_session_t *s, int argc, char* argv[])
+{
+    uarg_val_t v[1];
+
+    if (uarg_parse(s->out, &jobs_kill_args, argc, argv, v) < 0) {
+        return -EINVAL;
+    }
+    if (job_cancel((int)v[0].u) < 0) {
+        fprintf(s->out, "No job %s" ENDL, argv[1]);
+        return -ESRCH;
+    }
+    return 0;
+}
+
+int ucmd_jobs(ucmd_session_t *s, int argc, char* argv[])
+{
+    (void)argv;
+
+    if (argc != 1) {
+        fprintf(s->out, "Usage: jobs [kill <id>]" ENDL);
+        return -EINVAL;
+    }
+
+    int n = 0;
+    for (int id = 0; id < JOB_MAX; id++) {
+        const job_t *j = &jobs[id];
+
+        if (!j->active) {
+            continue;
+        }
+        n++;
+        if (j->total) {
+            fprintf(s->out, "[%d] %-12s %-8s %3lu%%" ENDL, id, j->name, j->session->name,
+                    (unsigned long)((uint64_t)j->done * 100U / j->total));
+        } else {
+            fprintf(s->out, "[%d] %-12s %-8s %lu" ENDL, id, j->name, j->session->name,
+                    (unsigned long)j->done);
+        }
+    }
+    if (n == 0) {
+        fprintf(s->out, "No jobs" ENDL);
+    }
+    return 0;
+}
+
+UCMD_REGISTER(jobs, "jobs", ucmd_jobs, "background jobs, jobs [kill <id>]");
+
+// Ids of the running jobs
+static void jobs_kill_complete(int argn, const char* prefix)
+{
+    static char ids[JOB_MAX][4];
+
+    if (argn != 1) {
+        return;
+    }
+    for (int id = 0; id < JOB_MAX; id++) {
+        if (!jobs[id].active) {
+            continue;
+        }
+        snprintf(ids[id], sizeof(ids[id]), "%d", id);
+        if (strncmp(ids[id], prefix, strlen(prefix)) == 0) {
+            ucmd_complete_add(ids[id]);
+        }
+    }
+}
+
+UCMD_REGISTER_EX(jobs_kill, "jobs.kill", ucmd_jobs_kill, "cancel a job", jobs_kill_complete, &jobs_kill_args);
+
+#undef ENDL
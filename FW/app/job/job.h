@@ -0,0 +1,137 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * job.h - Resumable background jobs for CLI commands
+ *
+ * Copyright (c) 2025 Michael Kaa
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _JOB_H
+#define _JOB_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <errno.h>
+
+#include "systime.h"
+#include "ucmd.h"
+
+// Concurrent jobs
+#ifndef JOB_MAX
+#define JOB_MAX 4
+#endif
+
+// Private state per job, see job_start()
+#define JOB_DATA_SIZE 32
+
+#define JOB_RUNNING 0
+#define JOB_DONE    1
+
+/**
+ * struct job - Background job, a protothread
+ * @name: Shown by "jobs"
+ * @session: CLI session that started the job, it prints to @session->out
+ *           and Ctrl+C there cancels it
+ * @fn: Body, runs one slice per call and returns JOB_RUNNING or JOB_DONE
+ * @lc: Resume point, managed by JOB_BEGIN/JOB_YIELD
+ * @cancel: Set by Ctrl+C or "jobs kill", the job is dropped before its
+ *          next slice
+ * @abort: Called once when the job is dropped on @cancel, stops what the
+ *         job waits for (an MDMA run), see job_set_abort(). May be NULL
+ * @done: Progress, units of @total, updated by @fn
+ * @total: Progress end, 0 if unknown
+ * @sleeping: Skipped by the runner until @timer fires, see JOB_SLEEP
+ * @timer: Wake up timer
+ * @data: State that survives a yield (locals don't)
+ */
+typedef struct job job_t;
+typedef int (*job_fn_t)(job_t *job);
+typedef void (*job_abort_fn_t)(job_t *job);
+
+struct job {
+    const char *name;
+    ucmd_session_t *session;
+    job_fn_t fn;
+    uint32_t lc;
+    volatile uint8_t cancel;
+    uint8_t active;
+    job_abort_fn_t abort;
+    uint32_t done;
+    uint32_t total;
+    volatile uint8_t sleeping;
+    systimer_t timer;
+    uint32_t data[JOB_DATA_SIZE / 4];
+};
+
+// Protothread style body: locals don't survive JOB_YIELD, keep state in
+// job->data. No switch statement may enclose a JOB_YIELD
+#define JOB_BEGIN(j)  switch ((j)->lc) { case 0:
+#define JOB_YIELD(j)  do { (j)->lc = __LINE__; return JOB_RUNNING; case __LINE__:; } while (0)
+#define JOB_END(j)    } (j)->lc = 0; return JOB_DONE
+
+// Yield for at least @ms, the job takes no CPU meanwhile
+#define JOB_SLEEP(j, ms) do { job_sleep((j), (ms)); JOB_YIELD(j); } while (0)
+
+// Yield until @cond holds, an interrupt makes it true and calls
+// job_resume() with the job id. Parked before the check, so a wake up
+// between the check and the yield isn't lost
+#define JOB_WAIT(j, cond)                                   \
+    do {                                                    \
+        while (!(cond)) {                                   \
+            (j)->sleeping = 1;                              \
+            if (cond) {                                     \
+                (j)->sleeping = 0;                          \
+                break;                                      \
+            }                                               \
+            JOB_YIELD(j);                                   \
+        }                                                   \
+    } while (0)
+
+// Register the job runner as a scheduler task
+int job_init(uint8_t prio);
+
+// Start a job for session @s with a copy of @data (up to JOB_DATA_SIZE),
+// returns its id
+int job_start(ucmd_session_t *s, const char *name, job_fn_t fn, const void *data, size_t size);
+
+// Cleanup of job @id on cancel, set right after job_start(). The job
+// runner calls it, also for a job cancelled while parked by JOB_WAIT
+int job_set_abort(int id, job_abort_fn_t abort);
+
+// Id of the active job running @fn, -ESRCH if none
+int job_find(job_fn_t fn);
+
+// Park a job for @ms, use JOB_SLEEP
+void job_sleep(job_t *job, uint32_t ms);
+
+// Wake job @id parked by JOB_WAIT, safe from interrupts
+void job_resume(int id);
+
+// Cancel one job, all jobs; job_cancel_all() returns how many
+int job_cancel(int id);
+int job_cancel_all(void);
+
+// Ctrl+C handler for ucmd_session_set_sigint(), cancels the jobs of @s
+void job_sigint(ucmd_session_t *s);
+
+// uCMD handler: jobs [kill <id>]
+int ucmd_jobs(ucmd_session_t *s, int argc, char **argv);
+
+#endif /* _JOB_H */
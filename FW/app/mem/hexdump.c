@@ -0,0 +1,141 @@
+/**
+ * @file hexdump.c
+ * @brief Table driven hexdump
+ * @author Mikhael Kaa (Михаил Каа)
+ * @date 17.10.2026
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include "hexdump.h"
+
+#ifdef BAREMETAL
+#define ENDL "\r\n"
+#else
+#define ENDL "\n"
+#endif // BAREMETAL
+
+// "0x" address ": " groups "| " ascii ENDL, the widest is byte groups
+// and a 64 bit host address
+#define HEXDUMP_LINE_MAX (2U + 16U + 2U + HEXDUMP_LINE * 3U + 2U + HEXDUMP_LINE + sizeof(ENDL) - 1U)
+
+static const char hexdump_digits[16] = "0123456789abcdef";
+
+// Rendered lines wait here for one fwrite. Shared: a step never yields,
+// and the tasks calling it don't preempt each other
+static char hexdump_block[HEXDUMP_BLOCK_LINES * HEXDUMP_LINE_MAX];
+
+int hexdump_init(hexdump_t* h, const void* buf, uint32_t len, int group)
+{
+    if (group != 1 && group != 2 && group != 4)
+    {
+        return -EINVAL;
+    }
+    h->buf    = (const uint8_t*)buf;
+    h->len    = len;
+    h->pos    = 0;
+    h->group  = (uint8_t)group;
+    h->folded = 0;
+    return 0;
+}
+
+static char* hexdump_endl(char* p)
+{
+    memcpy(p, ENDL, sizeof(ENDL) - 1U);
+    return p + sizeof(ENDL) - 1U;
+}
+
+// @n bytes of @line, a short last line is padded to keep the ASCII column
+static char* hexdump_line(char* p, const hexdump_t* h, const uint8_t* line, uint32_t n)
+{
+    uintptr_t addr   = (uintptr_t)line;
+    unsigned  digits = 8;
+
+    // At least 8 digits, like %08lx
+    while (digits < sizeof(uintptr_t) * 2U && (addr >> (digits * 4U)) != 0)
+    {
+        digits += 4U;
+    }
+    *p++ = '0';
+    *p++ = 'x';
+    for (unsigned d = digits; d > 0; d--)
+    {
+        *p++ = hexdump_digits[(addr >> ((d - 1U) * 4U)) & 0xfU];
+    }
+    *p++ = ':';
+    *p++ = ' ';
+
+    // A group shows its value, so the high byte comes first
+    for (uint32_t g = 0; g < HEXDUMP_LINE; g += h->group)
+    {
+        for (uint32_t b = h->group; b > 0; b--)
+        {
+            uint32_t i = g + b - 1U;
+            if (i < n)
+            {
+                *p++ = hexdump_digits[line[i] >> 4];
+                *p++ = hexdump_digits[line[i] & 0xfU];
+            }
+            else
+            {
+                *p++ = ' ';
+                *p++ = ' ';
+            }
+        }
+        *p++ = ' ';
+    }
+
+    *p++ = '|';
+    *p++ = ' ';
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint8_t c = line[i];
+        *p++      = (c >= 32 && c <= 126) ? (char)c : '.';
+    }
+    return hexdump_endl(p);
+}
+
+int hexdump_step(FILE* out, hexdump_t* h, uint32_t n)
+{
+    char*    p   = hexdump_block;
+    uint32_t end = (h->len - h->pos < n) ? h->len : h->pos + n;
+
+    while (h->pos < end)
+    {
+        const uint8_t* line = h->buf + h->pos;
+        uint32_t       cnt  = h->len - h->pos < HEXDUMP_LINE ? h->len - h->pos : HEXDUMP_LINE;
+
+        if (h->pos >= HEXDUMP_LINE && cnt == HEXDUMP_LINE && h->pos + cnt < h->len &&
+            memcmp(line, line - HEXDUMP_LINE, HEXDUMP_LINE) == 0)
+        {
+            if (!h->folded)
+            {
+                *p++      = '*';
+                p         = hexdump_endl(p);
+                h->folded = 1;
+            }
+        }
+        else
+        {
+            p         = hexdump_line(p, h, line, cnt);
+            h->folded = 0;
+        }
+        h->pos += cnt;
+
+        if ((size_t)(hexdump_block + sizeof(hexdump_block) - p) < HEXDUMP_LINE_MAX)
+        {
+            fwrite(hexdump_block, 1, (size_t)(p - hexdump_block), out);
+            p = hexdump_block;
+        }
+    }
+    if (p != hexdump_block)
+    {
+        fwrite(hexdump_block, 1, (size_t)(p - hexdump_block), out);
+    }
+    return h->pos < h->len;
+}
+
+#undef ENDL
@@ -0,0 +1,47 @@
+/**
+ * @file hexdump.h
+ * @brief Table driven hexdump: whole lines rendered into a buffer,
+ *        8/16/32 bit groups, repeated lines folded into '*'
+ * @author Mikhael Kaa (Михаил Каа)
+ * @date 17.10.2026
+ */
+
+#ifndef _HEXDUMP_
+#define _HEXDUMP_
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Bytes per line
+#define HEXDUMP_LINE 16U
+
+// Lines rendered before a write
+#define HEXDUMP_BLOCK_LINES 8U
+
+/**
+ * struct hexdump - A dump in progress, resumable between steps
+ * @buf: Start of the dump, also the address shown
+ * @len: Bytes
+ * @pos: Bytes dumped so far, a multiple of HEXDUMP_LINE until the end
+ * @group: Bytes per group, 1, 2 or 4. Groups show the value the CPU
+ *         reads (little endian)
+ * @folded: The last line matched the one before and a '*' is out
+ */
+typedef struct hexdump
+{
+    const uint8_t* buf;
+    uint32_t       len;
+    uint32_t       pos;
+    uint8_t        group;
+    uint8_t        folded;
+} hexdump_t;
+
+// 0, or -EINVAL if @group is not 1, 2 or 4
+int hexdump_init(hexdump_t* h, const void* buf, uint32_t len, int group);
+
+// Dump up to @n more bytes (rounded up to whole lines), returns 1 while
+// there are more. Lines equal to the one before become a single '*',
+// the last line is always shown
+int hexdump_step(FILE* out, hexdump_t* h, uint32_t n);
+
+#endif /* _HEXDUMP_ */
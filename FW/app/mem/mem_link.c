@@ -0,0 +1,383 @@
+/**
+ * @file mem_link.c
+ * @brief Binary memory upload/download, the device end
+ * @author Mikhael Kaa (Михаил Каа)
+ * @date 17.10.2026
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include "mem_link.h"
+#include "crc_sw.h"
+
+static void mem_link_put16(uint8_t* p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void mem_link_put32(uint8_t* p, uint32_t v)
+{
+    mem_link_put16(p, v);
+    mem_link_put16(p + 2, v >> 16);
+}
+
+static uint32_t mem_link_get16(const uint8_t* p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8;
+}
+
+static uint32_t mem_link_get32(const uint8_t* p)
+{
+    return mem_link_get16(p) | mem_link_get16(p + 2) << 16;
+}
+
+// Header, payload straight from where it is, crc
+static void mem_link_send(mem_link_t* l, uint8_t type, uint32_t off, const void* payload, uint32_t len)
+{
+    uint8_t hdr[MEM_LINK_HDR];
+    uint8_t crc[4];
+
+    hdr[0] = MEM_LINK_SOF;
+    hdr[1] = type;
+    mem_link_put16(hdr + 2, len);
+    mem_link_put32(hdr + 4, off);
+    mem_link_put32(crc, crc32_update(crc32_update(0, hdr + 1, MEM_LINK_HDR - 1U), payload, len));
+
+    // A failed write is a lost frame, the timeouts deal with it
+    l->write(l->ctx, hdr, sizeof(hdr));
+    if (len)
+    {
+        l->write(l->ctx, payload, len);
+    }
+    l->write(l->ctx, crc, sizeof(crc));
+}
+
+static void mem_link_hello(mem_link_t* l)
+{
+    uint8_t p[12];
+
+    mem_link_put32(p, (uint32_t)l->addr);
+    mem_link_put32(p + 4, l->len);
+    mem_link_put16(p + 8, MEM_LINK_CHUNK);
+    mem_link_put16(p + 10, MEM_LINK_WINDOW);
+    mem_link_send(l, MEM_LINK_HELLO, 0, p, sizeof(p));
+}
+
+// END and the ACK that closes a transfer carry the crc of the range
+static void mem_link_close(mem_link_t* l, uint8_t type)
+{
+    uint8_t p[4];
+
+    mem_link_put32(p, l->crc);
+    mem_link_send(l, type, l->len, p, sizeof(p));
+}
+
+void mem_link_fail(mem_link_t* l, int err)
+{
+    mem_link_send(l, MEM_LINK_ABORT, l->next, NULL, 0);
+    l->status = err;
+}
+
+void mem_link_init(mem_link_t* l, uintptr_t addr, uint32_t len, int put, mem_link_write_t write, void* ctx,
+                   uint32_t now_ms)
+{
+    memset(l, 0, offsetof(mem_link_t, rx));
+    l->addr    = addr;
+    l->len     = len;
+    l->put     = put != 0;
+    l->write   = write;
+    l->ctx     = ctx;
+    l->last_ms  = now_ms;
+    l->answered = MEM_LINK_NONE;
+    l->status   = -EINPROGRESS;
+    mem_link_hello(l);
+}
+
+// Host reads: ACKs move the window, a NAK or a timeout goes back
+static void mem_link_get_frame(mem_link_t* l, uint8_t type, uint32_t off, const uint8_t* p, uint32_t n,
+                               uint32_t now_ms)
+{
+    if (type == MEM_LINK_ACK && l->phase == MEM_LINK_PH_HELLO && off <= l->len)
+    {
+        l->phase = MEM_LINK_PH_DATA;
+        l->next = l->acked = off;
+    }
+    else if (type == MEM_LINK_ACK && l->phase == MEM_LINK_PH_END && off == l->len && n == 4U)
+    {
+        l->status = mem_link_get32(p) == l->crc ? 0 : -EBADMSG;
+    }
+    else if ((type == MEM_LINK_ACK || type == MEM_LINK_NAK) && l->phase == MEM_LINK_PH_DATA && off >= l->acked &&
+             off <= l->next)
+    {
+        if (off == l->acked && type == MEM_LINK_ACK)
+        {
+            return; // an old one
+        }
+        l->acked = off;
+        if (type == MEM_LINK_NAK && l->next != off)
+        {
+            l->next = off;
+            l->resends++;
+        }
+    }
+    else
+    {
+        return;
+    }
+    l->retries = 0;
+    l->last_ms = now_ms;
+}
+
+// Host writes: only the expected offset is taken, anything else gets
+// a NAK (a gap) or an ACK (a go-back over what is here already), once
+// per go-back of the host
+static void mem_link_put_frame(mem_link_t* l, uint8_t type, uint32_t off, const uint8_t* p, uint32_t n,
+                               uint32_t now_ms)
+{
+    if (type == MEM_LINK_DATA && l->phase <= MEM_LINK_PH_DATA && off == l->next && n <= l->len - off)
+    {
+        memcpy((void*)(l->addr + off), p, n);
+        l->crc      = crc32_update(l->crc, p, n);
+        l->next     = off + n;
+        l->phase    = MEM_LINK_PH_DATA;
+        l->answered = MEM_LINK_NONE;
+        l->retries  = 0;
+        l->last_ms  = now_ms;
+        if (l->next - l->acked >= MEM_LINK_WINDOW / 2U * MEM_LINK_CHUNK || l->next == l->len)
+        {
+            l->acked = l->next;
+            mem_link_send(l, MEM_LINK_ACK, l->acked, NULL, 0);
+        }
+    }
+    else if (type == MEM_LINK_DATA && l->phase <= MEM_LINK_PH_DATA && off <= l->answered)
+    {
+        l->answered = off;
+        if (off > l->next)
+        {
+            l->resends++;
+        }
+        l->acked = l->next;
+        mem_link_send(l, off > l->next ? MEM_LINK_NAK : MEM_LINK_ACK, l->next, NULL, 0);
+    }
+    else if (type == MEM_LINK_END && n == 4U && l->next == l->len)
+    {
+        // A repeated END gets the same answer, the first one was lost
+        if (l->phase != MEM_LINK_PH_CLOSE)
+        {
+            l->phase  = MEM_LINK_PH_CLOSE;
+            l->result = mem_link_get32(p) == l->crc ? 0 : -EBADMSG;
+        }
+        l->last_ms = now_ms;
+        if (l->result == 0)
+        {
+            mem_link_close(l, MEM_LINK_ACK);
+        }
+        else
+        {
+            mem_link_send(l, MEM_LINK_ABORT, l->len, NULL, 0);
+        }
+    }
+    else if (type == MEM_LINK_END && l->phase == MEM_LINK_PH_DATA)
+    {
+        mem_link_send(l, MEM_LINK_NAK, l->next, NULL, 0);
+    }
+    else if (type == MEM_LINK_ACK && l->phase == MEM_LINK_PH_CLOSE && off == l->len)
+    {
+        l->status = l->result;
+    }
+}
+
+// A whole frame at @l->rx that checked out
+static void mem_link_frame(mem_link_t* l, uint32_t now_ms)
+{
+    uint8_t  type = l->rx[1];
+    uint32_t n    = mem_link_get16(l->rx + 2);
+    uint32_t off  = mem_link_get32(l->rx + 4);
+
+    if (type == MEM_LINK_ABORT)
+    {
+        l->status = -ECANCELED;
+    }
+    else if (l->put)
+    {
+        if (type == MEM_LINK_DATA && off > l->top)
+        {
+            l->top = off;
+        }
+        mem_link_put_frame(l, type, off, l->rx + MEM_LINK_HDR, n, now_ms);
+    }
+    else
+    {
+        mem_link_get_frame(l, type, off, l->rx + MEM_LINK_HDR, n, now_ms);
+    }
+}
+
+// Drop the first byte of @l->rx, start over at the next SOF in it
+static void mem_link_resync(mem_link_t* l)
+{
+    const uint8_t* p = memchr(l->rx + 1, MEM_LINK_SOF, l->rx_len - 1U);
+
+    if (p == NULL)
+    {
+        l->rx_len = 0;
+        return;
+    }
+    l->rx_len -= (uint32_t)(p - l->rx);
+    memmove(l->rx, p, l->rx_len);
+
+    // The host writes by the window, a lost byte is a gap
+    if (l->put && l->phase == MEM_LINK_PH_DATA && l->answered == MEM_LINK_NONE)
+    {
+        l->answered = l->top;
+        l->resends++;
+        mem_link_send(l, MEM_LINK_NAK, l->next, NULL, 0);
+    }
+}
+
+// Handle what @l->rx holds, after a resync it may be more than a frame
+static void mem_link_scan(mem_link_t* l, uint32_t now_ms)
+{
+    while (l->rx_len >= MEM_LINK_HDR)
+    {
+        uint32_t n   = mem_link_get16(l->rx + 2);
+        uint32_t end = MEM_LINK_HDR + n;
+
+        if (n > MEM_LINK_CHUNK)
+        {
+            mem_link_resync(l);
+            continue;
+        }
+        if (l->rx_len < end + 4U)
+        {
+            return;
+        }
+        // Only a whole frame counts as bad, not each false SOF after it
+        if (crc32_update(0, l->rx + 1, end - 1U) != mem_link_get32(l->rx + end))
+        {
+            l->bad++;
+            mem_link_resync(l);
+            continue;
+        }
+        mem_link_frame(l, now_ms);
+        l->rx_len -= end + 4U;
+        memmove(l->rx, l->rx + end + 4U, l->rx_len);
+    }
+}
+
+size_t mem_link_rx(mem_link_t* l, const uint8_t* buf, size_t len, uint32_t now_ms)
+{
+    const uint8_t* start = buf;
+
+    l->rx_ms = now_ms;
+    l->quiet = 0;
+    while (len > 0 && l->status == -EINPROGRESS)
+    {
+        if (l->rx_len == 0)
+        {
+            const uint8_t* p = memchr(buf, MEM_LINK_SOF, len);
+            if (p == NULL)
+            {
+                return (size_t)(buf - start) + len;
+            }
+            len -= (size_t)(p - buf);
+            buf = p;
+        }
+
+        // Up to the end of the header, then of the frame, never past it
+        uint32_t want = MEM_LINK_HDR;
+        if (l->rx_len >= MEM_LINK_HDR)
+        {
+            want += mem_link_get16(l->rx + 2) + 4U;
+        }
+        size_t n = want - l->rx_len < len ? want - l->rx_len : len;
+        memcpy(l->rx + l->rx_len, buf, n);
+        l->rx_len += (uint32_t)n;
+        buf += n;
+        len -= n;
+        mem_link_scan(l, now_ms);
+    }
+    return (size_t)(buf - start);
+}
+
+int mem_link_poll(mem_link_t* l, uint32_t now_ms)
+{
+    if (l->status != -EINPROGRESS)
+    {
+        return 0;
+    }
+    if (!l->quiet && now_ms - l->rx_ms >= MEM_LINK_IDLE_MS)
+    {
+        l->quiet = 1;
+        if (l->rx_len)
+        {
+            mem_link_resync(l);
+            mem_link_scan(l, now_ms);
+        }
+        else if (l->put && l->phase == MEM_LINK_PH_DATA)
+        {
+            l->acked = l->next;
+            mem_link_send(l, l->answered == MEM_LINK_NONE ? MEM_LINK_ACK : MEM_LINK_NAK, l->next, NULL, 0);
+        }
+    }
+
+    if (!l->put && l->phase == MEM_LINK_PH_DATA)
+    {
+        if (l->next < l->len && l->next - l->acked < MEM_LINK_WINDOW * MEM_LINK_CHUNK)
+        {
+            uint32_t n = l->len - l->next < MEM_LINK_CHUNK ? l->len - l->next : MEM_LINK_CHUNK;
+            mem_link_send(l, MEM_LINK_DATA, l->next, (const void*)(l->addr + l->next), n);
+            l->next += n;
+            return 1;
+        }
+        if (l->acked == l->len)
+        {
+            l->phase   = MEM_LINK_PH_END;
+            l->last_ms = now_ms;
+            l->crc     = crc32_update(0, (const void*)l->addr, l->len);
+            mem_link_close(l, MEM_LINK_END);
+            return 0;
+        }
+    }
+
+    // After the answer to END wait for the host's ACK or out a repeated
+    // END, longer than the host waits for the answer
+    if (l->phase == MEM_LINK_PH_CLOSE)
+    {
+        if (now_ms - l->last_ms >= 2U * MEM_LINK_TIMEOUT_MS)
+        {
+            l->status = l->result;
+        }
+        return 0;
+    }
+    if (now_ms - l->last_ms < MEM_LINK_TIMEOUT_MS)
+    {
+        return 0;
+    }
+    l->last_ms = now_ms;
+    if (++l->retries > MEM_LINK_RETRIES)
+    {
+        mem_link_fail(l, -ETIMEDOUT);
+        return 0;
+    }
+    if (l->phase == MEM_LINK_PH_HELLO)
+    {
+        mem_link_hello(l);
+    }
+    else if (l->phase == MEM_LINK_PH_END)
+    {
+        mem_link_close(l, MEM_LINK_END);
+    }
+    else if (l->put)
+    {
+        mem_link_send(l, MEM_LINK_ACK, l->next, NULL, 0);
+    }
+    else
+    {
+        l->next = l->acked;
+        l->resends++;
+    }
+    return 0;
+}
@@ -0,0 +1,148 @@
+/**
+ * @file mem_link.h
+ * @brief Binary memory upload/download: mem get, mem put
+ * @author Mikhael Kaa (Михаил Каа)
+ * @date 17.10.2026
+ */
+
+#ifndef _MEM_LINK_
+#define _MEM_LINK_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Frames, both directions, little endian:
+ *
+ *   0xa5 | type | len:16 | off:32 | payload[len] | crc32
+ *
+ * crc32 (IEEE 802.3, zlib's crc32(), crc32_update() here) covers type
+ * to the payload end. A frame that doesn't check out is dropped, the
+ * receiver hunts for the next 0xa5, so text in the stream (a prompt, a
+ * message) is skipped too.
+ *
+ * The device starts with HELLO {addr:32, len:32, chunk:16, window:16}.
+ *
+ * mem get, the device sends:
+ *   host   ACK off         start (or resume) at off
+ *   device DATA off        up to window chunks past the last ACK
+ *   host   ACK off         everything below off arrived, cumulative
+ *   host   NAK off         a gap, go back to off
+ *   device END len {crc}   all acknowledged, crc32 of the whole range
+ *   host   ACK len {crc}   the crc it got, the device checks it: done
+ *
+ * mem put, the host sends:
+ *   host   DATA off        up to window chunks past the last ACK
+ *   device ACK off         every half window and at the end
+ *   device NAK off         a gap or a bad frame, go back to off
+ *   host   END len {crc}   after the last ACK
+ *   device ACK len {crc}   crc matched (ABORT if it didn't)
+ *   host   ACK len         done
+ *
+ * Without progress for MEM_LINK_TIMEOUT_MS the sender goes back to the
+ * last ACK and the device repeats its last ACK or HELLO, after
+ * MEM_LINK_RETRIES of them it sends ABORT. Either side may ABORT. A
+ * broken transfer resumes with a new mem get/put from the last
+ * acknowledged offset.
+ */
+
+#define MEM_LINK_SOF         0xa5U
+#define MEM_LINK_HDR         8U
+#define MEM_LINK_CHUNK       1024U // largest payload
+#define MEM_LINK_WINDOW      8U    // chunks in flight
+#define MEM_LINK_TIMEOUT_MS  500U
+#define MEM_LINK_IDLE_MS     50U   // a quiet line, see mem_link_poll()
+#define MEM_LINK_RETRIES     10U
+#define MEM_LINK_NONE        UINT32_MAX
+
+typedef enum mem_link_type
+{
+    MEM_LINK_HELLO = 'H',
+    MEM_LINK_DATA  = 'D',
+    MEM_LINK_ACK   = 'A',
+    MEM_LINK_NAK   = 'N',
+    MEM_LINK_END   = 'E',
+    MEM_LINK_ABORT = 'X',
+} mem_link_type_t;
+
+// Sends @len bytes, returns @len or negative errno
+typedef int (*mem_link_write_t)(void* ctx, const void* buf, size_t len);
+
+// Where a transfer is, see struct mem_link
+enum
+{
+    MEM_LINK_PH_HELLO, // HELLO out, waiting for the host
+    MEM_LINK_PH_DATA,  // DATA and ACK/NAK
+    MEM_LINK_PH_END,   // get: END out, waiting for ACK len
+    MEM_LINK_PH_CLOSE, // put: answered END, repeats the answer until quiet
+};
+
+/**
+ * struct mem_link - Device end of one transfer
+ * @addr, @len: Range
+ * @put: 1 - the host writes the range, 0 - it reads it
+ * @phase: MEM_LINK_PH_*
+ * @top: put - highest DATA offset seen
+ * @answered: put - offset of the frame last answered out of order,
+ *            MEM_LINK_NONE since @next moved. Frames sent after it are
+ *            ignored, one at or below it means the host went back
+ * @retries: Timeouts in a row
+ * @next: get - next offset to send, put - next offset expected
+ * @acked: Offset the last ACK covered
+ * @crc: put - crc32 of what has been written, get - of the range, at END
+ * @last_ms: Last progress, for the timeout
+ * @rx_ms: Last byte in
+ * @quiet: The line has been quiet for MEM_LINK_IDLE_MS and it was dealt
+ *         with
+ * @status: -EINPROGRESS, then 0 or negative errno
+ * @result: put - the answer to END, @status once the line is quiet
+ * @resends: get - go-backs, put - NAKs
+ * @bad: Whole frames dropped on a bad crc
+ * @write, @ctx: Transport
+ * @rx_len: Bytes in @rx
+ * @rx: Frame being received
+ */
+typedef struct mem_link
+{
+    uintptr_t        addr;
+    uint32_t         len;
+    uint8_t          put;
+    uint8_t          phase;
+    uint8_t          retries;
+    uint8_t          quiet;
+    uint32_t         next;
+    uint32_t         acked;
+    uint32_t         top;
+    uint32_t         answered;
+    uint32_t         crc;
+    uint32_t         last_ms;
+    uint32_t         rx_ms;
+    volatile int     status;
+    int              result;
+    uint32_t         resends;
+    uint32_t         bad;
+    mem_link_write_t write;
+    void*            ctx;
+    uint32_t         rx_len;
+    uint8_t          rx[MEM_LINK_HDR + MEM_LINK_CHUNK + 4U];
+} mem_link_t;
+
+// Start a transfer and send HELLO
+void mem_link_init(mem_link_t* l, uintptr_t addr, uint32_t len, int put, mem_link_write_t write, void* ctx,
+                   uint32_t now_ms);
+
+// Bytes from the host, in pieces of any size. Returns how many were
+// taken, less than @len once the transfer is over
+size_t mem_link_rx(mem_link_t* l, const uint8_t* buf, size_t len, uint32_t now_ms);
+
+// Send the next frame the window allows, handle timeouts. A quiet line
+// drops a frame cut short, and in put tells the host where the device
+// is (a lost ACK or NAK stalls it). Returns 1 if a frame went out and
+// there may be more, 0 if waiting for the host. Done when @l->status is
+// no longer -EINPROGRESS
+int mem_link_poll(mem_link_t* l, uint32_t now_ms);
+
+// Stop the transfer with @err: ABORT to the host, @l->status = @err
+void mem_link_fail(mem_link_t* l, int err);
+
+#endif /* _MEM_LINK_ */
@@ -0,0 +1,476 @@
+/**
+ * @file mem_test.c
+ * @brief RAM test engine
+ * @author Mikhael Kaa (Михаил Каа)
+ * @date 17.10.2026
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include "mem_test.h"
+
+#ifdef BAREMETAL
+#include "stm32h743xx.h"
+#define ENDL "\r\n"
+#else
+#include <time.h>
+#define ENDL "\n"
+#endif // BAREMETAL
+
+const char* const mem_test_alg_names[] = {"march", "walk1", "walk0", "addr", "checker", "all", NULL};
+
+#ifdef MEM_TEST_HOST
+// RAM model with injected faults, test/test_mem_test.c
+uint32_t model_rd32(uintptr_t a);
+void     model_wr32(uintptr_t a, uint32_t v);
+uint64_t model_rd64(uintptr_t a);
+void     model_wr64(uintptr_t a, uint64_t v);
+#define MEM_RD32(a)    model_rd32(a)
+#define MEM_WR32(a, v) model_wr32(a, v)
+#define MEM_RD64(a)    model_rd64(a)
+#define MEM_WR64(a, v) model_wr64(a, v)
+#endif // MEM_TEST_HOST
+
+#ifndef MEM_RD32
+#define MEM_RD32(a)    (*(volatile uint32_t*)(a))
+#define MEM_WR32(a, v) (*(volatile uint32_t*)(a) = (v))
+#define MEM_RD64(a)    (*(volatile uint64_t*)(a))
+#define MEM_WR64(a, v) (*(volatile uint64_t*)(a) = (v))
+#endif
+
+// Time base of the per algorithm speed
+#ifdef BAREMETAL
+#define MEM_TEST_CLOCK() (DWT->CYCCNT)
+#define MEM_TEST_HZ      SystemCoreClock
+#else
+static uint32_t mem_test_clock(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec);
+}
+#define MEM_TEST_CLOCK() mem_test_clock()
+#define MEM_TEST_HZ      1000000000U
+#endif // BAREMETAL
+
+// Address in address patterns, the upper half of a 64 bit word holds the
+// inverted address so it isn't constant
+#define MEM_ADDR32(a) ((uint32_t)(a))
+#define MEM_ADDR64(a) (((uint64_t)~(uint32_t)(a) << 32) | (uint32_t)(a))
+
+#define MEM_ROTL(T, p) ((T)(((p) << 1) | ((p) >> (sizeof(T) * 8U - 1U))))
+
+static __attribute__((noinline)) void mem_test_fault(mem_test_t* t, uintptr_t a, uint64_t expect, uint64_t got)
+{
+    if (t->errors < MEM_TEST_LOG)
+    {
+        t->log[t->errors].addr   = a;
+        t->log[t->errors].expect = expect;
+        t->log[t->errors].got    = got;
+    }
+    t->errors++;
+    t->stat[t->cur].errors++;
+    t->bad_bits |= expect ^ got;
+    t->map |= 1ULL << ((uint64_t)(a - t->base) * MEM_TEST_MAP / t->len);
+}
+
+// Next pass reads the RAM, not the lines the last one left in the D-cache
+static void mem_test_sync(const mem_test_t* t)
+{
+#ifdef BAREMETAL
+    if (SCB->CCR & SCB_CCR_DC_Msk)
+    {
+        uintptr_t a = t->base & ~(uintptr_t)31U;
+        SCB_CleanInvalidateDCache_by_Addr((uint32_t*)a, (int32_t)(t->base + t->len - a));
+    }
+#else
+    (void)t;
+#endif // BAREMETAL
+}
+
+/*
+ * Sweeps for one access width, four words per iteration. Reads are
+ * compared four at a time, mem_test_fault() only runs on a mismatch.
+ *   fill/verify       - v0 to even words, v1 to odd ones (solid, checker)
+ *   up/down           - March element: read expecting r, write w, per word
+ *   fill_walk/verify_walk - bit (shift + word index) % width set, ^ inv
+ *   fill_addr/verify_addr - the word address (MEM_ADDRn), ^ inv
+ */
+#define MEM_TEST_CHECK(t, a, e, x) \
+    do { if ((x) != (e)) mem_test_fault(t, a, e, x); } while (0)
+
+#define MEM_TEST_KERNELS(W, T, RD, WR, ADDR)                                              \
+    static void mem_fill##W(mem_test_t* t, T v0, T v1)                                    \
+    {                                                                                     \
+        uintptr_t a   = t->base;                                                          \
+        uintptr_t end = t->base + t->len;                                                 \
+        for (; end - a >= 4 * sizeof(T); a += 4 * sizeof(T))                              \
+        {                                                                                 \
+            WR(a, v0);                                                                    \
+            WR(a + sizeof(T), v1);                                                        \
+            WR(a + 2 * sizeof(T), v0);                                                    \
+            WR(a + 3 * sizeof(T), v1);                                                    \
+        }                                                                                 \
+        for (; a < end; a += sizeof(T))                                                   \
+            WR(a, ((a - t->base) / sizeof(T)) & 1U ? v1 : v0);                            \
+    }                                                                                     \
+                                                                                          \
+    static void mem_verify##W(mem_test_t* t, T v0, T v1)                                  \
+    {                                                                                     \
+        uintptr_t a   = t->base;                                                          \
+        uintptr_t end = t->base + t->len;                                                 \
+        for (; end - a >= 4 * sizeof(T); a += 4 * sizeof(T))                              \
+        {                                                                                 \
+            T x0 = RD(a);                                                                 \
+            T x1 = RD(a + sizeof(T));                                                     \
+            T x2 = RD(a + 2 * sizeof(T));                                                 \
+            T x3 = RD(a + 3 * sizeof(T));                                                 \
+            if (((x0 ^ v0) | (x1 ^ v1) | (x2 ^ v0) | (x3 ^ v1)) != 0)                     \
+            {                                                                             \
+                MEM_TEST_CHECK(t, a, v0, x0);                                             \
+                MEM_TEST_CHECK(t, a + sizeof(T), v1, x1);                                 \
+                MEM_TEST_CHECK(t, a + 2 * sizeof(T), v0, x2);                             \
+                MEM_TEST_CHECK(t, a + 3 * sizeof(T), v1, x3);                             \
+            }                                                                             \
+        }                                                                                 \
+        for (; a < end; a += sizeof(T))                                                   \
+        {                                                                                 \
+            T e = ((a - t->base) / sizeof(T)) & 1U ? v1 : v0;                             \
+            T x = RD(a);                                                                  \
+            MEM_TEST_CHECK(t, a, e, x);                                                   \
+        }                                                                                 \
+    }                                                                                     \
+                                                                                          \
+    static void mem_up##W(mem_test_t* t, T r, T w)                                        \
+    {                                                                                     \
+        uintptr_t a   = t->base;                                                          \
+        uintptr_t end = t->base + t->len;                                                 \
+        for (; end - a >= 4 * sizeof(T); a += 4 * sizeof(T))                              \
+        {                                                                                 \
+            T x0 = RD(a);                                                                 \
+            WR(a, w);                                                                     \
+            T x1 = RD(a + sizeof(T));                                                     \
+            WR(a + sizeof(T), w);                                                         \
+            T x2 = RD(a + 2 * sizeof(T));                                                 \
+            WR(a + 2 * sizeof(T), w);                                                     \
+            T x3 = RD(a + 3 * sizeof(T));                                                 \
+            WR(a + 3 * sizeof(T), w);                                                     \
+            if (((x0 ^ r) | (x1 ^ r) | (x2 ^ r) | (x3 ^ r)) != 0)                         \
+            {                                                                             \
+                MEM_TEST_CHECK(t, a, r, x0);                                              \
+                MEM_TEST_CHECK(t, a + sizeof(T), r, x1);                                  \
+                MEM_TEST_CHECK(t, a + 2 * sizeof(T), r, x2);                              \
+                MEM_TEST_CHECK(t, a + 3 * sizeof(T), r, x3);                              \
+            }                                                                             \
+        }                                                                                 \
+        for (; a < end; a += sizeof(T))                                                   \
+        {                                                                                 \
+            T x = RD(a);                                                                  \
+            WR(a, w);                                                                     \
+            MEM_TEST_CHECK(t, a, r, x);                                                   \
+        }                                                                                 \
+    }                                                                                     \
+                                                                                          \
+    static void mem_down##W(mem_test_t* t, T r, T w)                                      \
+    {                                                                                     \
+        uintptr_t a = t->base + t->len;                                                   \
+        for (; a - t->base >= 4 * sizeof(T); a -= 4 * sizeof(T))                          \
+        {                                                                                 \
+            T x3 = RD(a - sizeof(T));                                                     \
+            WR(a - sizeof(T), w);                                                         \
+            T x2 = RD(a - 2 * sizeof(T));                                                 \
+            WR(a - 2 * sizeof(T), w);                                                     \
+            T x1 = RD(a - 3 * sizeof(T));                                                 \
+            WR(a - 3 * sizeof(T), w);                                                     \
+            T x0 = RD(a - 4 * sizeof(T));                                                 \
+            WR(a - 4 * sizeof(T), w);                                                     \
+            if (((x0 ^ r) | (x1 ^ r) | (x2 ^ r) | (x3 ^ r)) != 0)                         \
+            {                                                                             \
+                MEM_TEST_CHECK(t, a - sizeof(T), r, x3);                                  \
+                MEM_TEST_CHECK(t, a - 2 * sizeof(T), r, x2);                              \
+                MEM_TEST_CHECK(t, a - 3 * sizeof(T), r, x1);                              \
+                MEM_TEST_CHECK(t, a - 4 * sizeof(T), r, x0);                              \
+            }                                                                             \
+        }                                                                                 \
+        for (; a > t->base; a -= sizeof(T))                                               \
+        {                                                                                 \
+            T x = RD(a - sizeof(T));                                                      \
+            WR(a - sizeof(T), w);                                                         \
+            MEM_TEST_CHECK(t, a - sizeof(T), r, x);                                       \
+        }                                                                                 \
+    }                                                                                     \
+                                                                                          \
+    static void mem_fill_walk##W(mem_test_t* t, unsigned int shift, T inv)                \
+    {                                                                                     \
+        uintptr_t a   = t->base;                                                          \
+        uintptr_t end = t->base + t->len;                                                 \
+        T         p   = (T)((T)1 << shift);                                               \
+        for (; end - a >= 4 * sizeof(T); a += 4 * sizeof(T))                              \
+        {                                                                                 \
+            WR(a, p ^ inv);                                                               \
+            p = MEM_ROTL(T, p);                                                           \
+            WR(a + sizeof(T), p ^ inv);                                                   \
+            p = MEM_ROTL(T, p);                                                           \
+            WR(a + 2 * sizeof(T), p ^ inv);                                               \
+            p = MEM_ROTL(T, p);                                                           \
+            WR(a + 3 * sizeof(T), p ^ inv);                                               \
+            p = MEM_ROTL(T, p);                                                           \
+        }                                                                                 \
+        for (; a < end; a += sizeof(T))                                                   \
+        {                                                                                 \
+            WR(a, p ^ inv);                                                               \
+            p = MEM_ROTL(T, p);                                                           \
+        }                                                                                 \
+    }                                                                                     \
+                                                                                          \
+    static void mem_verify_walk##W(mem_test_t* t, unsigned int shift, T inv)              \
+    {                                                                                     \
+        uintptr_t a   = t->base;                                                          \
+        uintptr_t end = t->base + t->len;                                                 \
+        T         p   = (T)((T)1 << shift);                                               \
+        for (; end - a >= 4 * sizeof(T); a += 4 * sizeof(T))                              \
+        {                                                                                 \
+            T p1 = MEM_ROTL(T, p);                                                        \
+            T p2 = MEM_ROTL(T, p1);                                                       \
+            T p3 = MEM_ROTL(T, p2);                                                       \
+            T x0 = RD(a);                                                                 \
+            T x1 = RD(a + sizeof(T));                                                     \
+            T x2 = RD(a + 2 * sizeof(T));                                                 \
+            T x3 = RD(a + 3 * sizeof(T));                                                 \
+            if (((x0 ^ p ^ inv) | (x1 ^ p1 ^ inv) | (x2 ^ p2 ^ inv) | (x3 ^ p3 ^ inv)) != 0) \
+            {                                                                             \
+                MEM_TEST_CHECK(t, a, (T)(p ^ inv), x0);                                   \
+                MEM_TEST_CHECK(t, a + sizeof(T), (T)(p1 ^ inv), x1);                      \
+                MEM_TEST_CHECK(t, a + 2 * sizeof(T), (T)(p2 ^ inv), x2);                  \
+                MEM_TEST_CHECK(t, a + 3 * sizeof(T), (T)(p3 ^ inv), x3);                  \
+            }                                                                             \
+            p = MEM_ROTL(T, p3);                                                          \
+        }                                                                                 \
+        for (; a < end; a += sizeof(T))                                                   \
+        {                                                                                 \
+            T x = RD(a);                                                                  \
+            MEM_TEST_CHECK(t, a, (T)(p ^ inv), x);                                        \
+            p = MEM_ROTL(T, p);                                                           \
+        }                                                                                 \
+    }                                                                                     \
+                                                                                          \
+    static void mem_fill_addr##W(mem_test_t* t, T inv)                                    \
+    {                                                                                     \
+        uintptr_t a   = t->base;                                                          \
+        uintptr_t end = t->base + t->len;                                                 \
+        for (; end - a >= 4 * sizeof(T); a += 4 * sizeof(T))                              \
+        {                                                                                 \
+            WR(a, ADDR(a) ^ inv);                                                         \
+            WR(a + sizeof(T), ADDR(a + sizeof(T)) ^ inv);                                 \
+            WR(a + 2 * sizeof(T), ADDR(a + 2 * sizeof(T)) ^ inv);                         \
+            WR(a + 3 * sizeof(T), ADDR(a + 3 * sizeof(T)) ^ inv);                         \
+        }                                                                                 \
+        for (; a < end; a += sizeof(T))                                                   \
+            WR(a, ADDR(a) ^ inv);                                                         \
+    }                                                                                     \
+                                                                                          \
+    static void mem_verify_addr##W(mem_test_t* t, T inv)                                  \
+    {                                                                                     \
+        uintptr_t a   = t->base;                                                          \
+        uintptr_t end = t->base + t->len;                                                 \
+        for (; a < end; a += sizeof(T))                                                   \
+        {                                                                                 \
+            T x = RD(a);                                                                  \
+            MEM_TEST_CHECK(t, a, (T)(ADDR(a) ^ inv), x);                                  \
+        }                                                                                 \
+    }                                                                                     \
+                                                                                          \
+    /* One pass of the running algorithm, returns bytes accessed */                       \
+    static uint32_t mem_pass##W(mem_test_t* t)                                            \
+    {                                                                                     \
+        const T ones = (T)~(T)0;                                                          \
+        const T chk  = (T)0x5555555555555555ULL;                                          \
+        T       inv;                                                                      \
+                                                                                          \
+        switch (t->cur)                                                                   \
+        {                                                                                 \
+        case MEM_TEST_MARCH:                                                              \
+            /* {(w0); up(r0,w1); up(r1,w0); down(r0,w1); down(r1,w0); (r0)} */            \
+            switch (t->pass)                                                              \
+            {                                                                             \
+            case 0:                                                                       \
+                mem_fill##W(t, 0, 0);                                                     \
+                return t->len;                                                            \
+            case 1:                                                                       \
+                mem_up##W(t, 0, ones);                                                    \
+                return 2U * t->len;                                                       \
+            case 2:                                                                       \
+                mem_up##W(t, ones, 0);                                                    \
+                return 2U * t->len;                                                       \
+            case 3:                                                                       \
+                mem_down##W(t, 0, ones);                                                  \
+                return 2U * t->len;                                                       \
+            case 4:                                                                       \
+                mem_down##W(t, ones, 0);                                                  \
+                return 2U * t->len;                                                       \
+            default:                                                                      \
+                mem_verify##W(t, 0, 0);                                                   \
+                return t->len;                                                            \
+            }                                                                             \
+        case MEM_TEST_WALK1:                                                              \
+        case MEM_TEST_WALK0:                                                              \
+            inv = t->cur == MEM_TEST_WALK0 ? ones : 0;                                    \
+            mem_fill_walk##W(t, t->pass, inv);                                            \
+            mem_test_sync(t);                                                             \
+            mem_verify_walk##W(t, t->pass, inv);                                          \
+            return 2U * t->len;                                                           \
+        case MEM_TEST_ADDR:                                                               \
+            inv = t->pass ? ones : 0;                                                     \
+            mem_fill_addr##W(t, inv);                                                     \
+            mem_test_sync(t);                                                             \
+            mem_verify_addr##W(t, inv);                                                   \
+            return 2U * t->len;                                                           \
+        default:                                                                          \
+            inv = t->pass ? ones : 0;                                                     \
+            mem_fill##W(t, chk ^ inv, (T)~chk ^ inv);                                     \
+            mem_test_sync(t);                                                             \
+            mem_verify##W(t, chk ^ inv, (T)~chk ^ inv);                                   \
+            return 2U * t->len;                                                           \
+        }                                                                                 \
+    }
+
+MEM_TEST_KERNELS(32, uint32_t, MEM_RD32, MEM_WR32, MEM_ADDR32)
+MEM_TEST_KERNELS(64, uint64_t, MEM_RD64, MEM_WR64, MEM_ADDR64)
+
+static uint32_t mem_alg_passes(const mem_test_t* t, int alg)
+{
+    switch (alg)
+    {
+    case MEM_TEST_MARCH:
+        return 6;
+    case MEM_TEST_WALK1:
+    case MEM_TEST_WALK0:
+        return t->width * 8U;
+    default:
+        return 2;
+    }
+}
+
+int mem_test_init(mem_test_t* t, uintptr_t base, uint32_t len, int alg, int width)
+{
+    if ((width != 4 && width != 8) || alg < 0 || alg > MEM_TEST_ALL)
+    {
+        return -EINVAL;
+    }
+    if (len == 0 || (base | len) & (uint32_t)(width - 1))
+    {
+        return -EINVAL;
+    }
+
+    memset(t, 0, sizeof(*t));
+    t->base  = base;
+    t->len   = len;
+    t->width = (uint8_t)width;
+    t->alg   = (uint8_t)alg;
+    t->cur   = (uint8_t)(alg == MEM_TEST_ALL ? 0 : alg);
+    return 0;
+}
+
+uint32_t mem_test_passes(const mem_test_t* t)
+{
+    if (t->alg != MEM_TEST_ALL)
+    {
+        return mem_alg_passes(t, t->alg);
+    }
+
+    uint32_t n = 0;
+    for (int alg = 0; alg < MEM_TEST_ALGS; alg++)
+    {
+        n += mem_alg_passes(t, alg);
+    }
+    return n;
+}
+
+int mem_test_step(mem_test_t* t)
+{
+    if (t->cur >= MEM_TEST_ALGS)
+    {
+        return 0;
+    }
+
+    mem_test_stat_t* s     = &t->stat[t->cur];
+    uint32_t         start = MEM_TEST_CLOCK();
+
+    s->bytes += t->width == 8 ? mem_pass64(t) : mem_pass32(t);
+    mem_test_sync(t);
+    s->cycles += (uint32_t)(MEM_TEST_CLOCK() - start);
+    s->passes++;
+    t->done++;
+
+    if (++t->pass == mem_alg_passes(t, t->cur))
+    {
+        t->pass = 0;
+        t->cur  = (uint8_t)(t->alg == MEM_TEST_ALL ? t->cur + 1U : MEM_TEST_ALGS);
+    }
+    return t->cur < MEM_TEST_ALGS;
+}
+
+uint32_t mem_test_run(mem_test_t* t)
+{
+    while (mem_test_step(t))
+    {
+    }
+    return t->errors;
+}
+
+void mem_test_report(FILE* out, const mem_test_t* t)
+{
+    const int digits = t->width * 2;
+
+    fprintf(out, "0x%08lx %lu bytes, %u bit access" ENDL, (unsigned long)t->base, (unsigned long)t->len,
+            t->width * 8U);
+    fprintf(out, "alg       passes      bytes       ms     MB/s  errors" ENDL);
+    for (int alg = 0; alg < MEM_TEST_ALGS; alg++)
+    {
+        const mem_test_stat_t* s = &t->stat[alg];
+
+        if (s->bytes == 0)
+        {
+            continue;
+        }
+        // integer math, ms * 100 and MB/s * 10
+        uint64_t ms100  = s->cycles * 100000U / MEM_TEST_HZ;
+        uint64_t mbps10 = s->cycles ? s->bytes * 10U * MEM_TEST_HZ / s->cycles / 1000000U : 0;
+        fprintf(out, "%-8s %7lu %10lu %5lu.%02lu %6lu.%lu %7lu" ENDL, mem_test_alg_names[alg],
+                (unsigned long)s->passes,
+                (unsigned long)s->bytes, (unsigned long)(ms100 / 100U), (unsigned long)(ms100 % 100U),
+                (unsigned long)(mbps10 / 10U), (unsigned long)(mbps10 % 10U), (unsigned long)s->errors);
+    }
+
+    if (t->errors == 0)
+    {
+        fprintf(out, "Memory test PASSED: %lu bytes" ENDL, (unsigned long)t->len);
+        return;
+    }
+
+    // One cell per 1/MEM_TEST_MAP of the range, X if it had a fault
+    char map[MEM_TEST_MAP + 1];
+    for (int i = 0; i < MEM_TEST_MAP; i++)
+    {
+        map[i] = (t->map >> i) & 1U ? 'X' : '.';
+    }
+    map[MEM_TEST_MAP] = '\0';
+    fprintf(out, "fault map, %lu bytes per cell" ENDL "  %s" ENDL,
+            (unsigned long)((t->len + MEM_TEST_MAP - 1U) / MEM_TEST_MAP), map);
+    fprintf(out, "bad bits 0x%0*llx" ENDL, digits, (unsigned long long)t->bad_bits);
+
+    uint32_t n = t->errors < MEM_TEST_LOG ? t->errors : MEM_TEST_LOG;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        const mem_fault_t* f = &t->log[i];
+        fprintf(out, "  0x%08lx wrote 0x%0*llx read 0x%0*llx" ENDL, (unsigned long)f->addr, digits,
+                (unsigned long long)f->expect, digits, (unsigned long long)f->got);
+    }
+    fprintf(out, "Memory test FAILED! Errors: %lu" ENDL, (unsigned long)t->errors);
+}
+
+#undef ENDL
@@ -0,0 +1,104 @@
+/**
+ * @file mem_test.h
+ * @brief RAM test engine: March C-, walking bits, address in address,
+ *        checkerboard with 32 or 64 bit accesses
+ * @author Mikhael Kaa (Михаил Каа)
+ * @date 17.10.2026
+ */
+
+#ifndef _MEM_TEST_
+#define _MEM_TEST_
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * The test overwrites the range. It runs one pass per mem_test_step(),
+ * a pass is one sweep (March element) or a fill and a verify sweep, so
+ * a caller can yield in between. Words are accessed through MEM_RD32/
+ * MEM_WR32/MEM_RD64/MEM_WR64, the host build (MEM_TEST_HOST) replaces
+ * them with the RAM model of test/test_mem_test.c that injects faults.
+ */
+
+typedef enum mem_test_alg
+{
+    MEM_TEST_MARCH = 0, // March C-, stuck-at, transition and coupling faults
+    MEM_TEST_WALK1,     // a one walking through each word, data lines
+    MEM_TEST_WALK0,     // a zero walking through each word
+    MEM_TEST_ADDR,      // each word holds its address, then the inverse
+    MEM_TEST_CHECKER,   // 0x55/0xaa alternating words, then inverted
+    MEM_TEST_ALGS,
+    MEM_TEST_ALL = MEM_TEST_ALGS // every algorithm in turn
+} mem_test_alg_t;
+
+// Names for the command line, MEM_TEST_ALL is "all", NULL terminated
+extern const char* const mem_test_alg_names[];
+
+// Faults kept with their data
+#define MEM_TEST_LOG 8
+
+// Fault map cells over the range
+#define MEM_TEST_MAP 64
+
+typedef struct mem_fault
+{
+    uintptr_t addr;
+    uint64_t  expect;
+    uint64_t  got;
+} mem_fault_t;
+
+typedef struct mem_test_stat
+{
+    uint64_t bytes;  // read and written
+    uint64_t cycles; // of the MEM_TEST_HZ clock
+    uint32_t passes;
+    uint32_t errors;
+} mem_test_stat_t;
+
+/**
+ * struct mem_test - One test run
+ * @base, @len: Range, aligned to @width
+ * @width: Access size in bytes, 4 or 8
+ * @alg: What to run, mem_test_alg_t
+ * @cur: Algorithm running, MEM_TEST_ALGS when done
+ * @pass: Pass inside @cur
+ * @done: Passes run
+ * @errors: Words that read back wrong, all algorithms
+ * @bad_bits: OR of expect ^ got, the failing data lines
+ * @map: Bit i set if cell i (@len / MEM_TEST_MAP bytes) had a fault
+ * @log: First MEM_TEST_LOG faults
+ * @stat: Per algorithm
+ */
+typedef struct mem_test
+{
+    uintptr_t       base;
+    uint32_t        len;
+    uint8_t         width;
+    uint8_t         alg;
+    uint8_t         cur;
+    uint16_t        pass;
+    uint32_t        done;
+    uint32_t        errors;
+    uint64_t        bad_bits;
+    uint64_t        map;
+    mem_fault_t     log[MEM_TEST_LOG];
+    mem_test_stat_t stat[MEM_TEST_ALGS];
+} mem_test_t;
+
+// 0, or -EINVAL if @width is not 4 or 8, @base or @len are not aligned to
+// it, or @len is 0
+int mem_test_init(mem_test_t* t, uintptr_t base, uint32_t len, int alg, int width);
+
+// Passes mem_test_step() will run
+uint32_t mem_test_passes(const mem_test_t* t);
+
+// Run the next pass, returns 1 while there are more
+int mem_test_step(mem_test_t* t);
+
+// Run to the end, returns the error count
+uint32_t mem_test_run(mem_test_t* t);
+
+// Per algorithm speed and errors, the fault map and the first faults
+void mem_test_report(FILE* out, const mem_test_t* t);
+
+#endif /* _MEM_TEST_ */
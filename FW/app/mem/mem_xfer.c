@@ -0,0 +1,334 @@
+/**
+ * @file mem_xfer.c
+ * @brief Block fill, copy and compare engines
+ * @author Mikhael Kaa (Михаил Каа)
+ * @date 17.10.2026
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include "mem_xfer.h"
+
+#ifdef BAREMETAL
+#include "stm32h743xx.h"
+#define ENDL "\r\n"
+#else
+#include <time.h>
+#define ENDL "\n"
+#endif // BAREMETAL
+
+const char* const mem_xfer_op_names[]     = {"fill", "cpy", "cmp", NULL};
+const char* const mem_xfer_engine_names[] = {"auto", "cpu", "mdma", NULL};
+
+// Time base of the CPU runs, the MDMA driver counts CPU clocks too
+#ifdef BAREMETAL
+#define MEM_XFER_CLOCK() (DWT->CYCCNT)
+#define MEM_XFER_HZ      SystemCoreClock
+#else
+static uint32_t mem_xfer_clock(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec);
+}
+#define MEM_XFER_CLOCK() mem_xfer_clock()
+#define MEM_XFER_HZ      1000000000U
+#endif // BAREMETAL
+
+/*
+ * CPU engines. newlib-nano's memcpy/memset go byte by byte, these use
+ * 64 bit accesses, four per iteration, once both sides are aligned.
+ * A byte loop covers the ends and blocks of different alignment
+ */
+static void mem_cpu_copy(uintptr_t d, uintptr_t s, uint32_t len)
+{
+    uintptr_t end = d + len;
+
+    if (((d ^ s) & 7U) == 0)
+    {
+        for (; (d & 7U) && d < end; d++, s++)
+        {
+            *(uint8_t*)d = *(const uint8_t*)s;
+        }
+        for (; end - d >= 32U; d += 32U, s += 32U)
+        {
+            uint64_t v0 = ((const uint64_t*)s)[0];
+            uint64_t v1 = ((const uint64_t*)s)[1];
+            uint64_t v2 = ((const uint64_t*)s)[2];
+            uint64_t v3 = ((const uint64_t*)s)[3];
+            ((uint64_t*)d)[0] = v0;
+            ((uint64_t*)d)[1] = v1;
+            ((uint64_t*)d)[2] = v2;
+            ((uint64_t*)d)[3] = v3;
+        }
+        for (; end - d >= 8U; d += 8U, s += 8U)
+        {
+            *(uint64_t*)d = *(const uint64_t*)s;
+        }
+    }
+    else if (((d ^ s) & 3U) == 0)
+    {
+        for (; (d & 3U) && d < end; d++, s++)
+        {
+            *(uint8_t*)d = *(const uint8_t*)s;
+        }
+        for (; end - d >= 4U; d += 4U, s += 4U)
+        {
+            *(uint32_t*)d = *(const uint32_t*)s;
+        }
+    }
+    for (; d < end; d++, s++)
+    {
+        *(uint8_t*)d = *(const uint8_t*)s;
+    }
+}
+
+// A repeated byte pattern has no phase, a word pattern starts word aligned
+static void mem_cpu_fill(uintptr_t d, uint32_t len, uint32_t p)
+{
+    uintptr_t end = d + len;
+    uint64_t  v   = ((uint64_t)p << 32) | p;
+
+    for (; (d & 3U) && d < end; d++)
+    {
+        *(uint8_t*)d = (uint8_t)p;
+    }
+    if ((d & 4U) && end - d >= 4U)
+    {
+        *(uint32_t*)d = p;
+        d += 4U;
+    }
+    for (; end - d >= 32U; d += 32U)
+    {
+        ((uint64_t*)d)[0] = v;
+        ((uint64_t*)d)[1] = v;
+        ((uint64_t*)d)[2] = v;
+        ((uint64_t*)d)[3] = v;
+    }
+    for (; end - d >= 8U; d += 8U)
+    {
+        *(uint64_t*)d = v;
+    }
+    if (end - d >= 4U)
+    {
+        *(uint32_t*)d = p;
+        d += 4U;
+    }
+    for (; d < end; d++)
+    {
+        *(uint8_t*)d = (uint8_t)p;
+    }
+}
+
+// Offset of the first differing byte, @len if the blocks are equal. The
+// wide loop stops at the word that differs, the byte loop finds the byte
+static uint32_t mem_cpu_cmp(uintptr_t a, uintptr_t b, uint32_t len)
+{
+    uint32_t i = 0;
+
+    if (((a ^ b) & 7U) == 0)
+    {
+        for (; ((a + i) & 7U) && i < len; i++)
+        {
+            if (*(const uint8_t*)(a + i) != *(const uint8_t*)(b + i))
+            {
+                return i;
+            }
+        }
+        for (; len - i >= 32U; i += 32U)
+        {
+            const uint64_t* x = (const uint64_t*)(a + i);
+            const uint64_t* y = (const uint64_t*)(b + i);
+            if (((x[0] ^ y[0]) | (x[1] ^ y[1]) | (x[2] ^ y[2]) | (x[3] ^ y[3])) != 0)
+            {
+                break;
+            }
+        }
+        for (; len - i >= 8U; i += 8U)
+        {
+            if (*(const uint64_t*)(a + i) != *(const uint64_t*)(b + i))
+            {
+                break;
+            }
+        }
+    }
+    for (; i < len; i++)
+    {
+        if (*(const uint8_t*)(a + i) != *(const uint8_t*)(b + i))
+        {
+            return i;
+        }
+    }
+    return len;
+}
+
+static int mem_xfer_bytewise(uint32_t p)
+{
+    return p == (p & 0xffU) * 0x01010101U;
+}
+
+#ifdef BAREMETAL
+// MDMA interrupt
+static void mem_xfer_mdma_done(mdma_req_t* req)
+{
+    mem_xfer_t* x = (mem_xfer_t*)req->ctx;
+
+    x->cycles = req->cycles;
+    x->status = req->status;
+    if (x->done)
+    {
+        x->done(x);
+    }
+}
+
+static int mem_xfer_mdma(mem_xfer_t* x)
+{
+    interface_t* mdma = dev_mdma_get();
+    int          ret  = mdma->open();
+
+    if (ret < 0)
+    {
+        return ret;
+    }
+    x->req = (mdma_req_t){
+        .dst     = (void*)x->dst,
+        .src     = (const void*)x->src,
+        .pattern = x->pattern,
+        .len     = x->len,
+        .done    = mem_xfer_mdma_done,
+        .ctx     = x,
+    };
+    // Before the start, the interrupt may come before ioctrl returns
+    x->engine = MEM_XFER_MDMA;
+    x->status = -EINPROGRESS;
+    ret       = mdma->ioctrl(x->op == MEM_XFER_FILL ? MDMA_FILL : MDMA_COPY, &x->req);
+    if (ret < 0)
+    {
+        x->status = ret;
+    }
+    return ret;
+}
+#endif // BAREMETAL
+
+int mem_xfer_start(mem_xfer_t* x, int engine)
+{
+    // MDMA only copies forward
+    int overlap = x->op == MEM_XFER_COPY && x->dst > x->src && x->dst - x->src < x->len;
+
+    if (x->op == MEM_XFER_FILL && !mem_xfer_bytewise(x->pattern) && ((x->dst | x->len) & 3U))
+    {
+        return -EINVAL;
+    }
+    if (engine == MEM_XFER_MDMA && (x->op == MEM_XFER_CMP || overlap))
+    {
+        return x->op == MEM_XFER_CMP ? -ENOTSUP : -EINVAL;
+    }
+    x->diff = x->len;
+
+#ifdef BAREMETAL
+    if (x->op != MEM_XFER_CMP && !overlap &&
+        (engine == MEM_XFER_MDMA || (engine == MEM_XFER_AUTO && x->len >= MEM_XFER_DMA_MIN)))
+    {
+        int ret = mem_xfer_mdma(x);
+        if (ret == 0 || engine == MEM_XFER_MDMA)
+        {
+            return ret;
+        }
+        // MDMA busy with someone else's run, the CPU does this one
+    }
+#else
+    if (engine == MEM_XFER_MDMA)
+    {
+        return -ENODEV;
+    }
+#endif // BAREMETAL
+
+    x->engine      = MEM_XFER_CPU;
+    uint32_t start = MEM_XFER_CLOCK();
+    switch (x->op)
+    {
+    case MEM_XFER_FILL:
+        mem_cpu_fill(x->dst, x->len, x->pattern);
+        break;
+    case MEM_XFER_COPY:
+        if (overlap)
+        {
+            memmove((void*)x->dst, (const void*)x->src, x->len);
+        }
+        else
+        {
+            mem_cpu_copy(x->dst, x->src, x->len);
+        }
+        break;
+    default:
+        x->diff = mem_cpu_cmp(x->dst, x->src, x->len);
+        break;
+    }
+    x->cycles = MEM_XFER_CLOCK() - start;
+    x->status = 0;
+    if (x->done)
+    {
+        x->done(x);
+    }
+    return 0;
+}
+
+void mem_xfer_abort(mem_xfer_t* x)
+{
+#ifdef BAREMETAL
+    if (x->engine == MEM_XFER_MDMA && x->status == -EINPROGRESS)
+    {
+        dev_mdma_get()->ioctrl(MDMA_ABORT, NULL);
+    }
+#else
+    (void)x;
+#endif // BAREMETAL
+}
+
+void mem_xfer_report(FILE* out, const mem_xfer_t* x)
+{
+    const char* engine = mem_xfer_engine_names[x->engine];
+
+    if (x->status < 0)
+    {
+        fprintf(out, "%s on %s failed: %d" ENDL, mem_xfer_op_names[x->op], engine, x->status);
+        return;
+    }
+
+    // integer math, us * 10 and MB/s * 10
+    uint64_t us10   = (uint64_t)x->cycles * 10000000U / MEM_XFER_HZ;
+    uint64_t mbps10 = x->cycles ? (uint64_t)x->len * 10U * MEM_XFER_HZ / x->cycles / 1000000U : 0;
+
+    switch (x->op)
+    {
+    case MEM_XFER_FILL:
+        fprintf(out, "fill 0x%08lx with 0x%08lx", (unsigned long)x->dst, (unsigned long)x->pattern);
+        break;
+    case MEM_XFER_COPY:
+        fprintf(out, "copy 0x%08lx <- 0x%08lx", (unsigned long)x->dst, (unsigned long)x->src);
+        break;
+    default:
+        fprintf(out, "cmp 0x%08lx 0x%08lx", (unsigned long)x->dst, (unsigned long)x->src);
+        break;
+    }
+    fprintf(out, ", %lu bytes, %s, %lu.%lu us, %lu.%lu MB/s" ENDL, (unsigned long)x->len, engine,
+            (unsigned long)(us10 / 10U), (unsigned long)(us10 % 10U), (unsigned long)(mbps10 / 10U),
+            (unsigned long)(mbps10 % 10U));
+
+    if (x->op == MEM_XFER_CMP && x->diff < x->len)
+    {
+        fprintf(out, "differ at +0x%lx: 0x%08lx = 0x%02x, 0x%08lx = 0x%02x" ENDL, (unsigned long)x->diff,
+                (unsigned long)(x->dst + x->diff), *(const uint8_t*)(x->dst + x->diff),
+                (unsigned long)(x->src + x->diff), *(const uint8_t*)(x->src + x->diff));
+    }
+    else if (x->op == MEM_XFER_CMP)
+    {
+        fprintf(out, "equal" ENDL);
+    }
+}
+
+#undef ENDL
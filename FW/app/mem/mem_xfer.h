@@ -0,0 +1,91 @@
+/**
+ * @file mem_xfer.h
+ * @brief Block fill, copy and compare on the CPU or the MDMA, with the
+ *        bandwidth each run achieved
+ * @author Mikhael Kaa (Михаил Каа)
+ * @date 17.10.2026
+ */
+
+#ifndef _MEM_XFER_
+#define _MEM_XFER_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef BAREMETAL
+#include "dev_mdma.h"
+#endif
+
+/*
+ * A CPU run is done when mem_xfer_start() returns. An MDMA run goes on
+ * in the background: status stays -EINPROGRESS and @done is called from
+ * the MDMA interrupt at the end. Compare is CPU only, DMA can't compare.
+ * The host build has the CPU engine only.
+ */
+
+typedef enum mem_xfer_op
+{
+    MEM_XFER_FILL = 0,
+    MEM_XFER_COPY,
+    MEM_XFER_CMP,
+} mem_xfer_op_t;
+
+typedef enum mem_xfer_engine
+{
+    MEM_XFER_AUTO = 0, // MDMA from MEM_XFER_DMA_MIN bytes on, if it's free
+    MEM_XFER_CPU,
+    MEM_XFER_MDMA,
+} mem_xfer_engine_t;
+
+// Names for the command line, NULL terminated
+extern const char* const mem_xfer_op_names[];
+extern const char* const mem_xfer_engine_names[];
+
+// Shorter blocks aren't worth the DMA setup and cache maintenance
+#define MEM_XFER_DMA_MIN 1024U
+
+/**
+ * struct mem_xfer - One fill, copy or compare
+ * @dst: Filled, copied to, or the first block compared
+ * @src: Copied from, or the second block compared
+ * @len: Bytes
+ * @pattern: Fill word, repeated from @dst on. Unless it is a repeated
+ *           byte (0x5a5a5a5a) @dst and @len must be 4 byte aligned
+ * @op: mem_xfer_op_t
+ * @engine: mem_xfer_engine_t that ran it
+ * @status: -EINPROGRESS while the MDMA runs, then 0 or negative errno
+ * @cycles: Of the MEM_XFER_HZ clock, start to completion
+ * @diff: Compare, offset of the first differing byte, @len if none
+ * @done: Completion callback, NULL for none. From the MDMA interrupt
+ * @ctx: For the caller
+ */
+typedef struct mem_xfer
+{
+    uintptr_t    dst;
+    uintptr_t    src;
+    uint32_t     len;
+    uint32_t     pattern;
+    uint8_t      op;
+    uint8_t      engine;
+    volatile int status;
+    uint32_t     cycles;
+    uint32_t     diff;
+    void (*done)(struct mem_xfer* x);
+    void* ctx;
+#ifdef BAREMETAL
+    mdma_req_t req;
+#endif
+} mem_xfer_t;
+
+// Run @x (fields @dst to @op set) on @engine. Returns 0 when it is done
+// or running, -EBUSY if MEM_XFER_MDMA was asked for and the MDMA is
+// busy, -EINVAL on a bad pattern alignment
+int mem_xfer_start(mem_xfer_t* x, int engine);
+
+// Stop an MDMA run, status becomes -ECANCELED
+void mem_xfer_abort(mem_xfer_t* x);
+
+// Result line: operation, engine, bytes, time and MB/s
+void mem_xfer_report(FILE* out, const mem_xfer_t* x);
+
+#endif /* _MEM_XFER_ */
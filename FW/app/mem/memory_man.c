@@ -10,214 +10,736 @@
 #include <string.h>
 #include <errno.h>
 
-static void     print_usage(void);
-static void     mem_dump(uint8_t* buf, uint32_t len);
-static uint32_t mem_test(uint8_t* buf, uint32_t len);
+#include "ucmd.h"
+#include "memory_man.h"
+#include "mem_test.h"
+#include "mem_xfer.h"
+#include "hexdump.h"
+#include "dev_crc.h"
+#ifdef BAREMETAL
+#include "stm32h743xx.h"
+#include "job.h"
+#include "mem_link.h"
+#include "systime.h"
+#endif
+
+// Work per job slice, shorter requests run at once
+#define MEM_TEST_SLICE 4096U
+#define MEM_DUMP_SLICE 1024U
+
+// MDMA runs up to this long are waited for, about 100 us
+#define MEM_XFER_SPIN  (64U * 1024U)
+
+#ifdef BAREMETAL
+static int  mem_test_job(job_t* job);
+static int  mem_dump_job(job_t* job);
+static int  mem_xfer_job(job_t* job);
+static void mem_xfer_cancel(job_t* job);
+static int  mem_link_job(job_t* job);
+static int  mem_crc_job(job_t* job);
+static void mem_crc_cancel(job_t* job);
+static int  mem_start_job(ucmd_session_t* s, const char* name, job_fn_t fn, const void* state, size_t size,
+                          uint32_t len);
+#endif
 
+#undef ENDL // microrl config.h has its own
 #ifdef BAREMETAL
-int ucmd_mem(int argc, char* argv[])
 #define ENDL "\r\n"
 #else
-int main(int argc, char* argv[])
+#include <time.h>
 #define ENDL "\n"
 #endif // BAREMETAL
-{
-    uint32_t addr, data, len;
-    uint8_t* ptr;
-
-    switch (argc)
-    {
-        case 1:
-        case 2:
-            print_usage();
-            return -EINVAL;
-
-        case 3:
-            if (strcmp(argv[1], "read") == 0)
-            {
-                if (sscanf(argv[2], "%lx", &addr) != 1)
-                {
-                    printf("Invalid address format" ENDL);
-                    return -EINVAL;
-                }
-                ptr = (uint8_t*)addr;
-                printf("0x%02x" ENDL, *ptr);
-                return 0;
-            }
-            break;
 
-        case 4:
-            if (strcmp(argv[1], "test") == 0)
-            {
-                if (sscanf(argv[2], "%lx", &addr) != 1 || sscanf(argv[3], "%lx", &len) != 1)
-                {
-                    printf("Invalid arguments format" ENDL);
-                    return -EINVAL;
-                }
-                return (int)mem_test((uint8_t*)addr, len);
-            }
-
-            if (strcmp(argv[1], "dump") == 0)
-            {
-                if (sscanf(argv[2], "%lx", &addr) != 1 || sscanf(argv[3], "%lx", &len) != 1)
-                {
-                    printf("Invalid arguments format" ENDL);
-                    return -EINVAL;
-                }
-                mem_dump((uint8_t*)addr, len);
-                return 0;
-            }
-
-            if (strcmp(argv[1], "write") == 0)
-            {
-                if (sscanf(argv[2], "%lx", &addr) != 1 || sscanf(argv[3], "%lx", &data) != 1)
-                {
-                    printf("Invalid arguments format" ENDL);
-                    return -EINVAL;
-                }
-                ptr  = (uint8_t*)addr;
-                *ptr = (uint8_t)data;
-                return 0;
-            }
-            break;
+const mem_region_t mem_regions[] = {
+    {"itcm",    0x00000000, 64 * 1024},
+    {"flash",   0x08000000, 2048 * 1024},
+    {"dtcm",    0x20000000, 128 * 1024},
+    {"ram_d1",  0x24000000, 512 * 1024},
+    {"ram_d2",  0x30000000, 288 * 1024},
+    {"ram_d3",  0x38000000, 64 * 1024},
+    {"bkpsram", 0x38800000, 4 * 1024},
+    {NULL, 0, 0},
+};
 
-        case 5:
-            if (strcmp(argv[1], "cpy") == 0)
-            {
-                uint32_t src;
-                if (sscanf(argv[2], "%lx", &addr) != 1 || sscanf(argv[3], "%lx", &src) != 1 || sscanf(argv[4], "%lx", &len) != 1)
-                {
-                    printf("Invalid arguments format" ENDL);
-                    return -EINVAL;
-                }
-                memcpy((void*)addr, (void*)src, len);
-                return 0;
-            }
-            break;
+// Subcommands, argv[0] is the subcommand word, <adr> may be a region name
 
-        default:
-            print_usage();
-            return -EINVAL;
-    }
+static const uarg_spec_t mem_read_args = UARG_SPEC("mem read", UARG_ADDR("<adr>", mem_regions));
 
-    print_usage();
-    return -EINVAL;
+static int mem_cmd_read(ucmd_session_t* s, int argc, char* argv[])
+{
+    uarg_val_t v[1];
+
+    if (uarg_parse(s->out, &mem_read_args, argc, argv, v) < 0)
+    {
+        return -EINVAL;
+    }
+    fprintf(s->out, "0x%02x" ENDL, *(uint8_t*)v[0].u);
+    return 0;
 }
 
-static void print_usage(void)
+static const uarg_spec_t mem_write_args =
+    UARG_SPEC("mem write", UARG_ADDR("<adr>", mem_regions), UARG_HEX("<data>", 0, 0xff));
+
+static int mem_cmd_write(ucmd_session_t* s, int argc, char* argv[])
 {
-    printf("Usage: mem <command> [arguments]" ENDL);
-    printf("Commands:" ENDL);
-    printf("  dump <adr> <len>    - Hexdump of memory region" ENDL);
-    printf("  read <adr>          - Read byte from address" ENDL);
-    printf("  write <adr> <data>  - Write byte to address" ENDL);
-    printf("  test <adr> <len>    - Test memory region" ENDL);
-    printf("  cpy <dst> <src> <len> - Copy memory block" ENDL);
+    uarg_val_t v[2];
+
+    if (uarg_parse(s->out, &mem_write_args, argc, argv, v) < 0)
+    {
+        return -EINVAL;
+    }
+    *(uint8_t*)v[0].u = (uint8_t)v[1].u;
+    return 0;
 }
 
-static void mem_dump(uint8_t* buf, uint32_t len)
+static const char* const mem_test_widths[] = {"32", "64", NULL};
+
+static const uarg_spec_t mem_test_args =
+    UARG_SPEC("mem test", UARG_RANGE("<adr> <len>", mem_regions, 0, 0),
+              UARG_OPT_ENUM("[alg]", mem_test_alg_names, MEM_TEST_ALL), UARG_OPT_ENUM("[32|64]", mem_test_widths, 0));
+
+// One test at a time, the job keeps a pointer to it
+static mem_test_t mem_test_run_state;
+
+#ifdef BAREMETAL
+// Linker script, end of the buffers the firmware keeps in each RAM
+extern uint8_t __itcm_free[];
+extern uint8_t __ram_d1_free[];
+extern uint8_t __ram_d2_free[];
+extern uint8_t __ram_d3_free[];
+
+// RAM the test may overwrite: [free, end) of each region. DTCM holds
+// data, bss, heap and stack, flash is not RAM
+static const struct
 {
-    uint32_t       i              = 0;
-    uint32_t       current_addr   = (uint32_t)buf;
-    const uint32_t bytes_per_line = 16;
+    uintptr_t      base;
+    const uint8_t* free;
+    uintptr_t      end;
+} mem_test_ram[] = {
+    {0x00000000, __itcm_free, 0x00010000},
+    {0x24000000, __ram_d1_free, 0x24080000},
+    {0x30000000, __ram_d2_free, 0x30048000},
+    {0x38000000, __ram_d3_free, 0x38010000},
+    {0x38800000, (const uint8_t*)0x38800000, 0x38801000},
+};
 
-    while (i < len)
+static int mem_test_check(FILE* out, uint32_t addr, uint32_t len)
+{
+    for (size_t i = 0; i < sizeof(mem_test_ram) / sizeof(mem_test_ram[0]); i++)
     {
-        /* Print address at start of each line */
-        printf("0x%08lx: ", (unsigned long)current_addr);
+        uintptr_t free = (uintptr_t)mem_test_ram[i].free;
 
-        /* Print hex values */
-        uint32_t bytes_printed = 0;
-        for (uint32_t j = 0; j < bytes_per_line; j++)
+        if (addr < mem_test_ram[i].base || addr - mem_test_ram[i].base >= mem_test_ram[i].end - mem_test_ram[i].base)
         {
-            if (i + j < len)
-            {
-                printf("%02x ", buf[i + j]);
-                bytes_printed++;
-            }
-            else
-            {
-                printf("   "); /* Padding for incomplete lines */
-            }
+            continue;
         }
-
-        /* Print ASCII representation */
-        printf("| ");
-        for (uint32_t j = 0; j < bytes_printed; j++)
+        if (len > mem_test_ram[i].end - addr)
         {
-            uint8_t c = buf[i + j];
-            putchar((c >= 32 && c <= 126) ? c : '.');
+            break;
         }
-        printf("" ENDL);
-
-        i += bytes_printed;
-        current_addr += bytes_printed;
+        if (addr < free)
+        {
+            fprintf(out, "0x%08lx..0x%08lx is in use, free from 0x%08lx" ENDL, (unsigned long)mem_test_ram[i].base,
+                    (unsigned long)free, (unsigned long)free);
+            return -EBUSY;
+        }
+        return 0;
     }
+    fprintf(out, "mem test: not inside one RAM region, see mem map" ENDL);
+    return -EINVAL;
 }
+#endif // BAREMETAL
 
-static uint32_t mem_test(uint8_t* buf, uint32_t len)
+static int mem_cmd_test(ucmd_session_t* s, int argc, char* argv[])
 {
-    uint32_t          error_count         = 0;
-    volatile uint8_t* b                   = buf;
-    const uint8_t     patterns[]          = {0x00, 0x55, 0xAA, 0xFF};
-    const int         num_patterns        = sizeof(patterns) / sizeof(patterns[0]);
-    const uint32_t    max_errors_to_print = 10;
+    mem_test_t* t = &mem_test_run_state;
+    uarg_val_t  v[4];
+
+    if (uarg_parse(s->out, &mem_test_args, argc, argv, v) < 0)
+    {
+        return -EINVAL;
+    }
+    uint32_t addr  = v[0].u;
+    uint32_t len   = v[1].u;
+    int      width = v[3].u ? 8 : 4;
 
     if (len == 0)
     {
-        printf("Zero-length test skipped" ENDL);
+        fprintf(s->out, "Zero-length test skipped" ENDL);
         return 0;
     }
+#ifdef BAREMETAL
+    if (job_find(mem_test_job) >= 0)
+    {
+        fprintf(s->out, "mem test is already running" ENDL);
+        return -EBUSY;
+    }
+    int ret = mem_test_check(s->out, addr, len);
+    if (ret < 0)
+    {
+        return ret;
+    }
+#endif
+    if (mem_test_init(t, addr, len, (int)v[2].u, width) < 0)
+    {
+        fprintf(s->out, "mem test: <adr> and <len> must be %d byte aligned" ENDL, width);
+        return -EINVAL;
+    }
+#ifdef BAREMETAL
+    if (len > MEM_TEST_SLICE)
+    {
+        return mem_start_job(s, "mem test", mem_test_job, &t, sizeof(t), len);
+    }
+#endif
+    mem_test_run(t);
+    mem_test_report(s->out, t);
+    return t->errors ? -EIO : 0;
+}
 
-    for (uint32_t i = 0; i < len; i++)
+static const char* const mem_dump_groups[] = {"8", "16", "32", NULL};
+
+static const uarg_spec_t mem_dump_args = UARG_SPEC("mem dump", UARG_RANGE("<adr> <len>", mem_regions, 0, 0),
+                                                   UARG_OPT_ENUM("[8|16|32]", mem_dump_groups, 0));
+
+static int mem_cmd_dump(ucmd_session_t* s, int argc, char* argv[])
+{
+    hexdump_t  h;
+    uarg_val_t v[3];
+
+    if (uarg_parse(s->out, &mem_dump_args, argc, argv, v) < 0)
     {
-        uint8_t original = b[i];
+        return -EINVAL;
+    }
+    hexdump_init(&h, (const void*)v[0].u, v[1].u, 1 << v[2].u);
+#ifdef BAREMETAL
+    if (h.len > MEM_DUMP_SLICE)
+    {
+        return mem_start_job(s, "mem dump", mem_dump_job, &h, sizeof(h), h.len);
+    }
+#endif
+    while (hexdump_step(s->out, &h, MEM_DUMP_SLICE))
+    {
+    }
+    return 0;
+}
 
-        /* Test patterns */
-        for (int p = 0; p < num_patterns; p++)
+// One fill, copy or compare at a time, the MDMA and the job keep a
+// pointer to it
+static mem_xfer_t mem_xfer_run_state;
+#ifdef BAREMETAL
+static volatile int mem_xfer_job_id = -1;
+
+// MDMA interrupt, the job waits for it
+static void mem_xfer_wake(mem_xfer_t* x)
+{
+    (void)x;
+    job_resume(mem_xfer_job_id);
+}
+#endif
+
+static int mem_xfer_run(ucmd_session_t* s, mem_xfer_t* x, int engine)
+{
+    const char* name = mem_xfer_op_names[x->op];
+
+    if (x->len == 0)
+    {
+        fprintf(s->out, "Zero-length %s skipped" ENDL, name);
+        return 0;
+    }
+#ifdef BAREMETAL
+    mem_xfer_job_id = -1;
+    x->done         = mem_xfer_wake;
+#endif
+    int ret = mem_xfer_start(x, engine);
+    if (ret == -EINVAL)
+    {
+        fprintf(s->out, "mem %s: word pattern needs 4 byte aligned <adr> and <len>, "
+                        "MDMA can't copy onto an overlapping source" ENDL, name);
+        return ret;
+    }
+    if (ret < 0)
+    {
+        fprintf(s->out, "mem %s on %s: %d" ENDL, name, mem_xfer_engine_names[engine], ret);
+        return ret;
+    }
+#ifdef BAREMETAL
+    if (x->status == -EINPROGRESS && x->len > MEM_XFER_SPIN)
+    {
+        mem_xfer_job_id = job_start(s, name, mem_xfer_job, &x, sizeof(x));
+        if (mem_xfer_job_id >= 0)
         {
-            uint8_t test_val = patterns[p];
-            b[i]             = test_val;
-
-            if (b[i] != test_val)
-            {
-                if (error_count < max_errors_to_print)
-                {
-                    printf("ERROR @ 0x%08lx: Wrote 0x%02X, Read 0x%02X" ENDL, (unsigned long)(b + i), test_val, b[i]);
-                }
-                error_count++;
-            }
+            job_set_abort(mem_xfer_job_id, mem_xfer_cancel);
+            return 0;
         }
+        fprintf(s->out, "Can't start job: %d, waiting" ENDL, mem_xfer_job_id);
+    }
+    while (x->status == -EINPROGRESS)
+    {
+    }
+#endif
+    mem_xfer_report(s->out, x);
+    if (x->status < 0)
+    {
+        return x->status;
+    }
+    return x->diff < x->len ? -EIO : 0;
+}
+
+// The last MDMA run may outlive a cancelled job
+static int mem_xfer_busy(ucmd_session_t* s, const mem_xfer_t* x)
+{
+    if (x->status == -EINPROGRESS)
+    {
+        fprintf(s->out, "mem %s is still running" ENDL, mem_xfer_op_names[x->op]);
+        return -EBUSY;
+    }
+    return 0;
+}
+
+static const uarg_spec_t mem_cpy_args =
+    UARG_SPEC("mem cpy", UARG_ADDR("<dst>", mem_regions), UARG_ADDR("<src>", mem_regions), UARG_HEX("<len>", 0, 0),
+              UARG_OPT_ENUM("[auto|cpu|mdma]", mem_xfer_engine_names, MEM_XFER_AUTO));
+
+static int mem_cmd_cpy(ucmd_session_t* s, int argc, char* argv[])
+{
+    mem_xfer_t* x = &mem_xfer_run_state;
+    uarg_val_t  v[4];
+
+    if (uarg_parse(s->out, &mem_cpy_args, argc, argv, v) < 0)
+    {
+        return -EINVAL;
+    }
+    if (mem_xfer_busy(s, x) < 0)
+    {
+        return -EBUSY;
+    }
+    *x = (mem_xfer_t){.dst = v[0].u, .src = v[1].u, .len = v[2].u, .op = MEM_XFER_COPY};
+    return mem_xfer_run(s, x, (int)v[3].u);
+}
+
+static const uarg_spec_t mem_fill_args =
+    UARG_SPEC("mem fill", UARG_RANGE("<adr> <len>", mem_regions, 0, 0), UARG_HEX("<pattern>", 0, 0),
+              UARG_OPT_ENUM("[auto|cpu|mdma]", mem_xfer_engine_names, MEM_XFER_AUTO));
+
+static int mem_cmd_fill(ucmd_session_t* s, int argc, char* argv[])
+{
+    mem_xfer_t* x = &mem_xfer_run_state;
+    uarg_val_t  v[4];
+
+    if (uarg_parse(s->out, &mem_fill_args, argc, argv, v) < 0)
+    {
+        return -EINVAL;
+    }
+    if (mem_xfer_busy(s, x) < 0)
+    {
+        return -EBUSY;
+    }
+    // Up to ff it is a byte, like memset
+    uint32_t pattern = v[2].u <= 0xffU ? v[2].u * 0x01010101U : v[2].u;
+    *x = (mem_xfer_t){.dst = v[0].u, .len = v[1].u, .pattern = pattern, .op = MEM_XFER_FILL};
+    return mem_xfer_run(s, x, (int)v[3].u);
+}
+
+static const uarg_spec_t mem_cmp_args = UARG_SPEC("mem cmp", UARG_ADDR("<a>", mem_regions),
+                                                  UARG_ADDR("<b>", mem_regions), UARG_HEX("<len>", 0, 0));
+
+static int mem_cmd_cmp(ucmd_session_t* s, int argc, char* argv[])
+{
+    mem_xfer_t* x = &mem_xfer_run_state;
+    uarg_val_t  v[3];
+
+    if (uarg_parse(s->out, &mem_cmp_args, argc, argv, v) < 0)
+    {
+        return -EINVAL;
+    }
+    if (mem_xfer_busy(s, x) < 0)
+    {
+        return -EBUSY;
+    }
+    *x = (mem_xfer_t){.dst = v[0].u, .src = v[1].u, .len = v[2].u, .op = MEM_XFER_CMP};
+    return mem_xfer_run(s, x, MEM_XFER_CPU);
+}
+
+// One mem crc at a time, the MDMA interrupt and the job keep a pointer
+static crc_req_t mem_crc_req;
+static uint8_t   mem_crc_model;
+
+#ifdef BAREMETAL
+#define MEM_CRC_HZ SystemCoreClock
+
+static volatile int mem_crc_job_id = -1;
+
+// Completion, the job waits for it on an MDMA run
+static void mem_crc_wake(crc_req_t* req)
+{
+    (void)req;
+    job_resume(mem_crc_job_id);
+}
+#else
+#define MEM_CRC_HZ 1000000000U
+
+// The host has the tables only, dev_crc.c isn't built
+const char* const crc_engine_names[] = {"auto", "sw", "cpu", "dma", NULL};
+#endif // BAREMETAL
 
-        /* Restore original value */
-        b[i] = original;
-        if (b[i] != original)
+// Model, range, value, engine, time and MB/s
+static void mem_crc_report(FILE* out, const crc_req_t* r)
+{
+    const char* engine = crc_engine_names[r->engine];
+
+    if (r->status < 0)
+    {
+        fprintf(out, "crc on %s failed: %d" ENDL, engine, r->status);
+        return;
+    }
+
+    // integer math, us * 10 and MB/s * 10
+    uint64_t us10   = (uint64_t)r->cycles * 10000000U / MEM_CRC_HZ;
+    uint64_t mbps10 = r->cycles ? (uint64_t)r->len * 10U * MEM_CRC_HZ / r->cycles / 1000000U : 0;
+    int      digits = (crc_models[mem_crc_model].cfg.width + 3) / 4;
+
+    fprintf(out, "%s 0x%08lx, %lu bytes: 0x%0*lx, %s, %lu.%lu us, %lu.%lu MB/s" ENDL, crc_model_names[mem_crc_model],
+            (unsigned long)(uintptr_t)r->buf, (unsigned long)r->len, digits, (unsigned long)r->crc, engine,
+            (unsigned long)(us10 / 10U), (unsigned long)(us10 % 10U), (unsigned long)(mbps10 / 10U),
+            (unsigned long)(mbps10 % 10U));
+}
+
+static const uarg_spec_t mem_crc_args =
+    UARG_SPEC("mem crc", UARG_RANGE("<adr> <len>", mem_regions, 0, 0),
+              UARG_OPT_ENUM("[auto|sw|cpu|dma]", crc_engine_names, CRC_ENGINE_AUTO),
+              UARG_OPT_ENUM("[model]", crc_model_names, 0));
+
+static int mem_cmd_crc(ucmd_session_t* s, int argc, char* argv[])
+{
+    crc_req_t* r = &mem_crc_req;
+    uarg_val_t v[4];
+
+    if (uarg_parse(s->out, &mem_crc_args, argc, argv, v) < 0)
+    {
+        return -EINVAL;
+    }
+    // The last MDMA run may outlive a cancelled job
+    if (r->status == -EINPROGRESS)
+    {
+        fprintf(s->out, "mem crc is still running" ENDL);
+        return -EBUSY;
+    }
+    mem_crc_model = (uint8_t)v[3].u;
+    *r = (crc_req_t){.buf = (const void*)v[0].u, .len = v[1].u, .engine = (uint8_t)v[2].u};
+
+#ifdef BAREMETAL
+    interface_t* crc = dev_crc_get();
+    int          ret = crc->open();
+
+    if (ret == 0)
+    {
+        ret = crc->ioctrl(INTERFACE_SET_CONFIG, (void*)&crc_models[mem_crc_model].cfg);
+    }
+    mem_crc_job_id = -1;
+    r->done        = mem_crc_wake;
+    if (ret == 0)
+    {
+        ret = crc->ioctrl(CRC_CALC, r);
+    }
+    if (ret < 0)
+    {
+        fprintf(s->out, "mem crc on %s: %d" ENDL, crc_engine_names[v[2].u], ret);
+        return ret;
+    }
+    if (r->status == -EINPROGRESS && r->len > MEM_XFER_SPIN)
+    {
+        mem_crc_job_id = job_start(s, "crc", mem_crc_job, &r, sizeof(r));
+        if (mem_crc_job_id >= 0)
         {
-            if (error_count < max_errors_to_print)
-            {
-                printf("RESTORE ERROR @ 0x%08lx! Original: 0x%02X, Current: 0x%02X" ENDL, (unsigned long)(b + i), original, b[i]);
-            }
-            error_count++;
+            job_set_abort(mem_crc_job_id, mem_crc_cancel);
+            return 0;
         }
+        fprintf(s->out, "Can't start job: %d, waiting" ENDL, mem_crc_job_id);
+    }
+    while (r->status == -EINPROGRESS)
+    {
+    }
+#else
+    static crc_sw_t sw;
+    struct timespec t0, t1;
 
-        /* Progress indicator */
-        if ((i % 8192) == 0)
+    if (r->engine != CRC_ENGINE_AUTO && r->engine != CRC_ENGINE_SW)
+    {
+        fprintf(s->out, "mem crc on %s: %d" ENDL, crc_engine_names[r->engine], -ENODEV);
+        return -ENODEV;
+    }
+    crc_sw_init(&sw, &crc_models[mem_crc_model].cfg);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    r->crc = crc_sw_calc(&sw, r->buf, r->len);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    r->cycles = (uint32_t)((t1.tv_sec - t0.tv_sec) * 1000000000L + (t1.tv_nsec - t0.tv_nsec));
+    r->engine = CRC_ENGINE_SW;
+    r->status = 0;
+#endif // BAREMETAL
+    mem_crc_report(s->out, r);
+    return r->status;
+}
+
+#ifdef BAREMETAL
+// One transfer at a time, the session input and the job share it
+static mem_link_t      mem_link_state;
+static uint32_t        mem_link_t0;
+static ucmd_session_t* mem_link_session; // raw until the line is quiet after the transfer
+
+static int mem_link_write(void* ctx, const void* buf, size_t len)
+{
+    const ucmd_session_t* s = ctx;
+
+    return s->io->write(buf, len);
+}
+
+// Give the input back once the host has stopped sending, -EBUSY until
+// the line has been quiet for MEM_LINK_IDLE_MS
+static int mem_link_release(uint32_t now_ms)
+{
+    if (mem_link_session == NULL)
+    {
+        return 0;
+    }
+    if (now_ms - mem_link_state.rx_ms < MEM_LINK_IDLE_MS)
+    {
+        return -EBUSY;
+    }
+    ucmd_session_set_raw(mem_link_session, NULL, NULL);
+    mem_link_session = NULL;
+    return 0;
+}
+
+// Session input while the link runs, nothing reaches the line editor.
+// Killed, the job is gone but frames in flight still come: they are
+// swallowed, a 0x0d in them would run garbage as a command
+static int mem_link_raw(ucmd_session_t* s, const char* buf, int len)
+{
+    mem_link_t* l  = s->raw_ctx;
+    uint32_t    ms = (uint32_t)systime_ms();
+
+    if (job_find(mem_link_job) < 0)
+    {
+        if (mem_link_release(ms) == 0)
         {
-            printf("Tested %lu/%lu bytes (errors: %lu)" ENDL, i, len, error_count);
+            return 0;
         }
+        l->rx_ms = ms;
+        return len;
+    }
+    return (int)mem_link_rx(l, (const uint8_t*)buf, (size_t)len, ms);
+}
+
+// jobs kill: ABORT to the host, the input stays raw until it is quiet,
+// counted from now
+static void mem_link_cancel(job_t* job)
+{
+    mem_link_t* l = *(mem_link_t**)job->data;
+
+    mem_link_fail(l, -ECANCELED);
+    l->rx_ms = (uint32_t)systime_ms();
+}
+
+// Binary from here on, the text before HELLO is flushed first
+static int mem_link_start(ucmd_session_t* s, int argc, char* argv[], const uarg_spec_t* spec, int put)
+{
+    mem_link_t* l = &mem_link_state;
+    uarg_val_t  v[2];
+
+    if (uarg_parse(s->out, spec, argc, argv, v) < 0)
+    {
+        return -EINVAL;
     }
+    if (s->io->write == NULL)
+    {
+        fprintf(s->out, "%s: no binary output on this session" ENDL, spec->cmd);
+        return -ENOTSUP;
+    }
+    if (job_find(mem_link_job) >= 0 || mem_link_release((uint32_t)systime_ms()) < 0)
+    {
+        fprintf(s->out, "%s: a transfer is running" ENDL, spec->cmd);
+        return -EBUSY;
+    }
+    int id = job_start(s, spec->cmd, mem_link_job, &l, sizeof(l));
+    if (id < 0)
+    {
+        fprintf(s->out, "Can't start job: %d" ENDL, id);
+        return id;
+    }
+    job_set_abort(id, mem_link_cancel);
+    fflush(s->out);
+    mem_link_t0      = (uint32_t)systime_ms();
+    mem_link_session = s;
+    ucmd_session_set_raw(s, mem_link_raw, l);
+    mem_link_init(l, v[0].u, v[1].u, put, mem_link_write, s, mem_link_t0);
+    return 0;
+}
+
+static const uarg_spec_t mem_get_args = UARG_SPEC("mem get", UARG_RANGE("<adr> <len>", mem_regions, 0, 0));
+static const uarg_spec_t mem_put_args = UARG_SPEC("mem put", UARG_RANGE("<adr> <len>", mem_regions, 0, 0));
 
-    /* Final report */
-    if (error_count == 0)
+static int mem_cmd_get(ucmd_session_t* s, int argc, char* argv[])
+{
+    return mem_link_start(s, argc, argv, &mem_get_args, 0);
+}
+
+static int mem_cmd_put(ucmd_session_t* s, int argc, char* argv[])
+{
+    return mem_link_start(s, argc, argv, &mem_put_args, 1);
+}
+#endif // BAREMETAL
+
+static int mem_cmd_map(ucmd_session_t* s, int argc, char* argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    for (const mem_region_t* r = mem_regions; r->name; r++)
     {
-        printf("Memory test PASSED: %lu bytes" ENDL, len);
+        fprintf(s->out, "%-8s 0x%08lx %5lu KB" ENDL, r->name, (unsigned long)r->base, (unsigned long)(r->size / 1024));
     }
-    else
+    return 0;
+}
+
+// Values are hex
+UCMD_REGISTER(mem, "mem", NULL, "memory man, use mem help");
+UCMD_REGISTER_ARGS(mem_cmp, "mem.cmp", mem_cmd_cmp, "compare memory blocks", mem_cmp_args);
+UCMD_REGISTER_ARGS(mem_crc, "mem.crc", mem_cmd_crc, "checksum, CRC unit fed by MDMA from 4 KB on, any model in software",
+                   mem_crc_args);
+UCMD_REGISTER_ARGS(mem_cpy, "mem.cpy", mem_cmd_cpy, "copy memory block, MDMA from 1 KB on", mem_cpy_args);
+UCMD_REGISTER_ARGS(mem_dump, "mem.dump", mem_cmd_dump, "hexdump, 8/16/32 bit groups, repeated lines as *",
+                   mem_dump_args);
+#ifdef BAREMETAL
+UCMD_REGISTER_ARGS(mem_get, "mem.get", mem_cmd_get, "binary upload to the host, see tools/memlink", mem_get_args);
+#endif
+UCMD_REGISTER_ARGS(mem_fill, "mem.fill", mem_cmd_fill, "fill memory with a byte or word pattern", mem_fill_args);
+UCMD_REGISTER(mem_map, "mem.map", mem_cmd_map, "list named memory regions, usable as <adr>");
+#ifdef BAREMETAL
+UCMD_REGISTER_ARGS(mem_put, "mem.put", mem_cmd_put, "binary download from the host, see tools/memlink", mem_put_args);
+#endif
+UCMD_REGISTER_ARGS(mem_read, "mem.read", mem_cmd_read, "read byte from address", mem_read_args);
+UCMD_REGISTER_ARGS(mem_test, "mem.test", mem_cmd_test, "RAM test, march walk1 walk0 addr checker or all, destructive",
+                   mem_test_args);
+UCMD_REGISTER_ARGS(mem_write, "mem.write", mem_cmd_write, "write byte to address", mem_write_args);
+
+#ifdef BAREMETAL
+// One pass per slice, a pass over 512 KB of AXI SRAM is about a ms
+static int mem_test_job(job_t* job)
+{
+    mem_test_t* t = *(mem_test_t**)job->data;
+
+    JOB_BEGIN(job);
+    job->total = mem_test_passes(t);
+    while (mem_test_step(t))
     {
-        printf("Memory test FAILED! Errors: %lu/%lu bytes" ENDL, error_count, len);
+        job->done = t->done;
+        JOB_YIELD(job);
     }
+    mem_test_report(job->session->out, t);
+    JOB_END(job);
+}
+
+static int mem_dump_job(job_t* job)
+{
+    hexdump_t* h = (hexdump_t*)job->data;
 
-    return error_count;
+    JOB_BEGIN(job);
+    job->total = h->len;
+    while (hexdump_step(job->session->out, h, MEM_DUMP_SLICE))
+    {
+        job->done = h->pos;
+        JOB_YIELD(job);
+    }
+    JOB_END(job);
 }
 
-#undef ENDL
\ No newline at end of file
+// Waits for the MDMA interrupt, takes no CPU meanwhile
+static int mem_xfer_job(job_t* job)
+{
+    mem_xfer_t* x = *(mem_xfer_t**)job->data;
+
+    JOB_BEGIN(job);
+    job->total = x->len;
+    JOB_WAIT(job, x->status != -EINPROGRESS);
+    job->done       = x->len;
+    mem_xfer_job_id = -1;
+    mem_xfer_report(job->session->out, x);
+    JOB_END(job);
+}
+
+// Ctrl+C stops the MDMA run as well, not just the wait for it
+static void mem_xfer_cancel(job_t* job)
+{
+    mem_xfer_job_id = -1;
+    mem_xfer_abort(*(mem_xfer_t**)job->data);
+}
+
+// Waits for the MDMA interrupt like mem_xfer_job()
+static int mem_crc_job(job_t* job)
+{
+    crc_req_t* r = *(crc_req_t**)job->data;
+
+    JOB_BEGIN(job);
+    job->total = (uint32_t)r->len;
+    JOB_WAIT(job, r->status != -EINPROGRESS);
+    job->done      = (uint32_t)r->len;
+    mem_crc_job_id = -1;
+    mem_crc_report(job->session->out, r);
+    JOB_END(job);
+}
+
+// The MDMA feeding the CRC unit stops with the job
+static void mem_crc_cancel(job_t* job)
+{
+    (void)job;
+    mem_crc_job_id = -1;
+    dev_crc_get()->ioctrl(CRC_ABORT, NULL);
+}
+
+// Polls the link, sleeps while waiting for the host. The input side
+// runs in the session task
+static int mem_link_job(job_t* job)
+{
+    mem_link_t* l = *(mem_link_t**)job->data;
+
+    JOB_BEGIN(job);
+    job->total = l->len;
+    while (l->status == -EINPROGRESS)
+    {
+        if (mem_link_poll(l, (uint32_t)systime_ms()))
+        {
+            JOB_YIELD(job);
+        }
+        else
+        {
+            JOB_SLEEP(job, 1);
+        }
+        job->done = l->acked;
+    }
+
+    uint32_t ms = (uint32_t)systime_ms() - mem_link_t0;
+    fprintf(job->session->out, "mem %s: %d, %lu of %lu bytes in %lu ms, %lu KB/s, %lu resent, %lu bad frames" ENDL,
+            l->put ? "put" : "get", l->status, (unsigned long)l->acked, (unsigned long)l->len, (unsigned long)ms,
+            (unsigned long)(ms ? (uint64_t)l->acked * 1000U / 1024U / ms : 0), (unsigned long)l->resends,
+            (unsigned long)l->bad);
+    mem_link_session = NULL;
+    ucmd_session_set_raw(job->session, NULL, NULL);
+    JOB_END(job);
+}
+
+// Long runs go to the background, Ctrl+C cancels
+static int mem_start_job(ucmd_session_t* s, const char* name, job_fn_t fn, const void* state, size_t size,
+                         uint32_t len)
+{
+    int id = job_start(s, name, fn, state, size);
+    if (id < 0)
+    {
+        fprintf(s->out, "Can't start job: %d" ENDL, id);
+        return id;
+    }
+    fprintf(s->out, "[%d] %s, %lu bytes, Ctrl+C to cancel" ENDL, id, name, len);
+    return 0;
+}
+#endif // BAREMETAL
+
+#undef ENDL
@@ -8,7 +8,17 @@
 #ifndef _MEM_MAN_
 #define _MEM_MAN_
 
-// uCMD handler for mem_dump.
-int ucmd_mem(int argc, char **argv);
+#include <stdint.h>
+
+#include "uarg.h"
+
+// The mem commands register themselves (mem.dump, mem.read, ...), see
+// UCMD_REGISTER in ucmd.h
+
+// Named memory region, usable in place of an address
+typedef uarg_region_t mem_region_t;
+
+// Regions of the H743, terminated by a NULL name
+extern const mem_region_t mem_regions[];
 
 #endif /* _MEM_MAN_ */
\ No newline at end of file
@@ -29,67 +29,69 @@
 #include <errno.h>
 
 #include "dev_interface.h"
+#include "uarg.h"
+#include "ucmd.h"
 
 interface_t* dev_rng_gen = NULL;
 uint8_t rng_buffer[1024] = {0};
 
+static const uarg_spec_t rng_args = UARG_SPEC("rng", UARG_DEC("<byte_count>", 1, sizeof(rng_buffer)));
+
+#undef ENDL // microrl config.h has its own
 #ifdef BAREMETAL
-int ucmd_rng(int argc, char* argv[])
+int ucmd_rng(ucmd_session_t* s, int argc, char* argv[])
 #define ENDL "\r\n"
 #else
 int main(int argc, char* argv[])
 #define ENDL "\n"
 #endif
 {
+#ifdef BAREMETAL
+    FILE* out = s->out;
+#else
+    FILE* out = stdout;
+#endif
+    uarg_val_t v[1];
     uint32_t count;
     int bytes_read;
 
     if(!dev_rng_gen){
-        printf("dev_rng_gen is NULL" ENDL);
+        fprintf(out, "dev_rng_gen is NULL" ENDL);
         return -EFAULT;
     }
 
-    // Check arguments
-    if (argc < 2) {
-        printf("Usage: rng <byte_count>" ENDL);
-        printf("  <byte_count> - number of bytes to generate (1-1024)" ENDL);
-        return -EINVAL;
-    }
-
-    // Parse byte count
-    if (sscanf(argv[1], "%lu", &count) != 1 || count == 0) {
-        printf("Invalid byte count: %s" ENDL, argv[1]);
+    // <byte_count>, 1..1024
+    if (uarg_parse(out, &rng_args, argc, argv, v) < 0) {
         return -EINVAL;
     }
+    count = v[0].u;
 
-    // Limit maximum count to prevent buffer overflow
-    if (count > 1024) {
-        printf("Count too large, limiting to 1024" ENDL);
-        count = 1024;
-    }
-
-    printf("Generating %lu random bytes..." ENDL, count);
+    fprintf(out, "Generating %lu random bytes..." ENDL, count);
 
     // Generate random bytes
     bytes_read = dev_rng_gen->read(rng_buffer, count);
     
     if (bytes_read != (int)count) {
-        printf("RNG read error: %d" ENDL, bytes_read);
+        fprintf(out, "RNG read error: %d" ENDL, bytes_read);
         return bytes_read;
     }
 
-    printf("Generation completed" ENDL);
+    fprintf(out, "Generation completed" ENDL);
 
     // Print in hex format
     for (uint32_t i = 0; i < count; i++) {
-        printf("%02x", rng_buffer[i]);
-        if ((i + 1) % 16 == 0) printf(ENDL);
+        fprintf(out, "%02x", rng_buffer[i]);
+        if ((i + 1) % 16 == 0) fprintf(out, ENDL);
     }
-    if (count % 16 != 0) printf(ENDL);
+    if (count % 16 != 0) fprintf(out, ENDL);
 
     return 0;
 }
 
+#ifdef BAREMETAL
+UCMD_REGISTER_ARGS(rng, "rng", ucmd_rng, "rng generate utility", rng_args);
+#endif
+
 int app_dev_rng_set(interface_t* dev)
 {
     if (dev != NULL)
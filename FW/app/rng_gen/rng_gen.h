@@ -31,11 +31,12 @@
 #include <errno.h>
 
 #include "dev_interface.h"
+#include "ucmd.h"
 
 /**
  * RNG utility command
  */
-int ucmd_rng(int argc, char **argv);
+int ucmd_rng(ucmd_session_t *s, int argc, char **argv);
 
 int app_dev_rng_set(interface_t* dev);
 
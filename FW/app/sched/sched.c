@@ -0,0 +1,201 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * sched.c - Cooperative run-to-completion scheduler
+ * 
+ * Copyright (c) 2025 Michael Kaa
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Tasks never preempt each other: after every task body the scheduler
+ * picks the highest priority ready task again. ISRs only set event
+ * bits (atomic OR, LDREX/STREX on the M7), so posting never blocks.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include "sched.h"
+
+#ifdef BAREMETAL
+#include "stm32h743xx.h"
+#define SCHED_CYCLES() (DWT->CYCCNT)
+#else
+#include <pthread.h>
+#include <time.h>
+static uint32_t sched_cycles_host(void);
+#define SCHED_CYCLES() sched_cycles_host()
+#endif
+
+#if SCHED_MAX_TASKS > 32
+#error "SCHED_MAX_TASKS is limited by the ready mask"
+#endif
+
+typedef struct sched_task {
+    const char *name;
+    sched_fn_t fn;
+    void *ctx;
+    uint8_t prio;
+    uint32_t runs;
+    uint32_t max_cycles;
+    uint64_t cycles;
+    volatile uint32_t events;
+} sched_task_t;
+
+static sched_task_t sched_tasks[SCHED_MAX_TASKS];
+static int sched_count;
+static volatile uint32_t sched_ready;   // bit per task id
+
+#ifndef BAREMETAL
+// Host: WFI is a condition wait, sched_post() is the "interrupt"
+static pthread_mutex_t sched_wfi_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sched_wfi_cond = PTHREAD_COND_INITIALIZER;
+
+static uint32_t sched_cycles_host(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+}
+#endif
+
+int sched_task_add(const char *name, uint8_t prio, sched_fn_t fn, void *ctx)
+{
+    if (fn == NULL) {
+        return -EINVAL;
+    }
+    if (sched_count >= SCHED_MAX_TASKS) {
+        return -ENOMEM;
+    }
+
+    sched_task_t *t = &sched_tasks[sched_count];
+    t->name = name;
+    t->fn = fn;
+    t->ctx = ctx;
+    t->prio = prio;
+    t->runs = 0;
+    t->cycles = 0;
+    t->max_cycles = 0;
+    t->events = 0;
+
+    return sched_count++;
+}
+
+void sched_post(int id, uint32_t events)
+{
+    if (id < 0 || id >= sched_count || events == 0) {
+        return;
+    }
+
+    // Events first, the ready bit makes them visible
+    __atomic_fetch_or(&sched_tasks[id].events, events, __ATOMIC_RELEASE);
+    __atomic_fetch_or(&sched_ready, 1UL << id, __ATOMIC_RELEASE);
+
+#ifndef BAREMETAL
+    pthread_mutex_lock(&sched_wfi_lock);
+    pthread_cond_signal(&sched_wfi_cond);
+    pthread_mutex_unlock(&sched_wfi_lock);
+#endif
+}
+
+int sched_run_once(void)
+{
+    uint32_t ready = __atomic_load_n(&sched_ready, __ATOMIC_ACQUIRE);
+    sched_task_t *best = NULL;
+    int best_id = 0;
+
+    if (ready == 0) {
+        return 0;
+    }
+
+    for (int id = 0; id < sched_count; id++) {
+        if ((ready & (1UL << id)) && (best == NULL || sched_tasks[id].prio < best->prio)) {
+            best = &sched_tasks[id];
+            best_id = id;
+        }
+    }
+
+    // Ready bit before events: a post in between just makes it ready again
+    __atomic_fetch_and(&sched_ready, ~(1UL << best_id), __ATOMIC_ACQ_REL);
+    uint32_t events = __atomic_exchange_n(&best->events, 0, __ATOMIC_ACQ_REL);
+
+    if (events) {
+        uint32_t start = SCHED_CYCLES();
+        best->runs++;
+        best->fn(events, best->ctx);
+        uint32_t spent = SCHED_CYCLES() - start;
+        best->cycles += spent;
+        if (spent > best->max_cycles) {
+            best->max_cycles = spent;
+        }
+    }
+    return 1;
+}
+
+#ifdef BAREMETAL
+// Plain WFI, a timebase may replace it with a tickless version
+__attribute__((weak)) void sched_wfi(void)
+{
+    __WFI();
+}
+#endif
+
+// Sleep until an interrupt, unless something became ready meanwhile
+static void sched_idle(void)
+{
+#ifdef BAREMETAL
+    __disable_irq();
+    if (sched_ready == 0) {
+        sched_wfi(); // pending IRQ wakes WFI even with PRIMASK set
+    }
+    __enable_irq();
+#else
+    pthread_mutex_lock(&sched_wfi_lock);
+    while (__atomic_load_n(&sched_ready, __ATOMIC_ACQUIRE) == 0) {
+        pthread_cond_wait(&sched_wfi_cond, &sched_wfi_lock);
+    }
+    pthread_mutex_unlock(&sched_wfi_lock);
+#endif
+}
+
+void sched_run(void)
+{
+    for (;;) {
+        if (!sched_run_once()) {
+            sched_idle();
+        }
+    }
+}
+
+int sched_task_info(int id, sched_info_t *info)
+{
+    if (id < 0 || id >= sched_count || info == NULL) {
+        return -EINVAL;
+    }
+
+    info->name = sched_tasks[id].name;
+    info->prio = sched_tasks[id].prio;
+    info->runs = sched_tasks[id].runs;
+    info->pending = sched_tasks[id].events;
+    info->cycles = sched_tasks[id].cycles;
+    info->max_cycles = sched_tasks[id].max_cycles;
+    return 0;
+}
@@ -0,0 +1,86 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * sched.h - Cooperative run-to-completion scheduler
+ *
+ * Copyright (c) 2025 Michael Kaa
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _SCHED_H
+#define _SCHED_H
+
+#include <stdint.h>
+#include <errno.h>
+
+// Task slots
+#ifndef SCHED_MAX_TASKS
+#define SCHED_MAX_TASKS 8
+#endif
+
+// Common event bits, bits from SCHED_EV_USER on are task specific
+#define SCHED_EV_RX       (1UL << 0)
+#define SCHED_EV_TX_DONE  (1UL << 1)
+#define SCHED_EV_TIMER    (1UL << 2)
+#define SCHED_EV_USER     (1UL << 8)
+
+/**
+ * Task body, runs to completion
+ * @events: Events posted since the last run (never 0)
+ * @ctx: Argument given to sched_task_add()
+ */
+typedef void (*sched_fn_t)(uint32_t events, void *ctx);
+
+/**
+ * struct sched_info - Task report
+ * @name: Task name
+ * @prio: Priority, 0 is the highest
+ * @runs: Times the task body was called
+ * @pending: Events posted but not yet delivered
+ * @cycles: CPU cycles spent in the body (ns on the host), ISRs included
+ * @max_cycles: Longest single run
+ */
+typedef struct sched_info {
+    const char *name;
+    uint8_t prio;
+    uint32_t runs;
+    uint32_t pending;
+    uint64_t cycles;
+    uint32_t max_cycles;
+} sched_info_t;
+
+// Register a task, returns its id or -ENOMEM
+int sched_task_add(const char *name, uint8_t prio, sched_fn_t fn, void *ctx);
+
+// Post events to a task, safe from any ISR
+void sched_post(int id, uint32_t events);
+
+// Run the highest priority ready task, returns 0 if none was ready
+int sched_run_once(void);
+
+// Run tasks forever, WFI when nothing is ready
+void sched_run(void) __attribute__((noreturn));
+
+// Idle sleep, called with PRIMASK set. Weak, plain WFI by default
+void sched_wfi(void);
+
+// Report a task, -EINVAL for an unused id
+int sched_task_info(int id, sched_info_t *info);
+
+#endif /* _SCHED_H */
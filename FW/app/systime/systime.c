@@ -0,0 +1,485 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * systime.c - Monotonic clock and software timer wheel
+ * 
+ * Copyright (c) 2025 Michael Kaa
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * SysTick counts SYSTIME_TICK_HZ ticks, time within a tick is read
+ * from SysTick->VAL, so the clock has CPU cycle resolution. SysTick
+ * keeps running in sleep, unlike DWT CYCCNT.
+ *
+ * Timers live in a 4 level wheel of 64 slots (Linux style cascade):
+ * start/stop are O(1), every tick expires one level 0 slot and every
+ * 64th tick redistributes one slot of the level above.
+ *
+ * When the scheduler is idle, SysTick is reprogrammed to wake at the
+ * next level 0 expiry (up to 24 bits of cycles, ~34 ms at 480 MHz).
+ * It stands still while it is reprogrammed, the CPU is awake then and
+ * CYCCNT times the stop, the next period is shortened by as much.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+
+#include "systime.h"
+#include "sched.h"
+#include "cpuload.h"
+#include "stm32h743xx.h"
+
+#define WHEEL_BITS    6U
+#define WHEEL_SIZE    (1U << WHEEL_BITS)
+#define WHEEL_MASK    (WHEEL_SIZE - 1U)
+#define WHEEL_LEVELS  4U
+#define WHEEL_SPAN    (1ULL << (WHEEL_BITS * WHEEL_LEVELS))
+
+#define SYSTICK_MAX   (SysTick_LOAD_RELOAD_Msk + 1U)
+#define SYSTICK_MIN   (1024U)  // shortest period systick_period() programs
+#define SYSTICK_PRIO  15U   // below every peripheral
+
+static systimer_t *wheel[WHEEL_LEVELS][WHEEL_SIZE];
+static uint64_t wheel_now;                  // last processed tick
+
+static volatile uint64_t tick_count;        // ticks elapsed
+static volatile uint32_t tick_step = 1;     // ticks the next SysTick IRQ stands for
+static uint32_t tick_cycles;                // SysTick clocks per tick
+
+// Task context timers that expired, FIFO
+static systimer_t *ready_head;
+static systimer_t *ready_tail;
+static int timer_task = -1;
+
+static uint64_t idle_cycles;
+
+static inline uint32_t irq_lock(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    return primask;
+}
+
+static inline void irq_unlock(uint32_t primask)
+{
+    __set_PRIMASK(primask);
+}
+
+void systime_init(void)
+{
+    tick_cycles = SystemCoreClock / SYSTIME_TICK_HZ;
+
+    // CYCCNT times SysTick stops, see systick_period()
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    SysTick->CTRL = 0;
+    SysTick->LOAD = tick_cycles - 1U;
+    SysTick->VAL = 0;
+    NVIC_SetPriority(SysTick_IRQn, SYSTICK_PRIO);
+    SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk;
+}
+
+uint64_t systime_cycles(void)
+{
+    uint32_t primask = irq_lock();
+    uint64_t ticks = tick_count;
+    uint32_t step = tick_step;
+    uint32_t val = SysTick->VAL;
+
+    // Wrapped, but the IRQ didn't run yet
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+        val = SysTick->VAL;
+        ticks += step;
+        step = 1;
+    }
+    irq_unlock(primask);
+
+    // The running period ends step ticks after tick_count
+    return (ticks + step) * tick_cycles - 1U - val;
+}
+
+uint64_t systime_us(void)
+{
+    return systime_cycles() / (SystemCoreClock / 1000000U);
+}
+
+uint64_t systime_ms(void)
+{
+    return systime_cycles() / (SystemCoreClock / 1000U);
+}
+
+void systime_delay_us(uint32_t us)
+{
+    uint64_t end = systime_cycles() + (uint64_t)us * (SystemCoreClock / 1000000U);
+
+    while (systime_cycles() < end);
+}
+
+// Link into the slot for its expiry (irq locked)
+static void wheel_insert(systimer_t *t)
+{
+    uint64_t expires = t->expires;
+    uint64_t delta = expires - wheel_now;
+    uint32_t level = 0;
+
+    // Equal only while cascading, the current slot is expired next
+    if (expires < wheel_now) {
+        expires = wheel_now + 1U; // late, next tick
+        delta = 1U;
+    }
+    if (delta >= WHEEL_SPAN) {
+        expires = wheel_now + WHEEL_SPAN - 1U; // re-cascaded until due
+        delta = WHEEL_SPAN - 1U;
+    }
+
+    while (delta >= (1ULL << (WHEEL_BITS * (level + 1U)))) {
+        level++;
+    }
+
+    systimer_t **slot = &wheel[level][(expires >> (WHEEL_BITS * level)) & WHEEL_MASK];
+    t->next = *slot;
+    if (t->next != NULL) {
+        t->next->pprev = &t->next;
+    }
+    t->pprev = slot;
+    *slot = t;
+}
+
+static void wheel_remove(systimer_t *t)
+{
+    if (t->pprev == NULL) {
+        return;
+    }
+    *t->pprev = t->next;
+    if (t->next != NULL) {
+        t->next->pprev = t->pprev;
+    }
+    t->next = NULL;
+    t->pprev = NULL;
+}
+
+// Detach a whole slot
+static systimer_t *wheel_take(uint32_t level, uint32_t idx)
+{
+    systimer_t *list = wheel[level][idx];
+
+    wheel[level][idx] = NULL;
+    for (systimer_t *t = list; t != NULL; t = t->next) {
+        t->pprev = NULL;
+    }
+    return list;
+}
+
+static void timer_expire(systimer_t *t)
+{
+    if (t->period) {
+        t->expires += t->period;
+        wheel_insert(t);
+    }
+
+    if (t->flags & SYSTIMER_ISR) {
+        t->fn(t->ctx);
+        return;
+    }
+
+    if (t->queued) {
+        t->missed++; // task didn't keep up, the run is merged
+        return;
+    }
+    t->queued = 1;
+    t->ready_next = NULL;
+    if (ready_tail != NULL) {
+        ready_tail->ready_next = t;
+    } else {
+        ready_head = t;
+    }
+    ready_tail = t;
+    sched_post(timer_task, SCHED_EV_TIMER);
+}
+
+// Advance one tick (SysTick ISR)
+static void wheel_tick(void)
+{
+    wheel_now++;
+
+    // Pull the next slot of each level down when the one below wraps
+    for (uint32_t level = 1; level < WHEEL_LEVELS; level++) {
+        if ((wheel_now & ((1ULL << (WHEEL_BITS * level)) - 1U)) != 0) {
+            break;
+        }
+        systimer_t *t = wheel_take(level, (uint32_t)(wheel_now >> (WHEEL_BITS * level)) & WHEEL_MASK);
+        while (t != NULL) {
+            systimer_t *next = t->next;
+            wheel_insert(t);
+            t = next;
+        }
+    }
+
+    systimer_t *t = wheel_take(0, (uint32_t)wheel_now & WHEEL_MASK);
+    while (t != NULL) {
+        systimer_t *next = t->next;
+        t->next = NULL;
+        timer_expire(t);
+        t = next;
+    }
+}
+
+void SysTick_Handler(void)
+{
+    CPULOAD_IRQ_ENTER();
+
+    tick_count += tick_step;
+    tick_step = 1;
+
+    while (wheel_now < tick_count) {
+        wheel_tick();
+    }
+
+    CPULOAD_IRQ_EXIT();
+}
+
+// Ticks the idle CPU may sleep: to the next level 0 expiry or the next
+// cascade, whichever comes first
+static uint32_t wheel_idle_ticks(uint32_t max)
+{
+    uint32_t n = 1;
+
+    for (; n <= max; n++) {
+        uint64_t tick = wheel_now + n;
+        if (wheel[0][tick & WHEEL_MASK] != NULL || (tick & WHEEL_MASK) == 0) {
+            break;
+        }
+    }
+    return n > max ? max : n;
+}
+
+static void systime_wfi(void);
+
+// Scheduler idle loop, called with PRIMASK set. Sleep time is measured
+// with SysTick, DWT CYCCNT stops in WFI
+void sched_wfi(void)
+{
+    uint64_t start = systime_cycles();
+
+    systime_wfi();
+    idle_cycles += systime_cycles() - start;
+}
+
+uint64_t systime_idle_cycles(void)
+{
+    uint32_t primask = irq_lock();
+    uint64_t cycles = idle_cycles;
+    irq_unlock(primask);
+    return cycles;
+}
+
+// Stop SysTick for reprogramming, returns CYCCNT at the stop
+static uint32_t systick_stop(void)
+{
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    return DWT->CYCCNT;
+}
+
+/*
+ * Run one period of load cycles from the stop at @stopped, normal ticks
+ * after it. The cycles SysTick stood still are taken off this period,
+ * up to the few stores after CYCCNT is read.
+ * LOAD is put back only once the counter has taken the new value:
+ * restored earlier, a reload still pending would use tick_cycles.
+ * load >= SYSTICK_MIN, far longer than the stop, so it can't wrap
+ * again while we wait.
+ */
+static void systick_period(uint32_t load, uint32_t stopped)
+{
+    SysTick->VAL = 0;
+    load -= DWT->CYCCNT - stopped;
+    SysTick->LOAD = load - 1U;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    while (SysTick->VAL == 0);
+    SysTick->LOAD = tick_cycles - 1U;
+}
+
+// Stopped with the IRQ pending: cycles left of the tick that followed,
+// at 0 the counter has yet to reload
+static uint32_t systick_fresh(void)
+{
+    uint32_t val = SysTick->VAL;
+
+    return val ? val + 1U : tick_cycles + 1U;
+}
+
+// Tickless WFI
+static void systime_wfi(void)
+{
+    uint32_t max = SYSTICK_MAX / tick_cycles;
+    uint32_t n = wheel_idle_ticks(max);
+
+    if (tick_cycles == 0 || n < 2U || (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) || wheel_now != tick_count) {
+        __WFI();
+        return;
+    }
+
+    // Stretch the current tick to n ticks, the period after is normal again
+    uint32_t stopped = systick_stop();
+    uint32_t left = SysTick->VAL;
+    uint32_t load = left + (n - 1U) * tick_cycles;
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+        // Wrapped just now, finish the fresh tick
+        systick_period(systick_fresh(), stopped);
+        __WFI();
+        return;
+    }
+    tick_step = n;
+    systick_period(load, stopped);
+
+    __WFI();
+
+    // SysTick woke us: the IRQ accounts n ticks once PRIMASK is cleared
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+        return;
+    }
+
+    // Another IRQ: count the whole ticks slept, realign to the tick grid
+    stopped = systick_stop();
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+        systick_period(systick_fresh(), stopped);
+        return;
+    }
+    uint32_t elapsed = (tick_cycles - left) + (load - 1U - SysTick->VAL);
+    uint32_t next = tick_cycles - elapsed % tick_cycles;
+
+    tick_count += elapsed / tick_cycles;
+    tick_step = 1;
+    // Too close to the boundary to reprogram, run on to the tick after
+    if (next < SYSTICK_MIN) {
+        next += tick_cycles;
+        tick_step = 2;
+    }
+    systick_period(next, stopped);
+
+    // Expire the ticks counted here, irq locked just like the ISR. A
+    // pended ISR standing for 0 ticks could swallow a real expiry
+    while (wheel_now < tick_count) {
+        wheel_tick();
+    }
+}
+
+// Runs expired task context timers
+static void timer_run(uint32_t events, void *ctx)
+{
+    (void)events;
+    (void)ctx;
+
+    for (;;) {
+        uint32_t primask = irq_lock();
+        systimer_t *t = ready_head;
+        if (t != NULL) {
+            ready_head = t->ready_next;
+            if (ready_head == NULL) {
+                ready_tail = NULL;
+            }
+            t->queued = 0;
+        }
+        irq_unlock(primask);
+
+        if (t == NULL) {
+            break;
+        }
+        t->fn(t->ctx);
+    }
+}
+
+int systimer_task_init(uint8_t prio)
+{
+    if (timer_task < 0) {
+        timer_task = sched_task_add("timer", prio, timer_run, NULL);
+    }
+    return timer_task < 0 ? timer_task : 0;
+}
+
+// Drop from the ready FIFO (irq locked)
+static void ready_remove(systimer_t *t)
+{
+    systimer_t *prev = NULL;
+
+    for (systimer_t *p = ready_head; p != NULL; prev = p, p = p->ready_next) {
+        if (p != t) {
+            continue;
+        }
+        if (prev != NULL) {
+            prev->ready_next = p->ready_next;
+        } else {
+            ready_head = p->ready_next;
+        }
+        if (ready_tail == p) {
+            ready_tail = prev;
+        }
+        break;
+    }
+    t->queued = 0;
+}
+
+int systimer_start(systimer_t *t, uint32_t delay_ms, uint32_t period_ms,
+                   void (*fn)(void *ctx), void *ctx, uint8_t flags)
+{
+    if (t == NULL || fn == NULL) {
+        return -EINVAL;
+    }
+    if (!(flags & SYSTIMER_ISR) && timer_task < 0) {
+        return -ENODEV;
+    }
+
+    uint32_t ticks = (uint32_t)(((uint64_t)delay_ms * SYSTIME_TICK_HZ + 999U) / 1000U);
+    uint32_t period = (uint32_t)(((uint64_t)period_ms * SYSTIME_TICK_HZ + 999U) / 1000U);
+
+    uint32_t primask = irq_lock();
+    wheel_remove(t);
+    if (t->queued) {
+        ready_remove(t);
+    }
+    t->fn = fn;
+    t->ctx = ctx;
+    t->flags = flags;
+    t->period = period;
+    t->missed = 0;
+    t->expires = wheel_now + (ticks ? ticks : 1U);
+    wheel_insert(t);
+    irq_unlock(primask);
+
+    return 0;
+}
+
+void systimer_stop(systimer_t *t)
+{
+    if (t == NULL) {
+        return;
+    }
+
+    uint32_t primask = irq_lock();
+    wheel_remove(t);
+    if (t->queued) {
+        ready_remove(t);
+    }
+    t->period = 0;
+    irq_unlock(primask);
+}
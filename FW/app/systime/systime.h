@@ -0,0 +1,88 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * systime.h - Monotonic clock and software timer wheel
+ *
+ * Copyright (c) 2025 Michael Kaa
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _SYSTIME_H
+#define _SYSTIME_H
+
+#include <stdint.h>
+#include <errno.h>
+
+// Wheel tick
+#define SYSTIME_TICK_HZ 1000U
+
+// Run the callback in the SysTick ISR instead of the timer task
+#define SYSTIMER_ISR 0x01U
+
+/**
+ * struct systimer - Software timer, owned by the caller
+ * @fn: Callback, SysTick ISR or timer task context (SYSTIMER_ISR)
+ * @ctx: Argument for @fn
+ *
+ * The other fields are private. A timer must stay alive while started.
+ */
+typedef struct systimer systimer_t;
+struct systimer {
+    systimer_t *next;
+    systimer_t **pprev;
+    systimer_t *ready_next;
+    uint64_t expires;
+    uint32_t period;
+    uint32_t missed;
+    void (*fn)(void *ctx);
+    void *ctx;
+    uint8_t flags;
+    volatile uint8_t queued;
+};
+
+// Start SysTick at SYSTIME_TICK_HZ from SystemCoreClock
+void systime_init(void);
+
+// Monotonic time since systime_init(), never wraps in practice
+uint64_t systime_cycles(void);
+uint64_t systime_us(void);
+uint64_t systime_ms(void);
+
+// Time spent asleep in the scheduler idle loop (SysTick clocks)
+uint64_t systime_idle_cycles(void);
+
+// Busy wait, for short hardware delays only
+void systime_delay_us(uint32_t us);
+
+// Task context dispatch through the scheduler
+int systimer_task_init(uint8_t prio);
+
+/**
+ * Start (or restart) a timer
+ * @delay_ms: First expiry, at least one tick
+ * @period_ms: Reload, 0 for one-shot
+ * @flags: SYSTIMER_ISR or 0
+ */
+int systimer_start(systimer_t *t, uint32_t delay_ms, uint32_t period_ms,
+                   void (*fn)(void *ctx), void *ctx, uint8_t flags);
+
+// Stop a timer, safe if not running
+void systimer_stop(systimer_t *t);
+
+#endif /* _SYSTIME_H */
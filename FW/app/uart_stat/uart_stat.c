@@ -0,0 +1,155 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * uart_stat.c - UART statistics utility for STM32H743
+ * 
+ * Copyright (c) 2025 Michael Kaa
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "uart_stat.h"
+#include "dev_uart.h"
+#include "ucmd.h"
+
+#define ENDL "\r\n"
+
+#define UART_PORT_MAX 8U
+
+// Port number -> accessor, NULL for ports not compiled in
+static const interface_t* (*const uart_get[UART_PORT_MAX + 1U])(void) = {
+#if DEV_UART_USE_UART1
+    [1] = dev_uart1_get,
+#endif
+#if DEV_UART_USE_UART2
+    [2] = dev_uart2_get,
+#endif
+#if DEV_UART_USE_UART3
+    [3] = dev_uart3_get,
+#endif
+#if DEV_UART_USE_UART4
+    [4] = dev_uart4_get,
+#endif
+#if DEV_UART_USE_UART5
+    [5] = dev_uart5_get,
+#endif
+#if DEV_UART_USE_UART6
+    [6] = dev_uart6_get,
+#endif
+#if DEV_UART_USE_UART7
+    [7] = dev_uart7_get,
+#endif
+#if DEV_UART_USE_UART8
+    [8] = dev_uart8_get,
+#endif
+};
+
+static int uart_stat_print(FILE* out, unsigned int n, int verbose)
+{
+    const interface_t* dev = uart_get[n]();
+    uart_stats_t st;
+    uint32_t baudrate = 0;
+
+    int ret = dev->ioctrl(INTERFACE_GET_STATUS, &st);
+    if (ret < 0) {
+        if (verbose) {
+            fprintf(out, "uart%u: not open" ENDL, n);
+        }
+        return ret;
+    }
+    dev->ioctrl(UART_GET_BAUDRATE, &baudrate);
+
+    fprintf(out, "uart%u: %lu baud, ring %u B" ENDL, n, baudrate, UART_RX_BUFFER_SIZE);
+    fprintf(out, "  rx %10lu B   ht %lu tc %lu idle %lu wraps %lu" ENDL,
+           st.rx_bytes, st.rx_dma_ht, st.rx_dma_tc, st.rx_idle, st.rx_wraps);
+    fprintf(out, "  tx %10lu B   bursts %lu aborts %lu" ENDL, st.tx_bytes, st.tx_dma_tc, st.tx_aborts);
+    fprintf(out, "  ring peak %lu, overruns %lu, rts throttles %lu" ENDL,
+           st.rx_peak, st.rx_overruns, st.rts_throttles);
+    fprintf(out, "  errors fe %lu ne %lu ore %lu pe %lu dma rx %lu tx %lu" ENDL,
+           st.err_frame, st.err_noise, st.err_overrun, st.err_parity,
+           st.dma_rx_err, st.dma_tx_err);
+    return 0;
+}
+
+int ucmd_uartstat(ucmd_session_t* s, int argc, char* argv[])
+{
+    unsigned int first = 1;
+    unsigned int last = UART_PORT_MAX;
+    int clear = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "clear") == 0) {
+            clear = 1;
+            continue;
+        }
+
+        // "3" or "uart3"
+        const char* arg = strncmp(argv[i], "uart", 4) == 0 ? argv[i] + 4 : argv[i];
+        char* end;
+        unsigned long n = strtoul(arg, &end, 10);
+        if (*end != '\0' || n == 0 || n > UART_PORT_MAX || uart_get[n] == NULL) {
+            fprintf(s->out, "Usage: uartstat [port] [clear]" ENDL);
+            fprintf(s->out, "  [port]  - 1..8 or uart1..uart8, all open ports if omitted" ENDL);
+            fprintf(s->out, "  [clear] - reset counters after printing" ENDL);
+            return -EINVAL;
+        }
+        first = last = (unsigned int)n;
+    }
+
+    for (unsigned int n = first; n <= last; n++) {
+        if (uart_get[n] == NULL) {
+            continue;
+        }
+        if (uart_stat_print(s->out, n, first == last) == 0 && clear) {
+            uart_get[n]()->ioctrl(UART_CLEAR_STATS, NULL);
+        }
+    }
+
+    return 0;
+}
+
+// Ports compiled in, then "clear"
+static void uart_stat_complete(int argn, const char* prefix)
+{
+    static const char* const names[UART_PORT_MAX + 1U] = {
+        NULL, "uart1", "uart2", "uart3", "uart4", "uart5", "uart6", "uart7", "uart8",
+    };
+    static const char* const words[] = {"clear", NULL};
+    size_t len = strlen(prefix);
+
+    if (argn > 2) {
+        return;
+    }
+    for (unsigned int n = 1; n <= UART_PORT_MAX; n++) {
+        if (uart_get[n] != NULL && strncmp(names[n], prefix, len) == 0) {
+            ucmd_complete_add(names[n]);
+        }
+    }
+    ucmd_complete_list(words, prefix);
+}
+
+UCMD_REGISTER_COMPLETE(uartstat, "uartstat", ucmd_uartstat, "uart counters, uartstat [port] [clear]",
+                       uart_stat_complete);
+
+#undef ENDL
@@ -1,19 +1,19 @@
 /* SPDX-License-Identifier: MIT */
 /*
- * dev_uart1.h - POSIX-style UART interface implementation for STM32H743
- * 
+ * uart_stat.h - UART statistics utility
+ *
  * Copyright (c) 2025 Michael Kaa
- * 
+ *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
  * in the Software without restriction, including without limitation the rights
  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
  * copies of the Software, and to permit persons to whom the Software is
  * furnished to do so, subject to the following conditions:
- * 
+ *
  * The above copyright notice and this permission notice shall be included in all
  * copies or substantial portions of the Software.
- * 
+ *
  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
@@ -23,30 +23,18 @@
  * SOFTWARE.
  */
 
-#ifndef DEV_UART1_H
-#define DEV_UART1_H
+#ifndef _UART_STAT_H
+#define _UART_STAT_H
 
 #include <stddef.h>
 #include <stdint.h>
-#include "dev_interface.h"
+#include <errno.h>
 
-// Configure GPIO for USART1 (PB14 - TX, PB15 - RX)
-// Buffer sizes
-#define UART_TX_BUFFER_SIZE 256
-#define UART_RX_BUFFER_SIZE 256
+#include "ucmd.h"
 
-// Default baudrate
-#define UART_DEFAULT_BAUDRATE 115200
-
-// UART-specific ioctrl commands
-#define UART_INIT           (INTERFACE_CMD_DEVICE + 0)
-#define UART_DEINIT         (INTERFACE_CMD_DEVICE + 1)
-#define UART_GET_AVAILABLE  (INTERFACE_CMD_DEVICE + 2)
-#define UART_FLUSH          (INTERFACE_CMD_DEVICE + 3)
-#define UART_SET_BAUDRATE   (INTERFACE_CMD_DEVICE + 4)
-#define UART_GET_BAUDRATE   (INTERFACE_CMD_DEVICE + 5)
-
-// Global UART device instance accessor
-const interface_t* dev_uart1_get(void);
+/**
+ * Print UART counters: uartstat [port] [clear]
+ */
+int ucmd_uartstat(ucmd_session_t *s, int argc, char **argv);
 
-#endif /* DEV_UART1_H */
\ No newline at end of file
+#endif /* _UART_STAT_H */
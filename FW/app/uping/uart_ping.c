@@ -29,19 +29,31 @@
 #include <errno.h>
 
 #include "uart_ping.h"
+#include "uarg.h"
+#include "ucmd.h"
 
 interface_t* dev_uart_ping = NULL;
 
 uint8_t tx_buf[1024] = {0};
 
+static const uarg_spec_t uping_args =
+    UARG_SPEC("uping", UARG_HEX("<hex_byte>", 0, 0xff), UARG_OPT_DEC("[count]", 1, sizeof(tx_buf), 1));
+
+#undef ENDL // microrl config.h has its own
 #ifdef BAREMETAL
-int ucmd_uping(int argc, char* argv[])
+int ucmd_uping(ucmd_session_t* s, int argc, char* argv[])
 #define ENDL "\r\n"
 #else
 int main(int argc, char* argv[])
 #define ENDL "\n"
 #endif // BAREMETAL
 {
+#ifdef BAREMETAL
+    FILE* out = s->out;
+#else
+    FILE* out = stdout;
+#endif
+    uarg_val_t v[2];
     uint8_t pattern;
     uint32_t count;
     uint8_t rx_buffer[256];
@@ -51,58 +63,35 @@ int main(int argc, char* argv[])
 
 
     if(!dev_uart_ping){
-        printf("dev_uart_ping is NULL"ENDL);
+        fprintf(out, "dev_uart_ping is NULL"ENDL);
         return -EFAULT;
     }
 
-    // Check arguments
-    if (argc < 2) {
-        printf("Usage: uart_ping <hex_byte> [count]" ENDL);
-        printf("  <hex_byte> - byte value to send (hex, e.g., 55, AA, FF)" ENDL);
-        printf("  [count]    - number of bytes to send (default: 1)" ENDL);
+    // <hex_byte> [count], count 1..1024, default 1
+    if (uarg_parse(out, &uping_args, argc, argv, v) < 0) {
         return -EINVAL;
     }
+    pattern = (uint8_t)v[0].u;
+    count = v[1].u;
 
-    // Parse pattern byte
-    if (sscanf(argv[1], "%hhx", &pattern) != 1) {
-        printf("Invalid byte format: %s" ENDL, argv[1]);
-        printf("Use hex values (00-FF)" ENDL);
-        return -EINVAL;
-    }
-
-    // Parse count (default to 1)
-    count = 1;
-    if (argc >= 3) {
-        if (sscanf(argv[2], "%lu", &count) != 1 || count == 0) {
-            printf("Invalid count: %s" ENDL, argv[2]);
-            return -EINVAL;
-        }
-    }
-
-    // Limit maximum count to prevent buffer overflow
-    if (count > 1024) {
-        printf("Count too large, limiting to 1024" ENDL);
-        count = 1024;
-    }
-
-    printf("UART Ping Test" ENDL);
-    printf("Sending %lu bytes of 0x%02x" ENDL, count, pattern);
+    fprintf(out, "UART Ping Test" ENDL);
+    fprintf(out, "Sending %lu bytes of 0x%02x" ENDL, count, pattern);
 
     memset(tx_buf, pattern, count);
 
     int result = dev_uart_ping->write(tx_buf, count);
     if (result != (int)count) {
-        printf("Send error: %d" ENDL, result);
+        fprintf(out, "Send error: %d" ENDL, result);
         return result;
     }
 
-    printf("Send completed" ENDL);
+    fprintf(out, "Send completed" ENDL);
 
     // Check for received data
     dev_uart_ping->ioctrl(INTERFACE_CMD_DEVICE, &available);
     
     if (available > 0) {
-        printf("Received %d bytes:" ENDL, available);
+        fprintf(out, "Received %d bytes:" ENDL, available);
         
         // Determine how many bytes to read (safe conversion)
         to_read = (size_t)available;
@@ -116,27 +105,31 @@ int main(int argc, char* argv[])
         if (rx_bytes > 0) {
             // Print in hex format
             for (int i = 0; i < rx_bytes; i++) {
-                printf("%02x ", rx_buffer[i]);
-                if ((i + 1) % 16 == 0) printf(ENDL);
+                fprintf(out, "%02x ", rx_buffer[i]);
+                if ((i + 1) % 16 == 0) fprintf(out, ENDL);
             }
-            if (rx_bytes % 16 != 0) printf(ENDL);
+            if (rx_bytes % 16 != 0) fprintf(out, ENDL);
             
             // Print in ASCII format (for printable characters)
-            printf("ASCII: ");
+            fprintf(out, "ASCII: ");
             for (int i = 0; i < rx_bytes; i++) {
                 if (rx_buffer[i] >= 32 && rx_buffer[i] <= 126) {
-                    printf("%c", rx_buffer[i]);
+                    fprintf(out, "%c", rx_buffer[i]);
                 } else {
-                    printf(".");
+                    fprintf(out, ".");
                 }
             }
-            printf(ENDL);
+            fprintf(out, ENDL);
         }
     } else {
-        printf("No data received" ENDL);
+        fprintf(out, "No data received" ENDL);
     }
 
     return 0;
 }
 
+#ifdef BAREMETAL
+UCMD_REGISTER_ARGS(uping, "uping", ucmd_uping, "uart test utility, send a byte pattern", uping_args);
+#endif // BAREMETAL
+
 #undef ENDL
\ No newline at end of file
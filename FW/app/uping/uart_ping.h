@@ -31,11 +31,12 @@
 #include <errno.h>
 
 #include "dev_interface.h"
+#include "ucmd.h"
 
 /**
  * TODO: ...
  */
-int ucmd_uping(int argc, char **argv);
+int ucmd_uping(ucmd_session_t *s, int argc, char **argv);
 
 extern interface_t* dev_uart_ping;
 
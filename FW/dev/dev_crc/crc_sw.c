@@ -0,0 +1,174 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * crc_sw.c - Table driven CRC, slice-by-8, any width up to 32
+ *
+ * Copyright (c) 2025 Michael Kaa
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <errno.h>
+#include "crc_sw.h"
+
+const char *const crc_model_names[] = {
+    "crc32", "crc32c", "crc32-bzip2", "crc32-mpeg2",
+    "crc16-ccitt", "crc16-xmodem", "crc16-kermit", "crc16-modbus", "crc16-arc",
+    "crc12-umts", "crc8", "crc8-maxim", "crc7-mmc", NULL
+};
+
+//                 poly         init         xorout       w   in out   check
+const crc_model_t crc_models[] = {
+    {{0x04C11DB7U, 0xFFFFFFFFU, 0xFFFFFFFFU, 32, 1, 1}, 0xCBF43926U},
+    {{0x1EDC6F41U, 0xFFFFFFFFU, 0xFFFFFFFFU, 32, 1, 1}, 0xE3069283U},
+    {{0x04C11DB7U, 0xFFFFFFFFU, 0xFFFFFFFFU, 32, 0, 0}, 0xFC891918U},
+    {{0x04C11DB7U, 0xFFFFFFFFU, 0x00000000U, 32, 0, 0}, 0x0376E6E7U},
+    {{0x1021U,     0xFFFFU,     0x0000U,     16, 0, 0}, 0x29B1U},
+    {{0x1021U,     0x0000U,     0x0000U,     16, 0, 0}, 0x31C3U},
+    {{0x1021U,     0x0000U,     0x0000U,     16, 1, 1}, 0x2189U},
+    {{0x8005U,     0xFFFFU,     0x0000U,     16, 1, 1}, 0x4B37U},
+    {{0x8005U,     0x0000U,     0x0000U,     16, 1, 1}, 0xBB3DU},
+    {{0x80FU,      0x000U,      0x000U,      12, 0, 1}, 0xDAFU},
+    {{0x07U,       0x00U,       0x00U,        8, 0, 0}, 0xF4U},
+    {{0x31U,       0x00U,       0x00U,        8, 1, 1}, 0xA1U},
+    {{0x09U,       0x00U,       0x00U,        7, 0, 0}, 0x75U},
+};
+
+static crc_sw_t crc32_sw;
+
+static uint32_t crc_mask(uint32_t width) {
+    return 0xFFFFFFFFU >> (32U - width);
+}
+
+uint32_t crc_reflect(uint32_t v, uint32_t width) {
+    uint32_t r = 0;
+
+    for (uint32_t i = 0; i < width; i++, v >>= 1) {
+        r = (r << 1) | (v & 1U);
+    }
+    return r;
+}
+
+int crc_sw_init(crc_sw_t *c, const crc_cfg_t *cfg) {
+    uint32_t width = cfg->width;
+
+    if (width < 1U || width > 32U) {
+        return -EINVAL;
+    }
+    c->cfg = *cfg;
+
+    if (cfg->refin) {
+        uint32_t poly = crc_reflect(cfg->poly, width);
+
+        for (uint32_t i = 0; i < 256U; i++) {
+            uint32_t r = i;
+            for (int k = 0; k < 8; k++) {
+                r = (r & 1U) ? (r >> 1) ^ poly : r >> 1;
+            }
+            c->table[0][i] = r;
+        }
+        for (uint32_t k = 1; k < 8U; k++) {
+            for (uint32_t i = 0; i < 256U; i++) {
+                uint32_t r = c->table[k - 1U][i];
+                c->table[k][i] = (r >> 8) ^ c->table[0][r & 0xFFU];
+            }
+        }
+    } else {
+        uint32_t poly = (cfg->poly & crc_mask(width)) << (32U - width);
+
+        for (uint32_t i = 0; i < 256U; i++) {
+            uint32_t r = i << 24;
+            for (int k = 0; k < 8; k++) {
+                r = (r & 0x80000000U) ? (r << 1) ^ poly : r << 1;
+            }
+            c->table[0][i] = r;
+        }
+        for (uint32_t k = 1; k < 8U; k++) {
+            for (uint32_t i = 0; i < 256U; i++) {
+                uint32_t r = c->table[k - 1U][i];
+                c->table[k][i] = (r << 8) ^ c->table[0][r >> 24];
+            }
+        }
+    }
+    return 0;
+}
+
+uint32_t crc_sw_start(const crc_sw_t *c) {
+    uint32_t width = c->cfg.width;
+    uint32_t init = c->cfg.init & crc_mask(width);
+
+    return c->cfg.refin ? crc_reflect(init, width) : init << (32U - width);
+}
+
+uint32_t crc_sw_update(const crc_sw_t *c, uint32_t reg, const void *buf, size_t len) {
+    const uint8_t *p = buf;
+    const uint32_t (*t)[256] = c->table;
+
+    if (c->cfg.refin) {
+        for (; len && ((uintptr_t)p & 3U); len--) {
+            reg = t[0][(reg ^ *p++) & 0xFFU] ^ (reg >> 8);
+        }
+        for (; len >= 8U; len -= 8U, p += 8U) {
+            uint32_t a = ((const uint32_t *)p)[0] ^ reg;
+            uint32_t b = ((const uint32_t *)p)[1];
+            reg = t[7][a & 0xFFU] ^ t[6][(a >> 8) & 0xFFU] ^ t[5][(a >> 16) & 0xFFU] ^ t[4][a >> 24] ^
+                  t[3][b & 0xFFU] ^ t[2][(b >> 8) & 0xFFU] ^ t[1][(b >> 16) & 0xFFU] ^ t[0][b >> 24];
+        }
+        while (len--) {
+            reg = t[0][(reg ^ *p++) & 0xFFU] ^ (reg >> 8);
+        }
+    } else {
+        // The first byte is the most significant one, REV on the M7
+        for (; len && ((uintptr_t)p & 3U); len--) {
+            reg = (reg << 8) ^ t[0][(reg >> 24) ^ *p++];
+        }
+        for (; len >= 8U; len -= 8U, p += 8U) {
+            uint32_t a = __builtin_bswap32(((const uint32_t *)p)[0]) ^ reg;
+            uint32_t b = __builtin_bswap32(((const uint32_t *)p)[1]);
+            reg = t[7][a >> 24] ^ t[6][(a >> 16) & 0xFFU] ^ t[5][(a >> 8) & 0xFFU] ^ t[4][a & 0xFFU] ^
+                  t[3][b >> 24] ^ t[2][(b >> 16) & 0xFFU] ^ t[1][(b >> 8) & 0xFFU] ^ t[0][b & 0xFFU];
+        }
+        while (len--) {
+            reg = (reg << 8) ^ t[0][(reg >> 24) ^ *p++];
+        }
+    }
+    return reg;
+}
+
+uint32_t crc_sw_final(const crc_sw_t *c, uint32_t reg) {
+    uint32_t width = c->cfg.width;
+
+    if (!c->cfg.refin) {
+        reg >>= 32U - width;
+    }
+    if (c->cfg.refin != c->cfg.refout) {
+        reg = crc_reflect(reg, width);
+    }
+    return (reg ^ c->cfg.xorout) & crc_mask(width);
+}
+
+uint32_t crc_sw_calc(const crc_sw_t *c, const void *buf, size_t len) {
+    return crc_sw_final(c, crc_sw_update(c, crc_sw_start(c), buf, len));
+}
+
+uint32_t crc32_update(uint32_t crc, const void *buf, size_t len) {
+    if (crc32_sw.table[0][1] == 0) {
+        crc_sw_init(&crc32_sw, &crc_models[0].cfg);
+    }
+    return ~crc_sw_update(&crc32_sw, ~crc, buf, len);
+}
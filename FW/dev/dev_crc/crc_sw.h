@@ -0,0 +1,108 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * crc_sw.h - Table driven CRC, slice-by-8, any width up to 32
+ *
+ * Copyright (c) 2025 Michael Kaa
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CRC_SW_H
+#define CRC_SW_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// A CRC model in the usual catalogue terms (Rocksoft): @poly without
+// its top bit, @init and @xorout as the catalogue gives them. The
+// software handles any width from 1 to 32, the hardware unit 7, 8, 16
+// and 32 bits, see dev_crc.h
+
+/**
+ * struct crc_cfg - CRC model
+ * @poly: Generator, normal (MSB first) form: 0x04C11DB7 for CRC-32
+ * @init: Register start value, not reflected
+ * @xorout: XORed onto the final value
+ * @width: Bits, 1 to 32
+ * @refin: 1 - bytes go in LSB first
+ * @refout: 1 - the final register is reflected before @xorout
+ */
+typedef struct crc_cfg {
+    uint32_t poly;
+    uint32_t init;
+    uint32_t xorout;
+    uint8_t width;
+    uint8_t refin;
+    uint8_t refout;
+} crc_cfg_t;
+
+/**
+ * struct crc_model - Catalogue entry
+ * @cfg: Parameters
+ * @check: CRC of the nine ASCII bytes "123456789"
+ */
+typedef struct crc_model {
+    crc_cfg_t cfg;
+    uint32_t check;
+} crc_model_t;
+
+// Common models, CRC-32 (zlib) first. crc_model_names[i] names
+// crc_models[i], the names are NULL terminated for the command line
+extern const crc_model_t crc_models[];
+extern const char *const crc_model_names[];
+
+/**
+ * struct crc_sw - Tables of one model
+ * @cfg: The model
+ * @table: table[0] is the byte at a time table, table[k] advances a byte
+ *         k bytes ahead of the register. 8 KB
+ *
+ * The register runs in the model's input order: reflected in the low
+ * @width bits when @refin, else normal in the top @width bits, so both
+ * shift whole bytes out of one end of a 32 bit word.
+ */
+typedef struct crc_sw {
+    crc_cfg_t cfg;
+    uint32_t table[8][256];
+} crc_sw_t;
+
+// Build the tables, -EINVAL for a width out of 1..32
+int crc_sw_init(crc_sw_t *c, const crc_cfg_t *cfg);
+
+// Register value before the first byte
+uint32_t crc_sw_start(const crc_sw_t *c);
+
+// Feed @len bytes, returns the new register. Eight bytes per step once
+// @buf is word aligned, little endian loads
+uint32_t crc_sw_update(const crc_sw_t *c, uint32_t reg, const void *buf, size_t len);
+
+// CRC value of the register: reflection, @xorout, @width bits
+uint32_t crc_sw_final(const crc_sw_t *c, uint32_t reg);
+
+// CRC of one block
+uint32_t crc_sw_calc(const crc_sw_t *c, const void *buf, size_t len);
+
+// Reverse the low @width bits of @v
+uint32_t crc_reflect(uint32_t v, uint32_t width);
+
+// CRC-32 as zlib's crc32(): start with 0, feed the previous result back.
+// Own tables, built on the first call
+uint32_t crc32_update(uint32_t crc, const void *buf, size_t len);
+
+#endif /* CRC_SW_H */
@@ -0,0 +1,380 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * dev_crc.c - CRC calculation unit for STM32H743
+ *
+ * Copyright (c) 2025 Michael Kaa
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include "dev_crc.h"
+#include "dev_mdma.h"
+#include "stm32h743xx.h"
+
+#define CRC_DR8           (*(__IO uint8_t *)&CRC->DR)
+
+const char *const crc_engine_names[] = {"auto", "sw", "cpu", "dma", NULL};
+
+static struct {
+    crc_cfg_t cfg;
+    uint32_t mask;
+    uint32_t cr;            // CR of the model, without RESET
+    uint32_t reg;           // write(): the unit's register, or crc_sw's
+    uint8_t hw;             // the unit does the model
+    crc_req_t *volatile req;
+    mdma_req_t mdma;
+    const uint8_t *tail;    // after the MDMA part, the interrupt feeds it
+    uint32_t tail_len;
+    uint32_t start;
+    crc_stats_t stats;
+    uint8_t initialized;
+} crc;
+
+// Tables of the current model, the fallback and write() of a model the
+// unit can't do
+static crc_sw_t crc_sw;
+
+static inline uint32_t irq_lock(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    return primask;
+}
+
+static inline void irq_unlock(uint32_t primask) {
+    __set_PRIMASK(primask);
+}
+
+// POLYSIZE encoding, 0 if the unit doesn't do the width
+static uint32_t crc_polysize(uint32_t width) {
+    switch (width) {
+        case 32: return 0U;
+        case 16: return CRC_CR_POLYSIZE_0;
+        case 8:  return CRC_CR_POLYSIZE_1;
+        case 7:  return CRC_CR_POLYSIZE_0 | CRC_CR_POLYSIZE_1;
+        default: return 0xFFFFFFFFU;
+    }
+}
+
+// Take @cfg, its tables are built. Even polynomials aren't supported
+// by the unit
+static void crc_apply(const crc_cfg_t *cfg) {
+    uint32_t size = crc_polysize(cfg->width);
+
+    crc.cfg = *cfg;
+    crc.mask = 0xFFFFFFFFU >> (32U - cfg->width);
+    crc.hw = size != 0xFFFFFFFFU && (cfg->poly & 1U);
+    crc.cr = crc.hw ? size | (cfg->refin ? CRC_CR_REV_IN_0 : 0U) : 0U;
+    crc.reg = crc.hw ? cfg->init & crc.mask : crc_sw_start(&crc_sw);
+}
+
+// Load the model and start the unit from @reg
+static void crc_hw_start(uint32_t reg) {
+    CRC->POL = crc.cfg.poly & crc.mask;
+    CRC->CR = crc.cr;
+    CRC->INIT = reg;
+    CRC->CR = crc.cr | CRC_CR_RESET;
+}
+
+// Bytes up to a word, then words byte swapped so the unit takes them
+// first byte first, bytes again at the end. The unit stalls the bus
+// while it computes, no polling
+static void crc_hw_feed(const uint8_t *p, size_t len) {
+    for (; len && ((uintptr_t)p & 3U); len--) {
+        CRC_DR8 = *p++;
+    }
+    for (; len >= 16U; len -= 16U, p += 16U) {
+        CRC->DR = __REV(((const uint32_t *)p)[0]);
+        CRC->DR = __REV(((const uint32_t *)p)[1]);
+        CRC->DR = __REV(((const uint32_t *)p)[2]);
+        CRC->DR = __REV(((const uint32_t *)p)[3]);
+    }
+    for (; len >= 4U; len -= 4U, p += 4U) {
+        CRC->DR = __REV(*(const uint32_t *)p);
+    }
+    while (len--) {
+        CRC_DR8 = *p++;
+    }
+}
+
+// The unit's register to the CRC value
+static uint32_t crc_hw_final(uint32_t reg) {
+    reg &= crc.mask;
+    if (crc.cfg.refout) {
+        reg = crc_reflect(reg, crc.cfg.width);
+    }
+    return (reg ^ crc.cfg.xorout) & crc.mask;
+}
+
+static void crc_finish(crc_req_t *req, int status) {
+    req->cycles = DWT->CYCCNT - crc.start;
+    if (status == 0) {
+        crc.stats.calcs++;
+        crc.stats.bytes += req->len;
+    } else if (status == -EIO) {
+        crc.stats.errors++;
+    }
+    crc.req = NULL;
+    req->status = status;
+    if (req->done) {
+        req->done(req);
+    }
+}
+
+// MDMA interrupt: the body is in, the tail is a few bytes
+static void crc_dma_done(mdma_req_t *m) {
+    crc_req_t *req = (crc_req_t *)m->ctx;
+
+    if (m->status == 0) {
+        crc_hw_feed(crc.tail, crc.tail_len);
+        req->crc = crc_hw_final(CRC->DR);
+        crc.stats.dma++;
+    }
+    crc_finish(req, m->status);
+}
+
+// The CPU feeds the unaligned head, the MDMA the words, the interrupt
+// the tail. Not started if the MDMA is busy, -ENODATA if there are no
+// whole words
+static int crc_dma_start(crc_req_t *req) {
+    const uint8_t *p = req->buf;
+    uint32_t len = (uint32_t)req->len;
+    uint32_t head = (0U - (uint32_t)p) & 3U;
+    interface_t *mdma = dev_mdma_get();
+    int ret;
+
+    if (head > len) {
+        head = len;
+    }
+    uint32_t body = (len - head) & ~3U;
+    if (body == 0) {
+        return -ENODATA;
+    }
+    ret = mdma->open();
+    if (ret < 0) {
+        return ret;
+    }
+
+    // Before the start, the interrupt may come before ioctrl returns
+    req->engine = CRC_ENGINE_DMA;
+    req->status = -EINPROGRESS;
+    crc.tail = p + head + body;
+    crc.tail_len = len - head - body;
+    crc.mdma = (mdma_req_t){
+        .dst = (void *)&CRC->DR,
+        .src = p + head,
+        .len = body,
+        .swap = 1,
+        .done = crc_dma_done,
+        .ctx = req,
+    };
+    crc.start = DWT->CYCCNT;
+    crc_hw_start(crc.cfg.init & crc.mask);
+    crc_hw_feed(p, head);
+    return mdma->ioctrl(MDMA_FEED, &crc.mdma);
+}
+
+static int crc_calc(crc_req_t *req) {
+    int asked = req->engine;
+    int engine = asked;
+
+    if (!crc.initialized) {
+        return -ENODEV;
+    }
+    if (req->buf == NULL && req->len) {
+        return -EINVAL;
+    }
+
+    uint32_t primask = irq_lock();
+    if (crc.req != NULL) {
+        irq_unlock(primask);
+        return -EBUSY;
+    }
+    crc.req = req;
+    irq_unlock(primask);
+
+    if (!crc.hw) {
+        engine = CRC_ENGINE_SW;
+    } else if (engine == CRC_ENGINE_AUTO) {
+        engine = req->len >= CRC_DMA_MIN ? CRC_ENGINE_DMA : CRC_ENGINE_CPU;
+    }
+    if (engine == CRC_ENGINE_DMA) {
+        int ret = crc_dma_start(req);
+        if (ret == 0) {
+            return 0;
+        }
+        if (asked == CRC_ENGINE_DMA && ret != -ENODATA) {
+            req->status = ret;
+            crc.req = NULL;
+            return ret;
+        }
+        // MDMA busy with someone else's run or a few bytes, the CPU
+        // does this one
+        engine = CRC_ENGINE_CPU;
+    }
+
+    req->engine = (uint8_t)engine;
+    crc.start = DWT->CYCCNT;
+    if (engine == CRC_ENGINE_SW) {
+        req->crc = crc_sw_calc(&crc_sw, req->buf, req->len);
+    } else {
+        crc_hw_start(crc.cfg.init & crc.mask);
+        crc_hw_feed(req->buf, req->len);
+        req->crc = crc_hw_final(CRC->DR);
+    }
+    crc_finish(req, 0);
+    return 0;
+}
+
+static int crc_abort(void) {
+    crc_req_t *req = crc.req;
+
+    // Only a DMA run is ever left running
+    if (req != NULL && req->engine == CRC_ENGINE_DMA && req->status == -EINPROGRESS) {
+        return dev_mdma_get()->ioctrl(MDMA_ABORT, NULL);
+    }
+    return 0;
+}
+
+// Open CRC (interface implementation), the model is CRC-32
+static int crc_open(void) {
+    if (crc.initialized) {
+        return 0;
+    }
+    RCC->AHB4ENR |= RCC_AHB4ENR_CRCEN;
+    (void)RCC->AHB4ENR;
+
+    crc_sw_init(&crc_sw, &crc_models[0].cfg);
+    crc_apply(&crc_models[0].cfg);
+    memset(&crc.stats, 0, sizeof(crc.stats));
+    crc.req = NULL;
+    crc.initialized = 1;
+    return 0;
+}
+
+// Close CRC (interface implementation), a running CRC_CALC is cancelled
+static int crc_close(void) {
+    if (!crc.initialized) {
+        return 0;
+    }
+    crc_abort();
+    RCC->AHB4ENR &= ~RCC_AHB4ENR_CRCEN;
+    crc.initialized = 0;
+    return 0;
+}
+
+// Read from CRC (interface implementation) - the value of what write()
+// fed since the last reset, a uint32_t
+static int crc_read(void *buf, size_t count) {
+    uint32_t value;
+
+    if (!crc.initialized) {
+        return -ENODEV;
+    }
+    if (buf == NULL || count < sizeof(value)) {
+        return -EINVAL;
+    }
+    value = crc.hw ? crc_hw_final(crc.reg) : crc_sw_final(&crc_sw, crc.reg);
+    memcpy(buf, &value, sizeof(value));
+    return (int)sizeof(value);
+}
+
+// Write to CRC (interface implementation) - continues the running CRC,
+// the unit picks up from the register saved last time
+static int crc_write(const void *buf, size_t count) {
+    if (!crc.initialized) {
+        return -ENODEV;
+    }
+    if (buf == NULL && count) {
+        return -EINVAL;
+    }
+    if (crc.req != NULL) {
+        return -EBUSY;
+    }
+    if (crc.hw) {
+        crc_hw_start(crc.reg);
+        crc_hw_feed(buf, count);
+        crc.reg = CRC->DR;
+    } else {
+        crc.reg = crc_sw_update(&crc_sw, crc.reg, buf, count);
+    }
+    crc.stats.bytes += count;
+    return (int)count;
+}
+
+// IO Control for CRC
+static int crc_ioctrl(int cmd, void *arg) {
+    switch (cmd) {
+        case CRC_CALC:
+            if (arg == NULL) return -EINVAL;
+            return crc_calc((crc_req_t *)arg);
+
+        case CRC_ABORT:
+            if (!crc.initialized) return -ENODEV;
+            return crc_abort();
+
+        case CRC_BUSY:
+            if (arg == NULL) return -EINVAL;
+            *(int *)arg = crc.req != NULL;
+            return 0;
+
+        case INTERFACE_RESET:
+            if (!crc.initialized) return -ENODEV;
+            crc.reg = crc.hw ? crc.cfg.init & crc.mask : crc_sw_start(&crc_sw);
+            return 0;
+
+        case INTERFACE_SET_CONFIG: {
+            const crc_cfg_t *cfg = (const crc_cfg_t *)arg;
+            if (arg == NULL) return -EINVAL;
+            if (!crc.initialized) return -ENODEV;
+            if (crc.req != NULL) return -EBUSY;
+            if (crc_sw_init(&crc_sw, cfg) < 0) return -EINVAL;
+            crc_apply(cfg);
+            return 0;
+        }
+
+        case INTERFACE_GET_CONFIG:
+            if (arg == NULL) return -EINVAL;
+            *(crc_cfg_t *)arg = crc.cfg;
+            return 0;
+
+        case INTERFACE_GET_STATUS:
+            if (arg == NULL) return -EINVAL;
+            *(crc_stats_t *)arg = crc.stats;
+            return 0;
+
+        default:
+            return -ENOTSUP;
+    }
+}
+
+// CRC device instance
+static const interface_t dev_crc = {
+    .open = crc_open,
+    .close = crc_close,
+    .read = crc_read,
+    .write = crc_write,
+    .ioctrl = crc_ioctrl
+};
+
+// CRC device instance accessor
+interface_t* dev_crc_get(void) {
+    return (interface_t*)&dev_crc;
+}
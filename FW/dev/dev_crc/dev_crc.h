@@ -0,0 +1,113 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * dev_crc.h - CRC calculation unit for STM32H743
+ *
+ * Copyright (c) 2025 Michael Kaa
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef DEV_CRC_H
+#define DEV_CRC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "dev_interface.h"
+#include "crc_sw.h"
+
+// One model at a time, CRC-32 (zlib) after open. INTERFACE_SET_CONFIG
+// takes a crc_cfg_t. The unit does 7, 8, 16 and 32 bit widths with any
+// odd polynomial, other models run in software (crc_sw.c, slice-by-8).
+// Reflection and the final XOR are applied on the result, the unit only
+// reverses the input bytes.
+//
+// Two ways in:
+//  - write() feeds a running CRC, read() of 4 bytes gives its value as
+//    a uint32_t, INTERFACE_RESET starts over
+//  - CRC_CALC is one block: the CPU feeds the unit, or from
+//    CRC_DMA_MIN bytes on the MDMA does (dev_mdma, MDMA_FEED) and
+//    completion comes from its interrupt
+// The CPU writes aligned words byte swapped, so the unit sees the bytes
+// in memory order, the MDMA swaps the same way.
+
+// Shorter blocks aren't worth the MDMA setup and cache maintenance
+#define CRC_DMA_MIN         4096U
+
+// CRC-specific ioctrl commands
+#define CRC_CALC            (INTERFACE_CMD_DEVICE + 0) /* arg: crc_req_t*, -EBUSY while one runs */
+#define CRC_ABORT           (INTERFACE_CMD_DEVICE + 1) /* arg: NULL, done() gets -ECANCELED */
+#define CRC_BUSY            (INTERFACE_CMD_DEVICE + 2) /* arg: int*, 1 while a CRC_CALC runs */
+
+typedef enum crc_engine {
+    CRC_ENGINE_AUTO = 0,    // MDMA from CRC_DMA_MIN on and if it's free, else the CPU into the unit
+    CRC_ENGINE_SW,          // slice-by-8 tables
+    CRC_ENGINE_CPU,         // the CPU writes the unit
+    CRC_ENGINE_DMA,         // the MDMA writes the unit
+} crc_engine_t;
+
+// Names for the command line, NULL terminated
+extern const char *const crc_engine_names[];
+
+struct crc_req;
+
+// Called from the MDMA interrupt for a DMA run, otherwise before
+// CRC_CALC returns
+typedef void (*crc_done_t)(struct crc_req *req);
+
+/**
+ * struct crc_req - One block
+ * @buf: Data, anywhere the MDMA reaches (TCM included)
+ * @len: Bytes, up to MDMA_MAX_LEN for the MDMA
+ * @engine: crc_engine_t asked for, then the one that ran. A model the
+ *          unit can't do always runs in software
+ * @crc: The result
+ * @done: Completion callback, NULL to poll @status
+ * @ctx: For the caller
+ * @status: -EINPROGRESS while running, then 0 or negative errno
+ * @cycles: CPU clocks from the start to the result
+ */
+typedef struct crc_req {
+    const void *buf;
+    size_t len;
+    uint8_t engine;
+    uint32_t crc;
+    crc_done_t done;
+    void *ctx;
+    volatile int status;
+    volatile uint32_t cycles;
+} crc_req_t;
+
+/**
+ * struct crc_stats - Counters read by INTERFACE_GET_STATUS
+ * @calcs: CRC_CALC runs completed
+ * @dma: Of them, fed by the MDMA
+ * @errors: Runs that failed on a bus error
+ * @bytes: Through CRC_CALC and write()
+ */
+typedef struct crc_stats {
+    uint32_t calcs;
+    uint32_t dma;
+    uint32_t errors;
+    uint64_t bytes;
+} crc_stats_t;
+
+// Global CRC device instance accessor
+interface_t* dev_crc_get(void);
+
+#endif /* DEV_CRC_H */
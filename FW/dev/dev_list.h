@@ -28,6 +28,8 @@
 
 #include "dev_interface.h"
 
-#include "dev_uart1.h"
+#include "dev_uart.h"
+#include "dev_mdma.h"
+#include "dev_crc.h"
 
 #endif /* _DEV_LIST_H */
\ No newline at end of file
@@ -0,0 +1,463 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * dev_mdma.c - MDMA memory to memory copy and fill for STM32H743
+ *
+ * Copyright (c) 2025 Michael Kaa
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include "dev_mdma.h"
+#include "stm32h743xx.h"
+#include "cpuload.h"
+
+#define MDMA_CH           MDMA_Channel0
+#define MDMA_IRQ_PRIO     6U    // below the UARTs, a completion can wait
+
+// Nodes of one transfer: head, body blocks, body remainder, tail
+#define MDMA_NODES        4U
+
+// Block of the body, BNDT is 17 bit, BRC repeats it up to 4096 times
+#define MDMA_BLOCK        0x10000U
+
+// Larger ranges are cleaned by set/way, the D-cache is 16 KB
+#define MDMA_DCACHE_ALL   (64U * 1024U)
+
+#define DCACHE_LINE       (__SCB_DCACHE_LINE_SIZE)
+
+#define MDMA_CIFCR_ALL    (MDMA_CIFCR_CTEIF | MDMA_CIFCR_CCTCIF | MDMA_CIFCR_CBRTIF | MDMA_CIFCR_CBTIF | MDMA_CIFCR_CLTCIF)
+
+// Increment modes, CTCR SINC/DINC encoding
+#define MDMA_INC_FIXED    0U
+#define MDMA_INC_UP       2U
+
+/*
+ * Linked list item, the channel registers from CTCR to CMDR. MDMA
+ * fetches it over AXI, so the list lives in AXI SRAM, 8 byte aligned
+ */
+typedef struct mdma_node {
+    uint32_t ctcr;
+    uint32_t cbndtr;
+    uint32_t csar;
+    uint32_t cdar;
+    uint32_t cbrur;
+    uint32_t clar;
+    uint32_t ctbr;
+    uint32_t reserved;
+    uint32_t cmar;
+    uint32_t cmdr;
+} mdma_node_t;
+
+RAM_D1_DMA static mdma_node_t mdma_nodes[MDMA_NODES];
+
+// Fill source, the pattern twice for 64 bit beats
+RAM_D1_DMA static uint64_t mdma_pattern;
+
+static struct {
+    mdma_req_t *volatile req;
+    uint32_t start;
+    mdma_stats_t stats;
+    uint8_t initialized;
+} mdma;
+
+static inline uint32_t irq_lock(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    return primask;
+}
+
+static inline void irq_unlock(uint32_t primask) {
+    __set_PRIMASK(primask);
+}
+
+// TCM is only reachable over the AHBS port
+static uint32_t mdma_tcm(uint32_t addr) {
+    return (addr <= D1_ITCMRAM_BASE + 0xFFFFU) ||
+           (addr >= D1_DTCMRAM_BASE && addr <= D1_DTCMRAM_BASE + 0x1FFFFU);
+}
+
+// Flash and TCM are never cached dirty, peripherals are never cached
+static int mdma_cached(uint32_t addr) {
+    return addr >= D1_AXISRAM_BASE && addr < PERIPH_BASE;
+}
+
+// Write back the CPU's data before MDMA reads it
+static void dcache_clean(uint32_t addr, size_t len) {
+    uint32_t start = addr & ~(DCACHE_LINE - 1U);
+    uint32_t end = (addr + (uint32_t)len + DCACHE_LINE - 1U) & ~(DCACHE_LINE - 1U);
+
+    if (!mdma_cached(addr)) {
+        return;
+    }
+    if (len > MDMA_DCACHE_ALL) {
+        SCB_CleanDCache();
+    } else {
+        SCB_CleanDCache_by_Addr((uint32_t *)start, (int32_t)(end - start));
+    }
+}
+
+// Before the start nothing dirty may be evicted over what MDMA writes,
+// after the end the lines the CPU fetched meanwhile are stale. Lines
+// shared with other data are written back, see dev_mdma.h
+static void dcache_flush(uint32_t addr, size_t len) {
+    uint32_t start = addr & ~(DCACHE_LINE - 1U);
+    uint32_t end = (addr + (uint32_t)len + DCACHE_LINE - 1U) & ~(DCACHE_LINE - 1U);
+
+    if (!mdma_cached(addr)) {
+        return;
+    }
+    if (len > MDMA_DCACHE_ALL) {
+        SCB_CleanInvalidateDCache();
+    } else {
+        SCB_CleanInvalidateDCache_by_Addr((uint32_t *)start, (int32_t)(end - start));
+    }
+}
+
+// Largest beat, log2 of 1..8 bytes, both addresses are aligned to
+static uint32_t mdma_beat(uint32_t a) {
+    uint32_t lg = 3U;
+
+    while (lg && (a & ((1U << lg) - 1U))) {
+        lg--;
+    }
+    return lg;
+}
+
+// Longest burst up to 16 beats that keeps the start aligned to the
+// burst, so a burst never crosses the 1 KB AXI boundary
+static uint32_t mdma_burst(uint32_t a, uint32_t lg) {
+    uint32_t burst = 4U;
+
+    while (burst && (a & ((1U << (burst + lg)) - 1U))) {
+        burst--;
+    }
+    return burst;
+}
+
+// Append a node of @blocks blocks of @bytes each, beats of 1 << @lg.
+// A destination that doesn't move (@dinc 0) is a peripheral register:
+// single beats, each written through before the next
+static mdma_node_t *mdma_node(mdma_node_t *n, uint32_t sinc, uint32_t dinc, uint32_t src, uint32_t dst,
+                              uint32_t lg, uint32_t bytes, uint32_t blocks) {
+    uint32_t burst = mdma_burst((dinc ? dst : 0U) | (sinc ? src : 0U), lg);
+
+    n->ctcr = (dinc ? MDMA_CTCR_BWM : 0U) | MDMA_CTCR_SWRM | (3U << MDMA_CTCR_TRGM_Pos) |
+              (127U << MDMA_CTCR_TLEN_Pos) |
+              (burst << MDMA_CTCR_SBURST_Pos) | ((dinc ? burst : 0U) << MDMA_CTCR_DBURST_Pos) |
+              (lg << MDMA_CTCR_SINCOS_Pos) | (lg << MDMA_CTCR_DINCOS_Pos) |
+              (lg << MDMA_CTCR_SSIZE_Pos) | (lg << MDMA_CTCR_DSIZE_Pos) |
+              (dinc << MDMA_CTCR_DINC_Pos) | (sinc << MDMA_CTCR_SINC_Pos);
+    n->cbndtr = ((blocks - 1U) << MDMA_CBNDTR_BRC_Pos) | bytes;
+    n->csar = src;
+    n->cdar = dst;
+    n->cbrur = 0;   // blocks follow each other
+    n->clar = 0;
+    n->ctbr = (mdma_tcm(src) ? MDMA_CTBR_SBUS : 0U) | (mdma_tcm(dst) ? MDMA_CTBR_DBUS : 0U);
+    n->reserved = 0;
+    n->cmar = 0;
+    n->cmdr = 0;
+    if (n != mdma_nodes) {
+        n[-1].clar = (uint32_t)n;
+    }
+    return n + 1;
+}
+
+/*
+ * Split [dst, dst + len) into the head up to the beat alignment, the
+ * body in whole blocks and its remainder, and the tail. @edge is the
+ * beat of head and tail, a fill source doesn't move (@sinc 0).
+ * Returns the node count
+ */
+static uint32_t mdma_build(uint32_t sinc, uint32_t src, uint32_t dst, uint32_t len,
+                           uint32_t lg, uint32_t edge) {
+    mdma_node_t *n = mdma_nodes;
+    uint32_t unit = 1U << lg;
+    uint32_t head = (0U - dst) & (unit - 1U);
+    uint32_t inc = sinc ? 1U : 0U;
+
+    if (head > len) {
+        head = len;
+    }
+    uint32_t body = (len - head) & ~(unit - 1U);
+    uint32_t tail = len - head - body;
+    uint32_t blocks = body / MDMA_BLOCK;
+    uint32_t rest = body % MDMA_BLOCK;
+
+    if (head) {
+        n = mdma_node(n, sinc, MDMA_INC_UP, src, dst, edge, head, 1U);
+        src += head * inc;
+        dst += head;
+    }
+    if (blocks) {
+        n = mdma_node(n, sinc, MDMA_INC_UP, src, dst, lg, MDMA_BLOCK, blocks);
+        src += blocks * MDMA_BLOCK * inc;
+        dst += blocks * MDMA_BLOCK;
+    }
+    if (rest) {
+        n = mdma_node(n, sinc, MDMA_INC_UP, src, dst, lg, rest, 1U);
+        src += rest * inc;
+        dst += rest;
+    }
+    if (tail) {
+        n = mdma_node(n, sinc, MDMA_INC_UP, src, dst, edge, tail, 1U);
+    }
+    return (uint32_t)(n - mdma_nodes);
+}
+
+// Words of [src, src + len) into the register at @dst, whole blocks
+// and the remainder
+static void mdma_build_feed(uint32_t src, uint32_t dst, uint32_t len) {
+    mdma_node_t *n = mdma_nodes;
+    uint32_t blocks = len / MDMA_BLOCK;
+    uint32_t rest = len % MDMA_BLOCK;
+
+    if (blocks) {
+        n = mdma_node(n, MDMA_INC_UP, MDMA_INC_FIXED, src, dst, 2U, MDMA_BLOCK, blocks);
+        src += blocks * MDMA_BLOCK;
+    }
+    if (rest) {
+        mdma_node(n, MDMA_INC_UP, MDMA_INC_FIXED, src, dst, 2U, rest, 1U);
+    }
+}
+
+// Load the first node into the channel and fire the software request.
+// @ex: endianness exchange, for the whole list
+static void mdma_kick(mdma_req_t *req, uint32_t ex) {
+    const mdma_node_t *n = mdma_nodes;
+
+    dcache_clean((uint32_t)mdma_nodes, sizeof(mdma_nodes));
+    dcache_clean((uint32_t)&mdma_pattern, sizeof(mdma_pattern));
+    MDMA_CH->CIFCR = MDMA_CIFCR_ALL;
+    MDMA_CH->CTCR = n->ctcr;
+    MDMA_CH->CBNDTR = n->cbndtr;
+    MDMA_CH->CSAR = n->csar;
+    MDMA_CH->CDAR = n->cdar;
+    MDMA_CH->CBRUR = n->cbrur;
+    MDMA_CH->CLAR = n->clar;
+    MDMA_CH->CTBR = n->ctbr;
+    MDMA_CH->CCR = ex | MDMA_CCR_PL_1 | MDMA_CCR_CTCIE | MDMA_CCR_TEIE | MDMA_CCR_EN;
+
+    req->status = -EINPROGRESS;
+    req->cycles = 0;
+    mdma.req = req;
+    mdma.start = DWT->CYCCNT;
+    MDMA_CH->CCR |= MDMA_CCR_SWRQ;
+}
+
+static int mdma_start(mdma_req_t *req, int cmd) {
+    int fill = (cmd == MDMA_FILL);
+    uint32_t dst = (uint32_t)req->dst;
+    uint32_t src = fill ? (uint32_t)&mdma_pattern : (uint32_t)req->src;
+    uint32_t len = (uint32_t)req->len;
+    uint32_t ex = 0;
+    uint32_t lg;
+    uint32_t edge;
+
+    if (!mdma.initialized) {
+        return -ENODEV;
+    }
+    if (len == 0 || req->len > MDMA_MAX_LEN || (!fill && req->src == NULL)) {
+        return -EINVAL;
+    }
+    if (cmd == MDMA_FEED && ((src | len) & 3U)) {
+        return -EINVAL;
+    }
+
+    uint32_t primask = irq_lock();
+    if (mdma.req != NULL) {
+        irq_unlock(primask);
+        return -EBUSY;
+    }
+    mdma.req = req;     // claimed, mdma_kick() starts it
+    irq_unlock(primask);
+
+    if (cmd == MDMA_FEED) {
+        dcache_clean(src, len);
+        mdma_build_feed(src, dst, len);
+        // Bytes within halfwords and halfwords within the word
+        ex = req->swap ? (MDMA_CCR_BEX | MDMA_CCR_HEX) : 0U;
+        mdma_kick(req, ex);
+        return 0;
+    }
+    if (fill) {
+        uint32_t p = req->pattern;
+        int bytewise = (p == (p & 0xFFU) * 0x01010101U);
+
+        if (!bytewise && ((dst | len) & 3U)) {
+            mdma.req = NULL;
+            return -EINVAL;
+        }
+        // A repeated byte has no phase, a word pattern starts on a word
+        mdma_pattern = ((uint64_t)p << 32) | p;
+        lg = 3U;
+        edge = bytewise ? 0U : 2U;
+    } else {
+        lg = mdma_beat(src ^ dst);
+        edge = 0U;
+        dcache_clean(src, len);
+    }
+    dcache_flush(dst, len);
+    mdma_build(fill ? MDMA_INC_FIXED : MDMA_INC_UP, src, dst, len, lg, edge);
+    mdma_kick(req, ex);
+    return 0;
+}
+
+// Completion, from the interrupt or an abort
+static void mdma_finish(int status) {
+    mdma_req_t *req = mdma.req;
+
+    if (req == NULL) {
+        return;
+    }
+    req->cycles = DWT->CYCCNT - mdma.start;
+    dcache_flush((uint32_t)req->dst, req->len);
+    if (status == 0) {
+        mdma.stats.transfers++;
+        mdma.stats.bytes += req->len;
+    } else if (status == -EIO) {
+        mdma.stats.errors++;
+    }
+    mdma.req = NULL;
+    req->status = status;
+    if (req->done) {
+        req->done(req);
+    }
+}
+
+static void mdma_stop(void) {
+    MDMA_CH->CCR &= ~MDMA_CCR_EN;
+    while (MDMA_CH->CCR & MDMA_CCR_EN);
+    MDMA_CH->CIFCR = MDMA_CIFCR_ALL;
+}
+
+static int mdma_abort(void) {
+    NVIC_DisableIRQ(MDMA_IRQn);
+    mdma_stop();
+    NVIC_ClearPendingIRQ(MDMA_IRQn);
+    mdma_finish(-ECANCELED);
+    NVIC_EnableIRQ(MDMA_IRQn);
+    return 0;
+}
+
+// Open MDMA (interface implementation)
+static int mdma_open(void) {
+    if (mdma.initialized) {
+        return 0;
+    }
+    RCC->AHB3ENR |= RCC_AHB3ENR_MDMAEN;
+    (void)RCC->AHB3ENR;
+
+    mdma_stop();
+    memset(&mdma.stats, 0, sizeof(mdma.stats));
+    mdma.req = NULL;
+    NVIC_SetPriority(MDMA_IRQn, MDMA_IRQ_PRIO);
+    NVIC_EnableIRQ(MDMA_IRQn);
+    mdma.initialized = 1;
+    return 0;
+}
+
+// Close MDMA (interface implementation), a running transfer is cancelled
+static int mdma_close(void) {
+    if (!mdma.initialized) {
+        return 0;
+    }
+    mdma_abort();
+    NVIC_DisableIRQ(MDMA_IRQn);
+    RCC->AHB3ENR &= ~RCC_AHB3ENR_MDMAEN;
+    mdma.initialized = 0;
+    return 0;
+}
+
+// Read from MDMA (interface implementation) - not supported
+static int mdma_read(void *buf, size_t count) {
+    (void)(buf);
+    (void)(count);
+    return -ENOTSUP;
+}
+
+// Write to MDMA (interface implementation) - not supported
+static int mdma_write(const void *buf, size_t count) {
+    (void)(buf);
+    (void)(count);
+    return -ENOTSUP;
+}
+
+// IO Control for MDMA
+static int mdma_ioctrl(int cmd, void *arg) {
+    switch (cmd) {
+        case MDMA_COPY:
+        case MDMA_FILL:
+        case MDMA_FEED:
+            if (arg == NULL) return -EINVAL;
+            return mdma_start((mdma_req_t *)arg, cmd);
+
+        case MDMA_ABORT:
+            if (!mdma.initialized) return -ENODEV;
+            return mdma_abort();
+
+        case MDMA_BUSY:
+            if (arg == NULL) return -EINVAL;
+            *(int *)arg = mdma.req != NULL;
+            return 0;
+
+        case INTERFACE_GET_STATUS:
+            if (arg == NULL) return -EINVAL;
+            *(mdma_stats_t *)arg = mdma.stats;
+            return 0;
+
+        default:
+            return -ENOTSUP;
+    }
+}
+
+static void mdma_irq(void) {
+    uint32_t isr = MDMA_CH->CISR;
+
+    if (isr & MDMA_CISR_TEIF) {
+        mdma_stop();
+        mdma_finish(-EIO);
+        return;
+    }
+    MDMA_CH->CIFCR = MDMA_CIFCR_ALL;
+    if (isr & MDMA_CISR_CTCIF) {
+        mdma_finish(0);
+    }
+}
+
+void MDMA_IRQHandler(void) {
+    CPULOAD_IRQ_ENTER();
+    mdma_irq();
+    CPULOAD_IRQ_EXIT();
+}
+
+// MDMA device instance
+static const interface_t dev_mdma = {
+    .open = mdma_open,
+    .close = mdma_close,
+    .read = mdma_read,
+    .write = mdma_write,
+    .ioctrl = mdma_ioctrl
+};
+
+// MDMA device instance accessor
+interface_t* dev_mdma_get(void) {
+    return (interface_t*)&dev_mdma;
+}
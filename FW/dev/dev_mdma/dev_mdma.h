@@ -0,0 +1,105 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * dev_mdma.h - MDMA memory to memory copy and fill for STM32H743
+ *
+ * Copyright (c) 2025 Michael Kaa
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef DEV_MDMA_H
+#define DEV_MDMA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "dev_interface.h"
+
+// One transfer at a time on MDMA channel 0. A transfer is a linked list
+// of up to four nodes: an unaligned byte head, the aligned body in 64 KB
+// blocks, its remainder and a byte tail. The whole list runs on a single
+// software request, the CPU is free until the completion interrupt.
+//
+// MDMA reaches every memory, TCM included (over the AHBS port). Cached
+// ranges are kept coherent: the source is cleaned before the start and
+// the destination invalidated at the end. Lines the destination shares
+// with other data are cleaned and invalidated, so keep the destination
+// of a transfer 32 byte aligned if the CPU writes next to it meanwhile.
+//
+// MDMA_FEED streams words into one peripheral data register (the CRC
+// unit), the destination doesn't move and nothing is cached there.
+
+// Largest transfer, 4096 blocks of 64 KB
+#define MDMA_MAX_LEN        (256U * 1024U * 1024U)
+
+// MDMA-specific ioctrl commands
+#define MDMA_COPY           (INTERFACE_CMD_DEVICE + 0) /* arg: mdma_req_t*, -EBUSY if a transfer runs */
+#define MDMA_FILL           (INTERFACE_CMD_DEVICE + 1) /* arg: mdma_req_t*, src unused, pattern repeats */
+#define MDMA_ABORT          (INTERFACE_CMD_DEVICE + 2) /* arg: NULL, done() gets -ECANCELED */
+#define MDMA_BUSY           (INTERFACE_CMD_DEVICE + 3) /* arg: int*, 1 while a transfer runs */
+#define MDMA_FEED           (INTERFACE_CMD_DEVICE + 4) /* arg: mdma_req_t*, words of src to the register dst */
+
+struct mdma_req;
+
+// Called from the MDMA interrupt: 0, -EIO on a bus error or -ECANCELED
+typedef void (*mdma_done_t)(struct mdma_req *req);
+
+/**
+ * struct mdma_req - One copy, fill or feed
+ * @dst: Destination
+ * @src: Source of MDMA_COPY
+ * @pattern: Word MDMA_FILL repeats from @dst on, must be a repeated byte
+ *           (0x5a5a5a5a) unless @dst and @len are 4 byte aligned
+ * @len: Bytes, up to MDMA_MAX_LEN. MDMA_FEED: @src and @len 4 byte aligned
+ * @swap: MDMA_FEED writes each word byte swapped, the first byte in
+ *        memory becomes the most significant one
+ * @done: Completion callback, NULL to poll @status
+ * @ctx: For the caller
+ * @status: -EINPROGRESS while running, then the result passed to @done
+ * @cycles: CPU clocks from the start to the completion interrupt
+ *
+ * The driver holds the request until completion, it must stay valid.
+ */
+typedef struct mdma_req {
+    void *dst;
+    const void *src;
+    uint32_t pattern;
+    size_t len;
+    uint8_t swap;
+    mdma_done_t done;
+    void *ctx;
+    volatile int status;
+    volatile uint32_t cycles;
+} mdma_req_t;
+
+/**
+ * struct mdma_stats - Counters read by INTERFACE_GET_STATUS
+ * @transfers: Completed without error
+ * @errors: Bus errors
+ * @bytes: Moved by completed transfers
+ */
+typedef struct mdma_stats {
+    uint32_t transfers;
+    uint32_t errors;
+    uint64_t bytes;
+} mdma_stats_t;
+
+// Global MDMA device instance accessor
+interface_t* dev_mdma_get(void);
+
+#endif /* DEV_MDMA_H */
@@ -0,0 +1,1199 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * dev_uart.c - POSIX-style USART/DMA interface implementation for STM32H743
+ *
+ * Generic driver, every port is described by a const uart_port_t
+ * (see dev_uart_ports.c), all runtime data lives in its uart_state_t.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include "dev_uart.h"
+#include "inc/dev_uart_port.h"
+#include "stm32h743xx.h"
+
+#define TX_TIMEOUT (10000000U)
+
+// WFI wakeups (1 ms tick at least) a TX wait allows without progress
+#define TX_STALL_WAKEUPS  (5000U)
+
+// Max bytes per DMA burst (NDTR is 16 bit)
+#define TX_DMA_MAX_XFER   (0xFFFFU)
+#define TX_QUEUE_MASK     (UART_TX_QUEUE_LEN - 1U)
+
+#if (UART_TX_QUEUE_LEN & (UART_TX_QUEUE_LEN - 1U)) != 0
+#error "UART_TX_QUEUE_LEN must be a power of two"
+#endif
+
+#if (UART_RX_BUFFER_SIZE & (UART_RX_BUFFER_SIZE - 1U)) != 0
+#error "UART_RX_BUFFER_SIZE must be a power of two"
+#endif
+
+// DMA buffers are invalidated by whole cache lines
+#define DCACHE_LINE       (__SCB_DCACHE_LINE_SIZE)
+
+#if (UART_RX_BUFFER_SIZE % __SCB_DCACHE_LINE_SIZE) != 0 || (UART_TX_BUFFER_SIZE % __SCB_DCACHE_LINE_SIZE) != 0
+#error "UART buffers must be a multiple of the cache line"
+#endif
+
+static int uart_available(const uart_port_t *port);
+static int uart_init(const uart_port_t *port);
+static int uart_deinit(const uart_port_t *port);
+static int uart_set_baudrate(const uart_port_t *port, uint32_t baudrate);
+static void uart_rts_update(const uart_port_t *port, uint32_t pending);
+
+static inline uint32_t irq_lock(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    return primask;
+}
+
+static inline void irq_unlock(uint32_t primask) {
+    __set_PRIMASK(primask);
+}
+
+static inline uint32_t dma_flags(const uart_dma_t *dma) {
+    return (*dma->isr >> dma->shift) & UART_DMA_ALL;
+}
+
+static inline void dma_clear(const uart_dma_t *dma, uint32_t flags) {
+    *dma->ifcr = flags << dma->shift;
+}
+
+static void dma_stop(const uart_dma_t *dma) {
+    dma->stream->CR &= ~DMA_SxCR_EN;
+    while (dma->stream->CR & DMA_SxCR_EN);
+}
+
+// Write back CPU data before DMA reads it. Safe on any buffer, lines
+// shared with other data are only written back, never dropped
+static void dcache_clean(const void *buf, size_t len) {
+    uint32_t start = (uint32_t)buf & ~(DCACHE_LINE - 1U);
+    uint32_t end = ((uint32_t)buf + (uint32_t)len + DCACHE_LINE - 1U) & ~(DCACHE_LINE - 1U);
+
+    // Flash and TCM are never cached dirty
+    if (start >= D1_AXISRAM_BASE) {
+        SCB_CleanDCache_by_Addr((uint32_t *)start, (int32_t)(end - start));
+    }
+}
+
+// Drop stale lines before the CPU reads what DMA wrote. Only for
+// RAM_D1_DMA buffers: the range is rounded out to whole lines
+static void dcache_invalidate(volatile const void *buf, size_t len) {
+    uint32_t start = (uint32_t)buf & ~(DCACHE_LINE - 1U);
+    uint32_t end = ((uint32_t)buf + (uint32_t)len + DCACHE_LINE - 1U) & ~(DCACHE_LINE - 1U);
+
+    SCB_InvalidateDCache_by_Addr((void *)start, (int32_t)(end - start));
+}
+
+// Open UART (interface implementation)
+int uart_port_open(const uart_port_t *port) {
+    if (!port->state->initialized) {
+        return uart_init(port);
+    }
+    return 0;
+}
+
+// Close UART (interface implementation)
+int uart_port_close(const uart_port_t *port) {
+    return uart_deinit(port);
+}
+
+// DMA1/DMA2 can't reach the TCM memories, everything else is fine
+static int uart_dma_reachable(const void *buf, size_t count) {
+    uint32_t start = (uint32_t)buf;
+    uint32_t end = start + (uint32_t)count - 1U;
+
+    if (start <= (D1_ITCMRAM_BASE + 0xFFFFU)) {
+        return 0;
+    }
+    if ((end >= D1_DTCMRAM_BASE) && (start <= (D1_DTCMRAM_BASE + 0x1FFFFU))) {
+        return 0;
+    }
+    return 1;
+}
+
+// Start next DMA burst from the tail descriptor (irq locked or ISR context)
+static void uart_tx_start(const uart_port_t *port) {
+    uart_state_t *st = port->state;
+    const uart_tx_desc_t *desc = &st->tx_queue[st->tx_tail & TX_QUEUE_MASK];
+    uint32_t chunk = (uint32_t)desc->len - st->tx_offset;
+
+    if (chunk > TX_DMA_MAX_XFER) {
+        chunk = TX_DMA_MAX_XFER;
+    }
+
+    // Stream is disabled by hardware after TC, but be sure after abort
+    dma_stop(&port->dma_tx);
+
+    port->dma_tx.stream->M0AR = (uint32_t)desc->buf + st->tx_offset;
+    port->dma_tx.stream->NDTR = chunk;
+    st->tx_chunk = chunk;
+    st->tx_in_progress = 1;
+
+    dma_clear(&port->dma_tx, UART_DMA_ALL);
+    port->dma_tx.stream->CR |= DMA_SxCR_EN;
+}
+
+// Put descriptor into TX ring, kick DMA if idle
+static int uart_tx_queue(const uart_port_t *port, const uart_tx_desc_t *desc) {
+    uart_state_t *st = port->state;
+
+    if (desc == NULL || desc->buf == NULL || desc->len == 0) {
+        return -EINVAL;
+    }
+
+    if (!st->initialized) {
+        return -ENODEV;
+    }
+
+    if (!uart_dma_reachable(desc->buf, desc->len)) {
+        return -EFAULT;
+    }
+
+    // DMA reads memory, not the D-cache
+    dcache_clean(desc->buf, desc->len);
+
+    uint32_t primask = irq_lock();
+    if ((st->tx_head - st->tx_tail) >= UART_TX_QUEUE_LEN) {
+        irq_unlock(primask);
+        return -EAGAIN;
+    }
+
+    st->tx_queue[st->tx_head & TX_QUEUE_MASK] = *desc;
+    st->tx_head++;
+
+    if (!st->tx_in_progress) {
+        uart_tx_start(port);
+    }
+    irq_unlock(primask);
+
+    return 0;
+}
+
+// Progress seen by a TX wait: any byte moved restarts the stall count
+typedef struct {
+    uint32_t bytes;
+    uint32_t ndtr;
+    uint32_t stalls;
+} uart_tx_watch_t;
+
+/*
+ * One step of a TX wait, called irq locked with the caller's PRIMASK.
+ * Interrupts enabled: sleep in WFI and let the pending ISRs run.
+ * Masked by the caller: the ISR would never run, so the TX handler is
+ * called from here after each wakeup. Another pending interrupt keeps
+ * WFI from sleeping then, hence the larger TX_TIMEOUT bound.
+ * -ETIMEDOUT once the line has not moved for that many wakeups,
+ * e.g. CTS held by the peer.
+ */
+static int uart_tx_sleep(const uart_port_t *port, uart_tx_watch_t *w, uint32_t primask) {
+    uint32_t bytes = port->state->stats.tx_bytes;
+    uint32_t ndtr = port->dma_tx.stream->NDTR;
+
+    if (bytes != w->bytes || ndtr != w->ndtr) {
+        w->bytes = bytes;
+        w->ndtr = ndtr;
+        w->stalls = 0;
+    } else if (++w->stalls > (primask ? TX_TIMEOUT : TX_STALL_WAKEUPS)) {
+        return -ETIMEDOUT;
+    }
+
+    if (primask) {
+        // The stream interrupt still wakes WFI, its handler runs here
+        __WFI();
+        NVIC_ClearPendingIRQ(port->dma_tx.irq);
+        uart_port_dma_tx_irq(port);
+    } else {
+        // Pending interrupt wakes WFI even with PRIMASK set
+        __WFI();
+        irq_unlock(primask);
+        (void)irq_lock();
+    }
+    return 0;
+}
+
+// Give up on a stalled ring: stop the stream and complete every queued
+// descriptor unsent, so no waiter keeps a stack buffer queued (irq locked)
+static void uart_tx_abort(const uart_port_t *port) {
+    uart_state_t *st = port->state;
+    uint32_t head = st->tx_head;
+
+    dma_stop(&port->dma_tx);
+    dma_clear(&port->dma_tx, UART_DMA_ALL);
+    st->tx_offset = 0;
+    st->stats.tx_aborts++;
+
+    // tx_in_progress stays set, a callback queueing again must not
+    // start a descriptor that is being dropped
+    while (st->tx_tail != head) {
+        uart_tx_desc_t desc = st->tx_queue[st->tx_tail & TX_QUEUE_MASK];
+        st->tx_tail++;
+        if (desc.done != NULL) {
+            desc.done(desc.ctx);
+        }
+    }
+
+    if (st->tx_tail != st->tx_head) {
+        uart_tx_start(port);
+    } else {
+        st->tx_in_progress = 0;
+    }
+}
+
+// Queue descriptor, wait for free slot if ring is full
+static int uart_tx_queue_wait(const uart_port_t *port, const uart_tx_desc_t *desc) {
+    uart_tx_watch_t watch = {0};
+    int ret;
+
+    uint32_t primask = irq_lock();
+    while ((ret = uart_tx_queue(port, desc)) == -EAGAIN) {
+        if (uart_tx_sleep(port, &watch, primask) < 0) {
+            uart_tx_abort(port);
+            ret = -ETIMEDOUT;
+            break;
+        }
+    }
+    irq_unlock(primask);
+
+    return ret;
+}
+
+// Wait for a completion callback to set *flag to value
+static int uart_tx_wait(const uart_port_t *port, volatile uint8_t *flag, uint8_t value) {
+    uart_tx_watch_t watch = {0};
+    int ret = 0;
+
+    uint32_t primask = irq_lock();
+    while (*flag != value) {
+        if (uart_tx_sleep(port, &watch, primask) < 0) {
+            uart_tx_abort(port);
+            ret = -ETIMEDOUT;
+            break;
+        }
+    }
+    irq_unlock(primask);
+
+    return ret;
+}
+
+static void uart_tx_done_flag(void *ctx) {
+    *(volatile uint8_t *)ctx = 1;
+}
+
+static void uart_tx_bounce_done(void *ctx) {
+    ((uart_state_t *)ctx)->tx_bounce_busy = 0;
+}
+
+// Caller buffer is not DMA reachable, send it through the bounce buffer
+static int uart_write_bounce(const uart_port_t *port, const uint8_t *src, size_t count) {
+    uart_state_t *st = port->state;
+    size_t sent = 0;
+
+    while (sent < count) {
+        // Wait for previous bounce transmission to complete
+        int ret = uart_tx_wait(port, &st->tx_bounce_busy, 0);
+        if (ret < 0) {
+            return sent ? (int)sent : ret;
+        }
+
+        size_t chunk = count - sent;
+        if (chunk > port->tx_size) {
+            chunk = port->tx_size;
+        }
+
+        memcpy(port->tx_buf, src + sent, chunk);
+        st->tx_bounce_busy = 1;
+
+        uart_tx_desc_t desc = {
+            .buf = port->tx_buf,
+            .len = chunk,
+            .done = uart_tx_bounce_done,
+            .ctx = st,
+        };
+        ret = uart_tx_queue_wait(port, &desc);
+        if (ret < 0) {
+            st->tx_bounce_busy = 0;
+            return sent ? (int)sent : ret;
+        }
+
+        sent += chunk;
+    }
+
+    return (int)sent;
+}
+
+// Write data to UART (interface implementation)
+int uart_port_write(const uart_port_t *port, const void *buf, size_t count) {
+    if (buf == NULL || count == 0) {
+        return -EINVAL;
+    }
+
+    if (!port->state->initialized) {
+        return -ENODEV;
+    }
+
+    if (!uart_dma_reachable(buf, count)) {
+        return uart_write_bounce(port, (const uint8_t *)buf, count);
+    }
+
+    // Zero-copy: DMA reads the caller buffer, so hold the caller until done
+    volatile uint8_t done = 0;
+    uart_tx_desc_t desc = {
+        .buf = buf,
+        .len = count,
+        .done = uart_tx_done_flag,
+        .ctx = (void *)&done,
+    };
+
+    int ret = uart_tx_queue_wait(port, &desc);
+    if (ret < 0) {
+        return ret;
+    }
+
+    // Descriptor references our stack, it must not outlive this call:
+    // on a stall the ring is aborted, which completes it
+    ret = uart_tx_wait(port, &done, 1);
+    if (ret < 0) {
+        return ret;
+    }
+
+    return (int)count;
+}
+
+// Publish DMA write position (ISR context or irq locked).
+// DMA writes the ring circularly, the write position is kept as a
+// free running byte count (wraps * size + index)
+static void uart_rx_update(const uart_port_t *port) {
+    uart_state_t *st = port->state;
+    uint32_t idx = (port->rx_size - port->dma_rx.stream->NDTR) & (port->rx_size - 1U);
+
+    // HT/TC guarantee an update at least twice a lap, so going
+    // backwards means exactly one wrap
+    if (idx < st->rx_last_idx) {
+        st->rx_wraps++;
+        st->stats.rx_wraps++;
+    }
+    st->rx_last_idx = idx;
+
+    uint32_t head = st->rx_wraps * port->rx_size + idx;
+    if (head != st->rx_head) {
+        uint32_t fill = head - st->rx_tail;
+
+        st->stats.rx_bytes += head - st->rx_head;
+        if (fill > st->stats.rx_peak) {
+            st->stats.rx_peak = (fill > port->rx_size) ? port->rx_size : fill;
+        }
+
+        st->rx_head = head;
+        uart_rts_update(port, fill);
+        if (st->rx_notify.fn != NULL) {
+            st->rx_notify.fn(st->rx_notify.ctx);
+        }
+    }
+}
+
+// Bytes ready for reader, drops the overwritten lap on overrun (irq locked)
+static uint32_t uart_rx_pending(const uart_port_t *port) {
+    uart_state_t *st = port->state;
+    uint32_t pending = st->rx_head - st->rx_tail;
+
+    if (pending > port->rx_size) {
+        st->rx_tail = st->rx_head - port->rx_size;
+        st->stats.rx_overruns++;
+        pending = port->rx_size;
+    }
+
+    return pending;
+}
+
+// Read data from UART (interface implementation)
+int uart_port_read(const uart_port_t *port, void *buf, size_t count) {
+    uart_state_t *st = port->state;
+
+    if (buf == NULL) {
+        return -EINVAL;
+    }
+
+    if (!st->initialized) {
+        return -ENODEV;
+    }
+
+    uint8_t *buffer = (uint8_t *)buf;
+    uint32_t pending;
+
+    // Pick up bytes not yet announced by IDLE/HT/TC, sleep if allowed
+    uint32_t primask = irq_lock();
+    for (;;) {
+        uart_rx_update(port);
+        pending = uart_rx_pending(port);
+        if (pending || !st->rx_blocking || count == 0) {
+            break;
+        }
+        // Pending interrupt wakes WFI even with PRIMASK set
+        __WFI();
+        irq_unlock(primask);
+        primask = irq_lock();
+    }
+    uint32_t tail = st->rx_tail;
+    irq_unlock(primask);
+
+    if (count > pending) {
+        count = pending;
+    }
+
+    // At most two segments: up to the end of the ring and from its start
+    uint32_t idx = tail & (port->rx_size - 1U);
+    size_t first = port->rx_size - idx;
+    if (first > count) {
+        first = count;
+    }
+
+    // DMA wrote behind the D-cache, drop lines of the range we read
+    if (first) {
+        dcache_invalidate(port->rx_buf + idx, first);
+    }
+    if (count > first) {
+        dcache_invalidate(port->rx_buf, count - first);
+    }
+
+    memcpy(buffer, (const uint8_t *)port->rx_buf + idx, first);
+    memcpy(buffer + first, (const uint8_t *)port->rx_buf, count - first);
+
+    st->rx_tail = tail + (uint32_t)count;
+
+    // Reader made room, let the sender go again
+    if (st->rts_off) {
+        primask = irq_lock();
+        uart_rts_update(port, st->rx_head - st->rx_tail);
+        irq_unlock(primask);
+    }
+
+    return (int)count;
+}
+
+// Check how many bytes are available to read
+static int uart_available(const uart_port_t *port) {
+    if (!port->state->initialized) {
+        return 0;
+    }
+
+    uint32_t primask = irq_lock();
+    uart_rx_update(port);
+    uint32_t pending = uart_rx_pending(port);
+    irq_unlock(primask);
+
+    return (int)pending;
+}
+
+static void uart_rx_reset(uart_state_t *st) {
+    st->rx_head = 0;
+    st->rx_tail = 0;
+    st->rx_wraps = 0;
+    st->rx_last_idx = 0;
+}
+
+static void uart_tx_reset(uart_state_t *st) {
+    st->tx_head = 0;
+    st->tx_tail = 0;
+    st->tx_offset = 0;
+    st->tx_in_progress = 0;
+    st->tx_bounce_busy = 0;
+}
+
+// Flush RX buffer
+static int uart_flush(const uart_port_t *port) {
+    const uart_dma_t *dma = &port->dma_rx;
+
+    if (!port->state->initialized) {
+        return -ENODEV;
+    }
+
+    // Disable DMA stream
+    dma_stop(dma);
+
+    // Reset buffer position
+    uart_rx_reset(port->state);
+    uart_rts_update(port, 0);
+    dcache_invalidate(port->rx_buf, port->rx_size);
+
+    // Reconfigure DMA stream
+    dma->stream->M0AR = (uint32_t)port->rx_buf;
+    dma->stream->NDTR = port->rx_size;
+
+    // Clear all flags
+    dma_clear(dma, UART_DMA_ALL);
+
+    // Enable DMA stream
+    dma->stream->CR |= DMA_SxCR_EN;
+
+    return 0;
+}
+
+// Configure pin as alternate function
+static void uart_pin_init(const uart_pin_t *p) {
+    uint32_t pos2 = (uint32_t)p->pin * 2U;
+    uint32_t pos4 = ((uint32_t)p->pin & 7U) * 4U;
+
+    // GPIO ports are 0x400 apart starting at GPIOA
+    RCC->AHB4ENR |= 1UL << (((uint32_t)p->gpio - GPIOA_BASE) / 0x400U);
+
+    p->gpio->MODER &= ~(3UL << pos2);
+    p->gpio->MODER |= 2UL << pos2;
+
+    p->gpio->AFR[p->pin >> 3] &= ~(0xFUL << pos4);
+    p->gpio->AFR[p->pin >> 3] |= (uint32_t)p->af << pos4;
+
+    p->gpio->OTYPER &= ~(1UL << p->pin);
+    p->gpio->OSPEEDR &= ~(3UL << pos2);
+    p->gpio->OSPEEDR |= 2UL << pos2;   // High speed for multi-megabaud edges
+    p->gpio->PUPDR &= ~(3UL << pos2);
+}
+
+// Return a flow control pin to input (floating)
+static void uart_pin_release(const uart_pin_t *p) {
+    p->gpio->MODER &= ~(3UL << ((uint32_t)p->pin * 2U));
+}
+
+// Software RTS: hold the sender off while the ring is above the high
+// watermark, release it below the low one (ISR context or irq locked).
+// RTS is active low
+static void uart_rts_update(const uart_port_t *port, uint32_t pending) {
+    uart_state_t *st = port->state;
+    const uart_pin_t *p = &port->rts_pin;
+
+    if (!st->rts_soft) {
+        return;
+    }
+
+    if (!st->rts_off && pending >= st->rts_high) {
+        p->gpio->BSRR = 1UL << p->pin;
+        st->rts_off = 1;
+        st->stats.rts_throttles++;
+    } else if (st->rts_off && pending <= st->rts_low) {
+        p->gpio->BSRR = 1UL << (p->pin + 16U);
+        st->rts_off = 0;
+    }
+}
+
+// Drive RTS as GPIO output, asserted
+static void uart_rts_soft_init(const uart_port_t *port) {
+    const uart_pin_t *p = &port->rts_pin;
+    uint32_t pos2 = (uint32_t)p->pin * 2U;
+
+    uart_pin_init(p);
+    p->gpio->BSRR = 1UL << (p->pin + 16U);
+    p->gpio->MODER &= ~(3UL << pos2);
+    p->gpio->MODER |= 1UL << pos2;
+}
+
+// Apply flow control and FIFO setting from st->config (UE = 0)
+static void uart_line_config(const uart_port_t *port, const uart_config_t *prev) {
+    uart_state_t *st = port->state;
+    const uart_config_t *cfg = &st->config;
+    USART_TypeDef *usart = port->usart;
+
+    usart->CR1 &= ~USART_CR1_FIFOEN;
+    usart->CR3 &= ~(USART_CR3_RTSE | USART_CR3_CTSE | USART_CR3_TXFTCFG | USART_CR3_RXFTCFG);
+
+    if (cfg->fifo) {
+        usart->CR3 |= ((uint32_t)cfg->tx_threshold << USART_CR3_TXFTCFG_Pos) |
+                      ((uint32_t)cfg->rx_threshold << USART_CR3_RXFTCFG_Pos);
+        usart->CR1 |= USART_CR1_FIFOEN;
+    }
+
+    // Pins dropped from the configuration go back to input
+    if (prev != NULL) {
+        if ((prev->flow & uart_flow_rts) && !(cfg->flow & uart_flow_rts)) {
+            uart_pin_release(&port->rts_pin);
+        }
+        if ((prev->flow & uart_flow_cts) && !(cfg->flow & uart_flow_cts)) {
+            uart_pin_release(&port->cts_pin);
+        }
+    }
+
+    if (cfg->flow & uart_flow_cts) {
+        uart_pin_init(&port->cts_pin);
+        usart->CR3 |= USART_CR3_CTSE;
+    }
+
+    st->rts_soft = 0;
+    st->rts_off = 0;
+    if (cfg->flow & uart_flow_rts) {
+        if (cfg->rts_soft) {
+            // USART RTS only reflects its own FIFO, DMA always drains it
+            st->rts_high = cfg->rts_high ? cfg->rts_high : port->rx_size / 4U;
+            st->rts_low = cfg->rts_low ? cfg->rts_low : port->rx_size / 8U;
+            uart_rts_soft_init(port);
+            st->rts_soft = 1;
+        } else {
+            uart_pin_init(&port->rts_pin);
+            usart->CR3 |= USART_CR3_RTSE;
+        }
+    }
+}
+
+// Configure DMA stream and its DMAMUX channel
+static void uart_dma_init(const uart_dma_t *dma, uint32_t dir, uint32_t circ) {
+    RCC->AHB1ENR |= dma->rcc_en;
+
+    dma_stop(dma);
+
+    dma->mux->CCR &= ~DMAMUX_CxCR_DMAREQ_ID;
+    dma->mux->CCR |= dma->request;
+
+    // DMA Stream configuration
+    dma->stream->CR &= ~(DMA_SxCR_DIR | DMA_SxCR_PL | DMA_SxCR_CIRC | DMA_SxCR_PINC | DMA_SxCR_MINC |
+                         DMA_SxCR_PSIZE | DMA_SxCR_MSIZE | DMA_SxCR_PFCTRL |
+                         DMA_SxCR_TCIE | DMA_SxCR_HTIE | DMA_SxCR_TEIE);
+    dma->stream->CR |= (dir << DMA_SxCR_DIR_Pos) |     // Direction
+                       (0x0U << DMA_SxCR_PL_Pos) |     // Low priority
+                       circ |                          // Circular mode for RX
+                       DMA_SxCR_MINC |                 // Memory increment
+                       (0x0U << DMA_SxCR_PSIZE_Pos) |  // Peripheral byte
+                       (0x0U << DMA_SxCR_MSIZE_Pos);   // Memory byte
+
+    // Disable FIFO mode
+    dma->stream->FCR &= ~DMA_SxFCR_DMDIS;
+
+    dma_clear(dma, UART_DMA_ALL);
+}
+
+// Initialize UART hardware
+static int uart_init(const uart_port_t *port) {
+    uart_state_t *st = port->state;
+    USART_TypeDef *usart = port->usart;
+
+    if (st->initialized) {
+        return 0; // Already initialized
+    }
+
+    // Enable clocks
+    *port->rcc_enr |= port->rcc_en;
+
+    // Disable USART before configuration
+    usart->CR1 &= ~USART_CR1_UE;
+
+    // BRR, PRESC and OVER8 from the kernel clock selected in D2CCIP2R,
+    // checked before pins and DMA are touched so a failure leaves nothing on
+    int ret = uart_set_baudrate(port, st->baudrate ? st->baudrate : UART_DEFAULT_BAUDRATE);
+    if (ret < 0) {
+        *port->rcc_enr &= ~port->rcc_en;
+        return ret;
+    }
+
+    uart_pin_init(&port->tx_pin);
+    uart_pin_init(&port->rx_pin);
+
+    // Clear buffers before DMA starts, the ring is written back so
+    // no dirty line can later be evicted over DMA data
+    memset(port->tx_buf, 0, port->tx_size);
+    memset((void *)port->rx_buf, 0, port->rx_size);
+    SCB_CleanInvalidateDCache_by_Addr((uint32_t *)port->rx_buf, (int32_t)port->rx_size);
+
+    // RX: peripheral to memory, circular
+    uart_dma_init(&port->dma_rx, 0x0U, DMA_SxCR_CIRC);
+    port->dma_rx.stream->PAR = (uint32_t)&usart->RDR;
+    port->dma_rx.stream->M0AR = (uint32_t)port->rx_buf;
+    port->dma_rx.stream->NDTR = port->rx_size;
+    port->dma_rx.stream->CR |= (DMA_SxCR_TCIE | DMA_SxCR_HTIE | DMA_SxCR_TEIE); // Enable interrupts
+
+    // TX: memory to peripheral, started per descriptor
+    uart_dma_init(&port->dma_tx, 0x1U, 0x0U);
+    port->dma_tx.stream->PAR = (uint32_t)&usart->TDR;
+    port->dma_tx.stream->M0AR = (uint32_t)port->tx_buf;
+    port->dma_tx.stream->NDTR = 0;
+    port->dma_tx.stream->CR |= DMA_SxCR_TCIE | DMA_SxCR_TEIE; // Enable transfer complete and error interrupts
+
+    // Enable RX stream, TX stream will be enabled during transmission
+    port->dma_rx.stream->CR |= DMA_SxCR_EN;
+
+    // Configure USART parameters
+    usart->CR1 &= ~(USART_CR1_M | USART_CR1_PCE | USART_CR1_PS);
+    usart->CR1 |= USART_CR1_TE | USART_CR1_RE; // Transmitter and Receiver enabled, 8 data bits, no parity
+
+    usart->CR2 &= ~USART_CR2_STOP; // 1 stop bit
+
+    // Flow control and FIFO as set by UART_SET_CONFIG (off by default)
+    uart_line_config(port, NULL);
+
+    // Enable DMA for TX and RX
+    usart->CR3 |= USART_CR3_DMAT | USART_CR3_DMAR;
+
+    // IDLE line publishes partial DMA blocks, errors are counted
+    usart->ICR = USART_ICR_IDLECF | USART_ICR_PECF | USART_ICR_FECF | USART_ICR_NECF | USART_ICR_ORECF;
+    usart->CR1 |= USART_CR1_IDLEIE | USART_CR1_PEIE;
+    usart->CR3 |= USART_CR3_EIE;
+
+    // Enable USART
+    usart->CR1 |= USART_CR1_UE;
+
+    // Wait for USART to be ready
+    while((!(usart->ISR & USART_ISR_TEACK)) || (!(usart->ISR & USART_ISR_REACK))) {
+        // Wait for transmit and receive enable acknowledgement
+    }
+
+    // Enable DMA and USART interrupts
+    NVIC_SetPriority(port->dma_rx.irq, port->irq_prio);
+    NVIC_SetPriority(port->dma_tx.irq, port->irq_prio);
+    NVIC_SetPriority(port->irq, port->irq_prio);
+    NVIC_EnableIRQ(port->dma_rx.irq);
+    NVIC_EnableIRQ(port->dma_tx.irq);
+    NVIC_EnableIRQ(port->irq);
+
+    // Reset buffer pointers and state
+    uart_rx_reset(st);
+    uart_tx_reset(st);
+    uart_rts_update(port, 0);
+    st->initialized = 1;
+
+    return 0;
+}
+
+// Deinitialize UART hardware
+static int uart_deinit(const uart_port_t *port) {
+    uart_state_t *st = port->state;
+    USART_TypeDef *usart = port->usart;
+
+    if (!st->initialized) {
+        return 0;
+    }
+
+    // Disable USART
+    usart->CR1 &= ~(USART_CR1_UE | USART_CR1_IDLEIE | USART_CR1_PEIE);
+    usart->CR3 &= ~USART_CR3_EIE;
+
+    // Disable DMA streams
+    dma_stop(&port->dma_rx);
+    dma_stop(&port->dma_tx);
+
+    // Disable DMA requests in USART
+    usart->CR3 &= ~(USART_CR3_DMAT | USART_CR3_DMAR);
+    st->rts_soft = 0;
+
+    // Disable interrupts
+    NVIC_DisableIRQ(port->irq);
+    NVIC_DisableIRQ(port->dma_rx.irq);
+    NVIC_DisableIRQ(port->dma_tx.irq);
+
+    // Reset state, queued descriptors are dropped without completion
+    uart_rx_reset(st);
+    uart_tx_reset(st);
+    st->initialized = 0;
+
+    return 0;
+}
+
+// Let queued TX and the last frame leave before UE is cleared: a burst
+// cut by UE = 0 never completes. Sleeps with the caller's interrupts
+static int uart_tx_drain(const uart_port_t *port) {
+    uart_state_t *st = port->state;
+    uart_tx_watch_t watch = {0};
+    int ret = 0;
+
+    uint32_t primask = irq_lock();
+    while (st->tx_tail != st->tx_head || !(port->usart->ISR & USART_ISR_TC)) {
+        if (uart_tx_sleep(port, &watch, primask) < 0) {
+            uart_tx_abort(port);
+            ret = -ETIMEDOUT;
+            break;
+        }
+    }
+    irq_unlock(primask);
+
+    return ret;
+}
+
+/*
+ * Disable USART for reconfiguration, returns previous UE state.
+ * TX is drained with interrupts enabled, then the port is left irq
+ * locked (*primask) so nothing is queued until uart_resume() and
+ * irq_unlock() by the caller.
+ */
+static uint32_t uart_suspend(const uart_port_t *port, uint32_t *primask) {
+    const uart_state_t *st = port->state;
+    USART_TypeDef *usart = port->usart;
+    uint32_t ue;
+
+    for (;;) {
+        int ret = (usart->CR1 & USART_CR1_UE) ? uart_tx_drain(port) : 0;
+
+        *primask = irq_lock();
+        ue = usart->CR1 & USART_CR1_UE;
+        if (ret < 0 || !ue ||
+            (st->tx_tail == st->tx_head && (usart->ISR & USART_ISR_TC))) {
+            break;
+        }
+        // Queued again while draining
+        irq_unlock(*primask);
+    }
+
+    if (ue) {
+        usart->CR1 &= ~USART_CR1_UE;
+    }
+
+    return ue;
+}
+
+static void uart_resume(const uart_port_t *port, uint32_t ue) {
+    USART_TypeDef *usart = port->usart;
+
+    if (ue) {
+        usart->CR1 |= USART_CR1_UE;
+        while((!(usart->ISR & USART_ISR_TEACK)) || (!(usart->ISR & USART_ISR_REACK))) {
+            // Wait for transmit and receive enable acknowledgement
+        }
+    }
+}
+
+// Set baudrate from the real kernel clock
+static int uart_set_baudrate(const uart_port_t *port, uint32_t baudrate) {
+    uart_baud_t baud;
+
+    if (baudrate == 0) {
+        return -EINVAL;
+    }
+
+    uint32_t ker_clk = uart_kernel_clock(port);
+    if (ker_clk == 0) {
+        return -ENODEV;
+    }
+
+    int ret = uart_baud_calc(ker_clk, baudrate, &baud);
+    if (ret < 0) {
+        return ret;
+    }
+
+    // PRESC, BRR and OVER8 are writable only with UE = 0
+    uint32_t primask;
+    uint32_t ue = uart_suspend(port, &primask);
+
+    port->usart->PRESC = baud.presc;
+    port->usart->BRR = baud.brr;
+    if (baud.over8) {
+        port->usart->CR1 |= USART_CR1_OVER8;
+    } else {
+        port->usart->CR1 &= ~USART_CR1_OVER8;
+    }
+
+    uart_resume(port, ue);
+    irq_unlock(primask);
+
+    port->state->baudrate = baudrate;
+    port->state->baud = baud;
+    return 0;
+}
+
+// Get current baudrate
+static int uart_get_baudrate(const uart_port_t *port, uint32_t *baudrate) {
+    if (baudrate == NULL) {
+        return -EINVAL;
+    }
+
+    *baudrate = port->state->baudrate ? port->state->baudrate : UART_DEFAULT_BAUDRATE;
+    return 0;
+}
+
+// Select kernel clock source and re-apply baudrate
+static int uart_set_clock(const uart_port_t *port, uart_clk_source_t source) {
+    uart_state_t *st = port->state;
+
+    if ((uint32_t)source > (uint32_t)uart_clk_lse) {
+        return -EINVAL;
+    }
+
+    if (uart_source_clock(port, source) == 0) {
+        return -ENODEV; // Oscillator or PLL output not running
+    }
+
+    // UE is clear until uart_init(), nothing to drain then
+    uint32_t primask;
+    uint32_t ue = uart_suspend(port, &primask);
+
+    uint32_t pos = (uint32_t)__builtin_ctz(port->ker_sel);
+    RCC->D2CCIP2R = (RCC->D2CCIP2R & ~port->ker_sel) | ((uint32_t)source << pos);
+
+    uart_resume(port, ue);
+    irq_unlock(primask);
+
+    if (st->initialized) {
+        return uart_set_baudrate(port, st->baudrate);
+    }
+    return 0;
+}
+
+static int uart_get_baud_info(const uart_port_t *port, uart_baud_info_t *info) {
+    const uart_state_t *st = port->state;
+
+    if (info == NULL) {
+        return -EINVAL;
+    }
+
+    info->requested = st->baudrate;
+    info->actual = st->baud.actual;
+    info->error_ppm = st->baud.error_ppm;
+    info->kernel_clk = uart_kernel_clock(port);
+    info->prescaler = (uint16_t)uart_presc_div(st->baud.presc);
+    info->over8 = st->baud.over8;
+    info->source = uart_kernel_source(port);
+    return 0;
+}
+
+static int uart_set_config(const uart_port_t *port, const uart_config_t *cfg) {
+    uart_state_t *st = port->state;
+
+    if (cfg == NULL) {
+        return -EINVAL;
+    }
+
+    if ((uint32_t)cfg->flow > (uint32_t)uart_flow_rts_cts ||
+        (uint32_t)cfg->tx_threshold > (uint32_t)uart_fifo_full ||
+        (uint32_t)cfg->rx_threshold > (uint32_t)uart_fifo_full) {
+        return -EINVAL;
+    }
+
+    if (((cfg->flow & uart_flow_rts) && port->rts_pin.gpio == NULL) ||
+        ((cfg->flow & uart_flow_cts) && port->cts_pin.gpio == NULL)) {
+        return -ENODEV; // Not routed on this port
+    }
+
+    // Fill is sampled every half ring, see struct uart_config
+    if (cfg->rts_high > port->rx_size / 2U ||
+        (cfg->rts_high && cfg->rts_low >= cfg->rts_high)) {
+        return -EINVAL;
+    }
+
+    uart_config_t prev = st->config;
+    st->config = *cfg;
+
+    if (!st->initialized) {
+        // Applied by uart_init()
+        if (cfg->baudrate) {
+            st->baudrate = cfg->baudrate;
+        }
+        return 0;
+    }
+
+    // FIFOEN, RTSE and CTSE are writable only with UE = 0
+    uint32_t primask;
+    uint32_t ue = uart_suspend(port, &primask);
+    uart_line_config(port, &prev);
+    uart_rts_update(port, st->rx_head - st->rx_tail);
+    uart_resume(port, ue);
+    irq_unlock(primask);
+
+    if (cfg->baudrate && cfg->baudrate != st->baudrate) {
+        return uart_set_baudrate(port, cfg->baudrate);
+    }
+    return 0;
+}
+
+static int uart_get_config(const uart_port_t *port, uart_config_t *cfg) {
+    const uart_state_t *st = port->state;
+
+    if (cfg == NULL) {
+        return -EINVAL;
+    }
+
+    *cfg = st->config;
+    cfg->baudrate = st->baudrate ? st->baudrate : UART_DEFAULT_BAUDRATE;
+    if (st->rts_soft) {
+        cfg->rts_high = st->rts_high;
+        cfg->rts_low = st->rts_low;
+    }
+    return 0;
+}
+
+// IO Control for UART (interface implementation)
+int uart_port_ioctrl(const uart_port_t *port, int cmd, void *arg) {
+    uart_state_t *st = port->state;
+
+    switch (cmd) {
+        case UART_INIT:
+            return uart_init(port);
+
+        case UART_DEINIT:
+            return uart_deinit(port);
+
+        case UART_GET_AVAILABLE:
+            if (arg != NULL) {
+                *(int *)arg = uart_available(port);
+                return 0;
+            }
+            return -EINVAL;
+
+        case UART_FLUSH:
+            return uart_flush(port);
+
+        case UART_SET_BAUDRATE:
+            if (arg == NULL) return -EINVAL;
+            return uart_set_baudrate(port, *(uint32_t *)arg);
+
+        case UART_GET_BAUDRATE:
+            if (arg == NULL) return -EINVAL;
+            return uart_get_baudrate(port, (uint32_t *)arg);
+
+        case UART_SET_CLOCK:
+            if (arg == NULL) return -EINVAL;
+            return uart_set_clock(port, *(uart_clk_source_t *)arg);
+
+        case UART_GET_BAUD_INFO:
+            return uart_get_baud_info(port, (uart_baud_info_t *)arg);
+
+        case UART_SET_CONFIG:
+            return uart_set_config(port, (const uart_config_t *)arg);
+
+        case UART_GET_CONFIG:
+            return uart_get_config(port, (uart_config_t *)arg);
+
+        case UART_TX_QUEUE:
+            return uart_tx_queue(port, (const uart_tx_desc_t *)arg);
+
+        case UART_TX_PENDING:
+            if (arg == NULL) return -EINVAL;
+            *(int *)arg = (int)(st->tx_head - st->tx_tail);
+            return 0;
+
+        case UART_TX_DRAIN:
+            if (!st->initialized) return -ENODEV;
+            return uart_tx_drain(port);
+
+        case UART_SET_RX_NOTIFY: {
+            uint32_t primask = irq_lock();
+            if (arg != NULL) {
+                st->rx_notify = *(const uart_rx_notify_t *)arg;
+            } else {
+                st->rx_notify.fn = NULL;
+                st->rx_notify.ctx = NULL;
+            }
+            irq_unlock(primask);
+            return 0;
+        }
+
+        case UART_SET_RX_BLOCKING:
+            if (arg == NULL) return -EINVAL;
+            st->rx_blocking = (*(int *)arg) ? 1 : 0;
+            return 0;
+
+        case UART_GET_RX_OVERRUNS:
+            if (arg == NULL) return -EINVAL;
+            *(uint32_t *)arg = st->stats.rx_overruns;
+            return 0;
+
+        case INTERFACE_GET_STATUS: {
+            if (arg == NULL) return -EINVAL;
+            if (!st->initialized) return -ENODEV;
+            // Coherent snapshot, the ISRs never wait on this
+            uint32_t primask = irq_lock();
+            *(uart_stats_t *)arg = st->stats;
+            irq_unlock(primask);
+            return 0;
+        }
+
+        case UART_CLEAR_STATS: {
+            uint32_t primask = irq_lock();
+            memset(&st->stats, 0, sizeof(st->stats));
+            irq_unlock(primask);
+            return 0;
+        }
+
+        default:
+            return -ENOTSUP;
+    }
+}
+
+// DMA RX stream interrupt (half transfer / transfer complete / error)
+void uart_port_dma_rx_irq(const uart_port_t *port) {
+    uart_stats_t *stats = &port->state->stats;
+    uint32_t flags = dma_flags(&port->dma_rx);
+
+    // Publish new write position
+    if (flags & (UART_DMA_HTIF | UART_DMA_TCIF)) {
+        dma_clear(&port->dma_rx, UART_DMA_HTIF | UART_DMA_TCIF);
+        if (flags & UART_DMA_HTIF) {
+            stats->rx_dma_ht++;
+        }
+        if (flags & UART_DMA_TCIF) {
+            stats->rx_dma_tc++;
+        }
+        uart_rx_update(port);
+    }
+
+    // Bus error disables the stream, unread data is lost
+    if (flags & UART_DMA_TEIF) {
+        stats->dma_rx_err++;
+        uart_flush(port);
+    }
+}
+
+// DMA TX stream interrupt, chains the next descriptor
+void uart_port_dma_tx_irq(const uart_port_t *port) {
+    uart_state_t *st = port->state;
+    uint32_t flags = dma_flags(&port->dma_tx);
+
+    if (!(flags & (UART_DMA_TCIF | UART_DMA_TEIF))) {
+        return;
+    }
+    dma_clear(&port->dma_tx, UART_DMA_ALL);
+
+    const uart_tx_desc_t *desc = &st->tx_queue[st->tx_tail & TX_QUEUE_MASK];
+
+    if (flags & UART_DMA_TEIF) {
+        // Bus error, drop the rest of this descriptor
+        st->tx_offset = (uint32_t)desc->len;
+        st->stats.dma_tx_err++;
+    } else {
+        st->tx_offset += st->tx_chunk;
+        st->stats.tx_bytes += st->tx_chunk;
+        st->stats.tx_dma_tc++;
+    }
+
+    void (*done)(void *) = NULL;
+    void *ctx = NULL;
+
+    if (st->tx_offset >= desc->len) {
+        done = desc->done;
+        ctx = desc->ctx;
+        st->tx_offset = 0;
+        st->tx_tail++;
+    }
+
+    // Chain next burst before running callbacks to keep the line busy
+    if (st->tx_tail != st->tx_head) {
+        uart_tx_start(port);
+    } else {
+        st->tx_in_progress = 0;
+    }
+
+    if (done != NULL) {
+        done(ctx);
+    }
+}
+
+// USART interrupt (IDLE line, receive errors)
+void uart_port_irq(const uart_port_t *port) {
+    uart_stats_t *stats = &port->state->stats;
+    uint32_t isr = port->usart->ISR;
+
+    if (isr & (USART_ISR_PE | USART_ISR_FE | USART_ISR_NE | USART_ISR_ORE)) {
+        port->usart->ICR = USART_ICR_PECF | USART_ICR_FECF | USART_ICR_NECF | USART_ICR_ORECF;
+        if (isr & USART_ISR_PE) {
+            stats->err_parity++;
+        }
+        if (isr & USART_ISR_FE) {
+            stats->err_frame++;
+        }
+        if (isr & USART_ISR_NE) {
+            stats->err_noise++;
+        }
+        if (isr & USART_ISR_ORE) {
+            stats->err_overrun++;
+        }
+    }
+
+    if (isr & USART_ISR_IDLE) {
+        port->usart->ICR = USART_ICR_IDLECF;
+        stats->rx_idle++;
+        uart_rx_update(port);
+    }
+}
@@ -0,0 +1,281 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * dev_uart.h - POSIX-style USART/DMA interface for STM32H743
+ * 
+ * Copyright (c) 2025 Michael Kaa
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef DEV_UART_H
+#define DEV_UART_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "dev_interface.h"
+
+// Ports compiled in. Each port claims two DMA streams and its USART IRQ:
+//   USART1 PB14/PB15  DMA1 S0/S1     UART5  PC12/PD2   DMA2 S0/S1
+//   USART2 PD5/PD6    DMA1 S2/S3     USART6 PC6/PC7    DMA2 S2/S3
+//   USART3 PD8/PD9    DMA1 S4/S5     UART7  PE8/PE7    DMA2 S4/S5
+//   UART4  PA0/PA1    DMA1 S6/S7     UART8  PE1/PE0    DMA2 S6/S7
+// RTS/CTS pins are claimed only when flow control is enabled:
+//   USART1 PA12/PA11  USART2 PD4/PD3  USART3 PD12/PD11  UART4 PA15/PB0
+//   UART5  PC8/PC9    USART6 PG8/PG13 UART7  PE9/PE10   UART8 PD15/PD14
+// Only USART1 (console) and USART2 (second CLI) are on by default, a
+// board opts in to more with e.g. C_DEFS += -DDEV_UART_USE_UART3=1
+#ifndef DEV_UART_USE_UART1
+#define DEV_UART_USE_UART1 1
+#endif
+#ifndef DEV_UART_USE_UART2
+#define DEV_UART_USE_UART2 1
+#endif
+#ifndef DEV_UART_USE_UART3
+#define DEV_UART_USE_UART3 0
+#endif
+#ifndef DEV_UART_USE_UART4
+#define DEV_UART_USE_UART4 0
+#endif
+#ifndef DEV_UART_USE_UART5
+#define DEV_UART_USE_UART5 0
+#endif
+#ifndef DEV_UART_USE_UART6
+#define DEV_UART_USE_UART6 0
+#endif
+#ifndef DEV_UART_USE_UART7
+#define DEV_UART_USE_UART7 0
+#endif
+#ifndef DEV_UART_USE_UART8
+#define DEV_UART_USE_UART8 0
+#endif
+
+// Default buffer sizes (RX must be a power of two)
+#define UART_TX_BUFFER_SIZE 256
+#define UART_RX_BUFFER_SIZE 256
+
+// TX descriptor ring length (must be a power of two)
+#define UART_TX_QUEUE_LEN   8
+
+// Default baudrate
+#define UART_DEFAULT_BAUDRATE 115200
+
+// Largest accepted baudrate error (parts per million)
+#define UART_BAUD_MAX_ERROR_PPM 10000
+
+// UART-specific ioctrl commands
+#define UART_INIT           (INTERFACE_CMD_DEVICE + 0)
+#define UART_DEINIT         (INTERFACE_CMD_DEVICE + 1)
+#define UART_GET_AVAILABLE  (INTERFACE_CMD_DEVICE + 2)
+#define UART_FLUSH          (INTERFACE_CMD_DEVICE + 3)
+#define UART_SET_BAUDRATE   (INTERFACE_CMD_DEVICE + 4)
+#define UART_GET_BAUDRATE   (INTERFACE_CMD_DEVICE + 5)
+#define UART_TX_QUEUE       (INTERFACE_CMD_DEVICE + 6) /* arg: const uart_tx_desc_t*, -EAGAIN if ring is full */
+#define UART_TX_PENDING     (INTERFACE_CMD_DEVICE + 7) /* arg: int*, descriptors not yet completed */
+#define UART_SET_RX_NOTIFY  (INTERFACE_CMD_DEVICE + 8) /* arg: const uart_rx_notify_t*, NULL to remove */
+#define UART_SET_RX_BLOCKING (INTERFACE_CMD_DEVICE + 9) /* arg: int*, 1 - read sleeps until data */
+#define UART_GET_RX_OVERRUNS (INTERFACE_CMD_DEVICE + 10) /* arg: uint32_t*, reader fell a lap behind */
+#define UART_SET_CLOCK      (INTERFACE_CMD_DEVICE + 11) /* arg: uart_clk_source_t*, baudrate is re-applied */
+#define UART_GET_BAUD_INFO  (INTERFACE_CMD_DEVICE + 12) /* arg: uart_baud_info_t* */
+#define UART_SET_CONFIG     (INTERFACE_CMD_DEVICE + 13) /* arg: const uart_config_t*, flow control and FIFO */
+#define UART_GET_CONFIG     (INTERFACE_CMD_DEVICE + 14) /* arg: uart_config_t* */
+#define UART_CLEAR_STATS    (INTERFACE_CMD_DEVICE + 15) /* arg: NULL, counters read by INTERFACE_GET_STATUS */
+#define UART_TX_DRAIN       (INTERFACE_CMD_DEVICE + 16) /* arg: NULL, wait until all TX is out, works irq masked */
+
+/*
+ * USART kernel clock source (RCC D2CCIP2R). The selector is shared:
+ * USART1/6 use one field, USART2/3, UART4/5/7/8 the other, so
+ * switching the source re-clocks the sibling ports too.
+ */
+typedef enum {
+    uart_clk_pclk  = 0,   // PCLK2 for USART1/6, PCLK1 for the others
+    uart_clk_pll2q = 1,
+    uart_clk_pll3q = 2,
+    uart_clk_hsi   = 3,
+    uart_clk_csi   = 4,
+    uart_clk_lse   = 5
+} uart_clk_source_t;
+
+/**
+ * struct uart_baud_info - Achieved baudrate report
+ * @requested: Baudrate asked for
+ * @actual: Baudrate produced by the BRR/PRESC/OVER8 setting
+ * @error_ppm: (actual - requested) / requested, parts per million
+ * @kernel_clk: USART kernel clock frequency
+ * @prescaler: Kernel clock divider (USART_PRESC)
+ * @over8: 1 for 8x oversampling
+ * @source: Kernel clock source
+ */
+typedef struct uart_baud_info {
+    uint32_t requested;
+    uint32_t actual;
+    int32_t error_ppm;
+    uint32_t kernel_clk;
+    uint16_t prescaler;
+    uint8_t over8;
+    uart_clk_source_t source;
+} uart_baud_info_t;
+
+// Hardware flow control lines (bit mask)
+typedef enum {
+    uart_flow_none    = 0,
+    uart_flow_rts     = 1,   // we hold the sender off
+    uart_flow_cts     = 2,   // the receiver holds us off
+    uart_flow_rts_cts = 3
+} uart_flow_t;
+
+// FIFO threshold, USART_CR3 TXFTCFG/RXFTCFG encoding
+typedef enum {
+    uart_fifo_1_8  = 0,
+    uart_fifo_1_4  = 1,
+    uart_fifo_1_2  = 2,
+    uart_fifo_3_4  = 3,
+    uart_fifo_7_8  = 4,
+    uart_fifo_full = 5
+} uart_fifo_thr_t;
+
+/**
+ * struct uart_config - Line configuration
+ * @baudrate: Baudrate, 0 keeps the current one
+ * @flow: Flow control lines, the port must have RTS/CTS pins routed
+ * @rts_soft: 1 - RTS is a GPIO driven from the RX ring fill level
+ *            instead of the USART (which only sees its 16 byte FIFO)
+ * @fifo: 1 - enable the 16 byte TX/RX FIFOs
+ * @tx_threshold: TX FIFO threshold
+ * @rx_threshold: RX FIFO threshold
+ * @rts_high: Ring fill (bytes) that deasserts soft RTS, 0 - quarter ring
+ * @rts_low: Ring fill that asserts soft RTS again, 0 - eighth of the ring
+ *
+ * The ring fill is sampled on DMA half/full transfer, IDLE and on every
+ * read, so it may overshoot @rts_high by up to half a ring before RTS
+ * drops. @rts_high is therefore limited to half of the ring.
+ */
+typedef struct uart_config {
+    uint32_t baudrate;
+    uart_flow_t flow;
+    uint8_t rts_soft;
+    uint8_t fifo;
+    uart_fifo_thr_t tx_threshold;
+    uart_fifo_thr_t rx_threshold;
+    uint32_t rts_high;
+    uint32_t rts_low;
+} uart_config_t;
+
+/**
+ * struct uart_stats - Port counters, INTERFACE_GET_STATUS
+ * @rx_bytes: Bytes received by DMA
+ * @tx_bytes: Bytes sent by DMA
+ * @rx_dma_ht: RX half transfer interrupts
+ * @rx_dma_tc: RX transfer complete interrupts
+ * @rx_idle: IDLE line interrupts
+ * @tx_dma_tc: TX bursts completed
+ * @rx_wraps: DMA laps around the RX ring
+ * @rx_peak: Largest ring fill seen (bytes not yet read)
+ * @rx_overruns: Reader fell a lap behind, a ring of data was lost
+ * @err_frame: USART framing errors (FE)
+ * @err_noise: USART noise errors (NE)
+ * @err_overrun: USART overruns (ORE), DMA did not drain RDR in time
+ * @err_parity: USART parity errors (PE)
+ * @dma_rx_err: RX stream transfer errors, the ring is restarted
+ * @dma_tx_err: TX stream transfer errors, the descriptor is dropped
+ * @tx_aborts: Writes that timed out on a stalled line, the TX ring
+ *             was completed unsent
+ * @rts_throttles: Times soft RTS held the sender off
+ *
+ * Counters are only incremented by the port ISRs (tx_aborts by the
+ * timed out writer, irq locked), all wrap at 2^32.
+ */
+typedef struct uart_stats {
+    uint32_t rx_bytes;
+    uint32_t tx_bytes;
+    uint32_t rx_dma_ht;
+    uint32_t rx_dma_tc;
+    uint32_t rx_idle;
+    uint32_t tx_dma_tc;
+    uint32_t rx_wraps;
+    uint32_t rx_peak;
+    uint32_t rx_overruns;
+    uint32_t err_frame;
+    uint32_t err_noise;
+    uint32_t err_overrun;
+    uint32_t err_parity;
+    uint32_t dma_rx_err;
+    uint32_t dma_tx_err;
+    uint32_t tx_aborts;
+    uint32_t rts_throttles;
+} uart_stats_t;
+
+/**
+ * struct uart_tx_desc - Zero-copy TX request
+ * @buf: Data to send, owned by the caller until @done is called.
+ *       Must be DMA reachable (AXI SRAM, SRAM1..4 or flash, not DTCM/ITCM)
+ *       and not be written until @done, its D-cache lines are cleaned
+ *       when queued
+ * @len: Number of bytes, any size (split into DMA bursts internally)
+ * @done: Completion callback, called from DMA ISR context (may be NULL)
+ * @ctx: Argument for @done
+ *
+ * Descriptor contents are copied into the TX ring, so the descriptor
+ * itself may live on the stack. Completion callbacks may queue new
+ * descriptors.
+ */
+typedef struct uart_tx_desc {
+    const void *buf;
+    size_t len;
+    void (*done)(void *ctx);
+    void *ctx;
+} uart_tx_desc_t;
+
+/**
+ * struct uart_rx_notify - RX data notification
+ * @fn: Called from ISR context when new bytes are published
+ *      (IDLE line, DMA half/full transfer)
+ * @ctx: Argument for @fn
+ */
+typedef struct uart_rx_notify {
+    void (*fn)(void *ctx);
+    void *ctx;
+} uart_rx_notify_t;
+
+// UART device instance accessors
+#if DEV_UART_USE_UART1
+const interface_t* dev_uart1_get(void);
+#endif
+#if DEV_UART_USE_UART2
+const interface_t* dev_uart2_get(void);
+#endif
+#if DEV_UART_USE_UART3
+const interface_t* dev_uart3_get(void);
+#endif
+#if DEV_UART_USE_UART4
+const interface_t* dev_uart4_get(void);
+#endif
+#if DEV_UART_USE_UART5
+const interface_t* dev_uart5_get(void);
+#endif
+#if DEV_UART_USE_UART6
+const interface_t* dev_uart6_get(void);
+#endif
+#if DEV_UART_USE_UART7
+const interface_t* dev_uart7_get(void);
+#endif
+#if DEV_UART_USE_UART8
+const interface_t* dev_uart8_get(void);
+#endif
+
+#endif /* DEV_UART_H */
@@ -0,0 +1,229 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * dev_uart_baud.c - USART kernel clock and baudrate calculation for STM32H743
+ * 
+ * Copyright (c) 2025 Michael Kaa
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <errno.h>
+#include "dev_uart.h"
+#include "inc/dev_uart_port.h"
+#include "stm32h743xx.h"
+
+// Fallback HSE frequency, used only when PLL1 is not the system clock.
+// Otherwise the PLL reference is derived from SystemCoreClock and the
+// PLL1 dividers, see pll_src_clock()
+#ifndef HSE_VALUE
+#define HSE_VALUE (24000000U)
+#endif
+
+#define HSI_VALUE (64000000U)
+#define CSI_VALUE (4000000U)
+#define LSE_VALUE (32768U)
+
+// PLL fractional part resolution (FRACN is 13 bit)
+#define PLL_FRAC_ONE (8192U)
+
+// USART_PRESC encoding to kernel clock divider
+static const uint16_t presc_div[] = {1, 2, 4, 6, 8, 10, 12, 16, 32, 64, 128, 256};
+
+// D1CPRE/HPRE and D2PPRE encodings to shift
+static const uint8_t ahb_shift[16] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 6, 7, 8, 9};
+static const uint8_t apb_shift[8] = {0, 0, 0, 0, 1, 2, 3, 4};
+
+static uint32_t hclk_clock(void) {
+    uint32_t hpre = (RCC->D1CFGR & RCC_D1CFGR_HPRE) >> RCC_D1CFGR_HPRE_Pos;
+    return SystemCoreClock >> ahb_shift[hpre];
+}
+
+// PLLx VCO for a given reference, x = 0..2 for PLL1..3
+static uint64_t pll_vco(uint32_t src, uint32_t x) {
+    const volatile uint32_t *divr = &RCC->PLL1DIVR + 2U * x;
+    const volatile uint32_t *fracr = divr + 1;
+    uint32_t m = (RCC->PLLCKSELR >> (RCC_PLLCKSELR_DIVM1_Pos + 8U * x)) & 0x3FU;
+    uint32_t n = (*divr & RCC_PLL1DIVR_N1) + 1U;
+    uint32_t frac = 0;
+
+    if (m == 0) {
+        return 0; // Prescaler disabled
+    }
+
+    if (RCC->PLLCFGR & (RCC_PLLCFGR_PLL1FRACEN << (4U * x))) {
+        frac = (*fracr & RCC_PLL1FRACR_FRACN1) >> RCC_PLL1FRACR_FRACN1_Pos;
+    }
+
+    return ((uint64_t)src * (n * PLL_FRAC_ONE + frac)) / ((uint64_t)m * PLL_FRAC_ONE);
+}
+
+// PLL reference (HSI, CSI or HSE before DIVMx)
+static uint32_t pll_src_clock(void) {
+    switch (RCC->PLLCKSELR & RCC_PLLCKSELR_PLLSRC) {
+        case RCC_PLLCKSELR_PLLSRC_HSI:
+            return HSI_VALUE >> ((RCC->CR & RCC_CR_HSIDIV) >> RCC_CR_HSIDIV_Pos);
+
+        case RCC_PLLCKSELR_PLLSRC_CSI:
+            return CSI_VALUE;
+
+        case RCC_PLLCKSELR_PLLSRC_HSE:
+            // Recover HSE from the running system clock: sys_ck = vco1 / P1
+            if (((RCC->CFGR & RCC_CFGR_SWS) == RCC_CFGR_SWS_PLL1) && SystemCoreClock) {
+                uint32_t d1cpre = (RCC->D1CFGR & RCC_D1CFGR_D1CPRE) >> RCC_D1CFGR_D1CPRE_Pos;
+                uint64_t sys_ck = (uint64_t)SystemCoreClock << ahb_shift[d1cpre];
+                uint64_t p = ((RCC->PLL1DIVR & RCC_PLL1DIVR_P1) >> RCC_PLL1DIVR_P1_Pos) + 1U;
+                uint64_t vco_per_src = pll_vco(PLL_FRAC_ONE, 0); // vco for src = 8192 Hz
+                if (vco_per_src) {
+                    return (uint32_t)((sys_ck * p * PLL_FRAC_ONE + vco_per_src / 2U) / vco_per_src);
+                }
+            }
+            return HSE_VALUE;
+
+        default:
+            return 0;
+    }
+}
+
+// PLL2/PLL3 Q output, 0 if not running
+static uint32_t pll_q_clock(uint32_t x) {
+    uint32_t rdy = (x == 1U) ? RCC_CR_PLL2RDY : RCC_CR_PLL3RDY;
+
+    if (!(RCC->CR & rdy)) {
+        return 0;
+    }
+
+    const volatile uint32_t *divr = &RCC->PLL1DIVR + 2U * x;
+    uint32_t q = ((*divr & RCC_PLL1DIVR_Q1) >> RCC_PLL1DIVR_Q1_Pos) + 1U;
+
+    return (uint32_t)(pll_vco(pll_src_clock(), x) / q);
+}
+
+// Kernel clock source currently selected for the port
+uart_clk_source_t uart_kernel_source(const uart_port_t *port) {
+    uint32_t pos = (uint32_t)__builtin_ctz(port->ker_sel);
+    return (uart_clk_source_t)((RCC->D2CCIP2R & port->ker_sel) >> pos);
+}
+
+// Frequency of a kernel clock source for the port, 0 if not running
+uint32_t uart_source_clock(const uart_port_t *port, uart_clk_source_t source) {
+    switch (source) {
+        case uart_clk_pclk: {
+            // USART1/6 are on APB2, the rest on APB1
+            uint32_t d2cfgr = RCC->D2CFGR;
+            uint32_t ppre = (port->rcc_enr == &RCC->APB2ENR) ?
+                            (d2cfgr & RCC_D2CFGR_D2PPRE2) >> RCC_D2CFGR_D2PPRE2_Pos :
+                            (d2cfgr & RCC_D2CFGR_D2PPRE1) >> RCC_D2CFGR_D2PPRE1_Pos;
+            return hclk_clock() >> apb_shift[ppre];
+        }
+
+        case uart_clk_pll2q:
+            return pll_q_clock(1U);
+
+        case uart_clk_pll3q:
+            return pll_q_clock(2U);
+
+        case uart_clk_hsi:
+            if (!(RCC->CR & RCC_CR_HSIRDY)) return 0;
+            return HSI_VALUE >> ((RCC->CR & RCC_CR_HSIDIV) >> RCC_CR_HSIDIV_Pos);
+
+        case uart_clk_csi:
+            return (RCC->CR & RCC_CR_CSIRDY) ? CSI_VALUE : 0;
+
+        case uart_clk_lse:
+            return (RCC->BDCR & RCC_BDCR_LSERDY) ? LSE_VALUE : 0;
+
+        default:
+            return 0;
+    }
+}
+
+uint32_t uart_kernel_clock(const uart_port_t *port) {
+    return uart_source_clock(port, uart_kernel_source(port));
+}
+
+/**
+ * uart_baud_calc - Find PRESC/BRR/OVER8 for a baudrate
+ * @ker_clk: USART kernel clock
+ * @baudrate: Requested baudrate
+ * @out: Register values and achieved baudrate
+ *
+ * Baud = ker_clk / presc / d. 16x oversampling needs d >= 16, 8x
+ * oversampling allows d >= 8 (BRR[2:0] holds USARTDIV[3:1], so both
+ * modes have the same resolution and OVER8 only extends the top end).
+ * Returns 0, -EINVAL if unreachable or -ERANGE if error exceeds
+ * UART_BAUD_MAX_ERROR_PPM.
+ */
+int uart_baud_calc(uint32_t ker_clk, uint32_t baudrate, uart_baud_t *out) {
+    uint32_t best_err = UINT32_MAX;
+
+    if (ker_clk == 0 || baudrate == 0 || out == NULL) {
+        return -EINVAL;
+    }
+
+    for (uint32_t presc = 0; presc < sizeof(presc_div) / sizeof(presc_div[0]); presc++) {
+        uint32_t clk = ker_clk / presc_div[presc];
+        uint32_t d = (clk + baudrate / 2U) / baudrate;
+        uint32_t brr;
+        uint8_t over8;
+
+        if (d < 8U) {
+            break; // Larger prescalers only make it worse
+        }
+
+        if (d > 0xFFFFU) {
+            continue;
+        }
+
+        if (d >= 16U) {
+            brr = d;
+            over8 = 0;
+        } else {
+            brr = ((2U * d) & 0xFFF0U) | (((2U * d) & 0xFU) >> 1);
+            over8 = 1;
+        }
+
+        uint32_t actual = clk / d;
+        uint32_t diff = (actual > baudrate) ? actual - baudrate : baudrate - actual;
+        uint32_t err = (uint32_t)(((uint64_t)diff * 1000000U) / baudrate);
+
+        // Keep the smallest prescaler on ties, it has the finest resolution
+        if (err < best_err) {
+            best_err = err;
+            out->brr = brr;
+            out->presc = (uint8_t)presc;
+            out->over8 = over8;
+            out->actual = actual;
+            out->error_ppm = (actual >= baudrate) ? (int32_t)err : -(int32_t)err;
+        }
+
+        if (err == 0) {
+            break;
+        }
+    }
+
+    if (best_err == UINT32_MAX) {
+        return -EINVAL;
+    }
+
+    return (best_err > UART_BAUD_MAX_ERROR_PPM) ? -ERANGE : 0;
+}
+
+uint32_t uart_presc_div(uint8_t presc) {
+    return (presc < sizeof(presc_div) / sizeof(presc_div[0])) ? presc_div[presc] : 1U;
+}
@@ -0,0 +1,445 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * dev_uart_ports.c - USART port table and device instances for STM32H743
+ * 
+ * Copyright (c) 2025 Michael Kaa
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "dev_uart.h"
+#include "inc/dev_uart_port.h"
+#include "stm32h743xx.h"
+#include "cpuload.h"
+
+// USART interrupt priority (DMA streams use the same level)
+#define UART_IRQ_PRIO 5U
+
+// DMA stream descriptor. DMA1 streams map to DMAMUX1 channels 0..7,
+// DMA2 streams to 8..15. Request IDs are from RM0433 table "DMAMUX1"
+#define UART_DMA_STREAM(ctrl, n, mux_ch, req) {                         \
+    .stream  = ctrl##_Stream##n,                                        \
+    .mux     = DMAMUX1_Channel##mux_ch,                                 \
+    .isr     = ((n) < 4) ? &ctrl->LISR : &ctrl->HISR,                   \
+    .ifcr    = ((n) < 4) ? &ctrl->LIFCR : &ctrl->HIFCR,                 \
+    .rcc_en  = RCC_AHB1ENR_##ctrl##EN,                                  \
+    .irq     = ctrl##_Stream##n##_IRQn,                                 \
+    .request = (req),                                                   \
+    .shift   = (uint8_t)(((n) & 1U) * 6U + (((n) & 2U) ? 16U : 0U)),    \
+}
+
+// interface_t has no context pointer, bind each port with thin wrappers
+#define DEV_UART_INSTANCE(n)                                                        \
+    static int uart##n##_open(void) { return uart_port_open(&uart##n##_port); }     \
+    static int uart##n##_close(void) { return uart_port_close(&uart##n##_port); }   \
+    static int uart##n##_read(void *buf, size_t count) {                            \
+        return uart_port_read(&uart##n##_port, buf, count);                         \
+    }                                                                               \
+    static int uart##n##_write(const void *buf, size_t count) {                     \
+        return uart_port_write(&uart##n##_port, buf, count);                        \
+    }                                                                               \
+    static int uart##n##_ioctrl(int cmd, void *arg) {                               \
+        return uart_port_ioctrl(&uart##n##_port, cmd, arg);                         \
+    }                                                                               \
+    static const interface_t dev_uart##n = {                                        \
+        .open = uart##n##_open,                                                     \
+        .close = uart##n##_close,                                                   \
+        .read = uart##n##_read,                                                     \
+        .write = uart##n##_write,                                                   \
+        .ioctrl = uart##n##_ioctrl                                                  \
+    };                                                                              \
+    const interface_t* dev_uart##n##_get(void) {                                    \
+        return &dev_uart##n;                                                        \
+    }
+
+#if DEV_UART_USE_UART1
+// USART1: TX PB14, RX PB15, AF4; RTS PA12, CTS PA11, AF7 (shared with USB FS)
+RAM_D1_DMA static uint8_t uart1_tx_buf[UART_TX_BUFFER_SIZE];
+RAM_D1_DMA static volatile uint8_t uart1_rx_buf[UART_RX_BUFFER_SIZE];
+static uart_state_t uart1_state;
+
+static const uart_port_t uart1_port = {
+    .usart = USART1,
+    .irq = USART1_IRQn,
+    .irq_prio = UART_IRQ_PRIO,
+    .rcc_enr = &RCC->APB2ENR,
+    .rcc_en = RCC_APB2ENR_USART1EN,
+    .ker_sel = RCC_D2CCIP2R_USART16SEL,
+    .tx_pin = { GPIOB, 14U, 4U },
+    .rx_pin = { GPIOB, 15U, 4U },
+    .rts_pin = { GPIOA, 12U, 7U },
+    .cts_pin = { GPIOA, 11U, 7U },
+    .dma_rx = UART_DMA_STREAM(DMA1, 0, 0, 41U),
+    .dma_tx = UART_DMA_STREAM(DMA1, 1, 1, 42U),
+    .tx_buf = uart1_tx_buf,
+    .tx_size = UART_TX_BUFFER_SIZE,
+    .rx_buf = uart1_rx_buf,
+    .rx_size = UART_RX_BUFFER_SIZE,
+    .state = &uart1_state,
+};
+
+DEV_UART_INSTANCE(1)
+
+void USART1_IRQHandler(void) {
+    CPULOAD_IRQ_ENTER();
+    uart_port_irq(&uart1_port);
+    CPULOAD_IRQ_EXIT();
+}
+
+void DMA1_Stream0_IRQHandler(void) {
+    CPULOAD_IRQ_ENTER();
+    uart_port_dma_rx_irq(&uart1_port);
+    CPULOAD_IRQ_EXIT();
+}
+
+void DMA1_Stream1_IRQHandler(void) {
+    CPULOAD_IRQ_ENTER();
+    uart_port_dma_tx_irq(&uart1_port);
+    CPULOAD_IRQ_EXIT();
+}
+#endif /* DEV_UART_USE_UART1 */
+
+#if DEV_UART_USE_UART2
+// USART2: TX PD5, RX PD6, AF7; RTS PD4, CTS PD3, AF7
+RAM_D1_DMA static uint8_t uart2_tx_buf[UART_TX_BUFFER_SIZE];
+RAM_D1_DMA static volatile uint8_t uart2_rx_buf[UART_RX_BUFFER_SIZE];
+static uart_state_t uart2_state;
+
+static const uart_port_t uart2_port = {
+    .usart = USART2,
+    .irq = USART2_IRQn,
+    .irq_prio = UART_IRQ_PRIO,
+    .rcc_enr = &RCC->APB1LENR,
+    .rcc_en = RCC_APB1LENR_USART2EN,
+    .ker_sel = RCC_D2CCIP2R_USART28SEL,
+    .tx_pin = { GPIOD, 5U, 7U },
+    .rx_pin = { GPIOD, 6U, 7U },
+    .rts_pin = { GPIOD, 4U, 7U },
+    .cts_pin = { GPIOD, 3U, 7U },
+    .dma_rx = UART_DMA_STREAM(DMA1, 2, 2, 43U),
+    .dma_tx = UART_DMA_STREAM(DMA1, 3, 3, 44U),
+    .tx_buf = uart2_tx_buf,
+    .tx_size = UART_TX_BUFFER_SIZE,
+    .rx_buf = uart2_rx_buf,
+    .rx_size = UART_RX_BUFFER_SIZE,
+    .state = &uart2_state,
+};
+
+DEV_UART_INSTANCE(2)
+
+void USART2_IRQHandler(void) {
+    CPULOAD_IRQ_ENTER();
+    uart_port_irq(&uart2_port);
+    CPULOAD_IRQ_EXIT();
+}
+
+void DMA1_Stream2_IRQHandler(void) {
+    CPULOAD_IRQ_ENTER();
+    uart_port_dma_rx_irq(&uart2_port);
+    CPULOAD_IRQ_EXIT();
+}
+
+void DMA1_Stream3_IRQHandler(void) {
+    CPULOAD_IRQ_ENTER();
+    uart_port_dma_tx_irq(&uart2_port);
+    CPULOAD_IRQ_EXIT();
+}
+#endif /* DEV_UART_USE_UART2 */
+
+#if DEV_UART_USE_UART3
+// USART3: TX PD8, RX PD9, AF7; RTS PD12, CTS PD11, AF7
+RAM_D1_DMA static uint8_t uart3_tx_buf[UART_TX_BUFFER_SIZE];
+RAM_D1_DMA static volatile uint8_t uart3_rx_buf[UART_RX_BUFFER_SIZE];
+static uart_state_t uart3_state;
+
+static const uart_port_t uart3_port = {
+    .usart = USART3,
+    .irq = USART3_IRQn,
+    .irq_prio = UART_IRQ_PRIO,
+    .rcc_enr = &RCC->APB1LENR,
+    .rcc_en = RCC_APB1LENR_USART3EN,
+    .ker_sel = RCC_D2CCIP2R_USART28SEL,
+    .tx_pin = { GPIOD, 8U, 7U },
+    .rx_pin = { GPIOD, 9U, 7U },
+    .rts_pin = { GPIOD, 12U, 7U },
+    .cts_pin = { GPIOD, 11U, 7U },
+    .dma_rx = UART_DMA_STREAM(DMA1, 4, 4, 45U),
+    .dma_tx = UART_DMA_STREAM(DMA1, 5, 5, 46U),
+    .tx_buf = uart3_tx_buf,
+    .tx_size = UART_TX_BUFFER_SIZE,
+    .rx_buf = uart3_rx_buf,
+    .rx_size = UART_RX_BUFFER_SIZE,
+    .state = &uart3_state,
+};
+
+DEV_UART_INSTANCE(3)
+
+void USART3_IRQHandler(void) {
+    CPULOAD_IRQ_ENTER();
+    uart_port_irq(&uart3_port);
+    CPULOAD_IRQ_EXIT();
+}
+
+void DMA1_Stream4_IRQHandler(void) {
+    CPULOAD_IRQ_ENTER();
+    uart_port_dma_rx_irq(&uart3_port);
+    CPULOAD_IRQ_EXIT();
+}
+
+void DMA1_Stream5_IRQHandler(void) {
+    CPULOAD_IRQ_ENTER();
+    uart_port_dma_tx_irq(&uart3_port);
+    CPULOAD_IRQ_EXIT();
+}
+#endif /* DEV_UART_USE_UART3 */
+
+#if DEV_UART_USE_UART4
+// UART4: TX PA0, RX PA1, AF8; RTS PA15, CTS PB0, AF8
+RAM_D1_DMA static uint8_t uart4_tx_buf[UART_TX_BUFFER_SIZE];
+RAM_D1_DMA static volatile uint8_t uart4_rx_buf[UART_RX_BUFFER_SIZE];
+static uart_state_t uart4_state;
+
+static const uart_port_t uart4_port = {
+    .usart = UART4,
+    .irq = UART4_IRQn,
+    .irq_prio = UART_IRQ_PRIO,
+    .rcc_enr = &RCC->APB1LENR,
+    .rcc_en = RCC_APB1LENR_UART4EN,
+    .ker_sel = RCC_D2CCIP2R_USART28SEL,
+    .tx_pin = { GPIOA, 0U, 8U },
+    .rx_pin = { GPIOA, 1U, 8U },
+    .rts_pin = { GPIOA, 15U, 8U },
+    .cts_pin = { GPIOB, 0U, 8U },
+    .dma_rx = UART_DMA_STREAM(DMA1, 6, 6, 63U),
+    .dma_tx = UART_DMA_STREAM(DMA1, 7, 7, 64U),
+    .tx_buf = uart4_tx_buf,
+    .tx_size = UART_TX_BUFFER_SIZE,
+    .rx_buf = uart4_rx_buf,
+    .rx_size = UART_RX_BUFFER_SIZE,
+    .state = &uart4_state,
+};
+
+DEV_UART_INSTANCE(4)
+
+void UART4_IRQHandler(void) {
+    CPULOAD_IRQ_ENTER();
+    uart_port_irq(&uart4_port);
+    CPULOAD_IRQ_EXIT();
+}
+
+void DMA1_Stream6_IRQHandler(void) {
+    CPULOAD_IRQ_ENTER();
+    uart_port_dma_rx_irq(&uart4_port);
+    CPULOAD_IRQ_EXIT();
+}
+
+void DMA1_Stream7_IRQHandler(void) {
+    CPULOAD_IRQ_ENTER();
+    uart_port_dma_tx_irq(&uart4_port);
+    CPULOAD_IRQ_EXIT();
+}
+#endif /* DEV_UART_USE_UART4 */
+
+#if DEV_UART_USE_UART5
+// UART5: TX PC12, RX PD2, AF8; RTS PC8, CTS PC9, AF8
+RAM_D1_DMA static uint8_t uart5_tx_buf[UART_TX_BUFFER_SIZE];
+RAM_D1_DMA static volatile uint8_t uart5_rx_buf[UART_RX_BUFFER_SIZE];
+static uart_state_t uart5_state;
+
+static const uart_port_t uart5_port = {
+    .usart = UART5,
+    .irq = UART5_IRQn,
+    .irq_prio = UART_IRQ_PRIO,
+    .rcc_enr = &RCC->APB1LENR,
+    .rcc_en = RCC_APB1LENR_UART5EN,
+    .ker_sel = RCC_D2CCIP2R_USART28SEL,
+    .tx_pin = { GPIOC, 12U, 8U },
+    .rx_pin = { GPIOD, 2U, 8U },
+    .rts_pin = { GPIOC, 8U, 8U },
+    .cts_pin = { GPIOC, 9U, 8U },
+    .dma_rx = UART_DMA_STREAM(DMA2, 0, 8, 65U),
+    .dma_tx = UART_DMA_STREAM(DMA2, 1, 9, 66U),
+    .tx_buf = uart5_tx_buf,
+    .tx_size = UART_TX_BUFFER_SIZE,
+    .rx_buf = uart5_rx_buf,
+    .rx_size = UART_RX_BUFFER_SIZE,
+    .state = &uart5_state,
+};
+
+DEV_UART_INSTANCE(5)
+
+void UART5_IRQHandler(void) {
+    CPULOAD_IRQ_ENTER();
+    uart_port_irq(&uart5_port);
+    CPULOAD_IRQ_EXIT();
+}
+
+void DMA2_Stream0_IRQHandler(void) {
+    CPULOAD_IRQ_ENTER();
+    uart_port_dma_rx_irq(&uart5_port);
+    CPULOAD_IRQ_EXIT();
+}
+
+void DMA2_Stream1_IRQHandler(void) {
+    CPULOAD_IRQ_ENTER();
+    uart_port_dma_tx_irq(&uart5_port);
+    CPULOAD_IRQ_EXIT();
+}
+#endif /* DEV_UART_USE_UART5 */
+
+#if DEV_UART_USE_UART6
+// USART6: TX PC6, RX PC7, AF7; RTS PG8, CTS PG13, AF7
+RAM_D1_DMA static uint8_t uart6_tx_buf[UART_TX_BUFFER_SIZE];
+RAM_D1_DMA static volatile uint8_t uart6_rx_buf[UART_RX_BUFFER_SIZE];
+static uart_state_t uart6_state;
+
+static const uart_port_t uart6_port = {
+    .usart = USART6,
+    .irq = USART6_IRQn,
+    .irq_prio = UART_IRQ_PRIO,
+    .rcc_enr = &RCC->APB2ENR,
+    .rcc_en = RCC_APB2ENR_USART6EN,
+    .ker_sel = RCC_D2CCIP2R_USART16SEL,
+    .tx_pin = { GPIOC, 6U, 7U },
+    .rx_pin = { GPIOC, 7U, 7U },
+    .rts_pin = { GPIOG, 8U, 7U },
+    .cts_pin = { GPIOG, 13U, 7U },
+    .dma_rx = UART_DMA_STREAM(DMA2, 2, 10, 71U),
+    .dma_tx = UART_DMA_STREAM(DMA2, 3, 11, 72U),
+    .tx_buf = uart6_tx_buf,
+    .tx_size = UART_TX_BUFFER_SIZE,
+    .rx_buf = uart6_rx_buf,
+    .rx_size = UART_RX_BUFFER_SIZE,
+    .state = &uart6_state,
+};
+
+DEV_UART_INSTANCE(6)
+
+void USART6_IRQHandler(void) {
+    CPULOAD_IRQ_ENTER();
+    uart_port_irq(&uart6_port);
+    CPULOAD_IRQ_EXIT();
+}
+
+void DMA2_Stream2_IRQHandler(void) {
+    CPULOAD_IRQ_ENTER();
+    uart_port_dma_rx_irq(&uart6_port);
+    CPULOAD_IRQ_EXIT();
+}
+
+void DMA2_Stream3_IRQHandler(void) {
+    CPULOAD_IRQ_ENTER();
+    uart_port_dma_tx_irq(&uart6_port);
+    CPULOAD_IRQ_EXIT();
+}
+#endif /* DEV_UART_USE_UART6 */
+
+#if DEV_UART_USE_UART7
+// UART7: TX PE8, RX PE7, AF7; RTS PE9, CTS PE10, AF7
+RAM_D1_DMA static uint8_t uart7_tx_buf[UART_TX_BUFFER_SIZE];
+RAM_D1_DMA static volatile uint8_t uart7_rx_buf[UART_RX_BUFFER_SIZE];
+static uart_state_t uart7_state;
+
+static const uart_port_t uart7_port = {
+    .usart = UART7,
+    .irq = UART7_IRQn,
+    .irq_prio = UART_IRQ_PRIO,
+    .rcc_enr = &RCC->APB1LENR,
+    .rcc_en = RCC_APB1LENR_UART7EN,
+    .ker_sel = RCC_D2CCIP2R_USART28SEL,
+    .tx_pin = { GPIOE, 8U, 7U },
+    .rx_pin = { GPIOE, 7U, 7U },
+    .rts_pin = { GPIOE, 9U, 7U },
+    .cts_pin = { GPIOE, 10U, 7U },
+    .dma_rx = UART_DMA_STREAM(DMA2, 4, 12, 79U),
+    .dma_tx = UART_DMA_STREAM(DMA2, 5, 13, 80U),
+    .tx_buf = uart7_tx_buf,
+    .tx_size = UART_TX_BUFFER_SIZE,
+    .rx_buf = uart7_rx_buf,
+    .rx_size = UART_RX_BUFFER_SIZE,
+    .state = &uart7_state,
+};
+
+DEV_UART_INSTANCE(7)
+
+void UART7_IRQHandler(void) {
+    CPULOAD_IRQ_ENTER();
+    uart_port_irq(&uart7_port);
+    CPULOAD_IRQ_EXIT();
+}
+
+void DMA2_Stream4_IRQHandler(void) {
+    CPULOAD_IRQ_ENTER();
+    uart_port_dma_rx_irq(&uart7_port);
+    CPULOAD_IRQ_EXIT();
+}
+
+void DMA2_Stream5_IRQHandler(void) {
+    CPULOAD_IRQ_ENTER();
+    uart_port_dma_tx_irq(&uart7_port);
+    CPULOAD_IRQ_EXIT();
+}
+#endif /* DEV_UART_USE_UART7 */
+
+#if DEV_UART_USE_UART8
+// UART8: TX PE1, RX PE0, AF8; RTS PD15, CTS PD14, AF8
+RAM_D1_DMA static uint8_t uart8_tx_buf[UART_TX_BUFFER_SIZE];
+RAM_D1_DMA static volatile uint8_t uart8_rx_buf[UART_RX_BUFFER_SIZE];
+static uart_state_t uart8_state;
+
+static const uart_port_t uart8_port = {
+    .usart = UART8,
+    .irq = UART8_IRQn,
+    .irq_prio = UART_IRQ_PRIO,
+    .rcc_enr = &RCC->APB1LENR,
+    .rcc_en = RCC_APB1LENR_UART8EN,
+    .ker_sel = RCC_D2CCIP2R_USART28SEL,
+    .tx_pin = { GPIOE, 1U, 8U },
+    .rx_pin = { GPIOE, 0U, 8U },
+    .rts_pin = { GPIOD, 15U, 8U },
+    .cts_pin = { GPIOD, 14U, 8U },
+    .dma_rx = UART_DMA_STREAM(DMA2, 6, 14, 81U),
+    .dma_tx = UART_DMA_STREAM(DMA2, 7, 15, 82U),
+    .tx_buf = uart8_tx_buf,
+    .tx_size = UART_TX_BUFFER_SIZE,
+    .rx_buf = uart8_rx_buf,
+    .rx_size = UART_RX_BUFFER_SIZE,
+    .state = &uart8_state,
+};
+
+DEV_UART_INSTANCE(8)
+
+void UART8_IRQHandler(void) {
+    CPULOAD_IRQ_ENTER();
+    uart_port_irq(&uart8_port);
+    CPULOAD_IRQ_EXIT();
+}
+
+void DMA2_Stream6_IRQHandler(void) {
+    CPULOAD_IRQ_ENTER();
+    uart_port_dma_rx_irq(&uart8_port);
+    CPULOAD_IRQ_EXIT();
+}
+
+void DMA2_Stream7_IRQHandler(void) {
+    CPULOAD_IRQ_ENTER();
+    uart_port_dma_tx_irq(&uart8_port);
+    CPULOAD_IRQ_EXIT();
+}
+#endif /* DEV_UART_USE_UART8 */
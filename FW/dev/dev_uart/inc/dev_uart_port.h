@@ -0,0 +1,139 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * dev_uart_port.h - USART/DMA port descriptor for the generic UART driver
+ * 
+ * Copyright (c) 2025 Michael Kaa
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef DEV_UART_PORT_H
+#define DEV_UART_PORT_H
+
+#include <stdint.h>
+#include "dev_uart.h"
+#include "stm32h743xx.h"
+
+// DMA stream flags, relative to the stream position in LISR/HISR
+#define UART_DMA_FEIF   (1U << 0)
+#define UART_DMA_DMEIF  (1U << 2)
+#define UART_DMA_TEIF   (1U << 3)
+#define UART_DMA_HTIF   (1U << 4)
+#define UART_DMA_TCIF   (1U << 5)
+#define UART_DMA_ALL    (UART_DMA_FEIF | UART_DMA_DMEIF | UART_DMA_TEIF | UART_DMA_HTIF | UART_DMA_TCIF)
+
+typedef struct uart_pin {
+    GPIO_TypeDef *gpio;
+    uint8_t pin;
+    uint8_t af;
+} uart_pin_t;
+
+typedef struct uart_dma {
+    DMA_Stream_TypeDef *stream;
+    DMAMUX_Channel_TypeDef *mux;
+    volatile uint32_t *isr;      // LISR or HISR
+    volatile uint32_t *ifcr;     // LIFCR or HIFCR
+    uint32_t rcc_en;             // RCC->AHB1ENR bit of the controller
+    IRQn_Type irq;
+    uint8_t request;             // DMAMUX request ID
+    uint8_t shift;               // stream flag position
+} uart_dma_t;
+
+// BRR/PRESC/OVER8 setting for a baudrate
+typedef struct uart_baud {
+    uint32_t brr;
+    uint32_t actual;
+    int32_t error_ppm;
+    uint8_t presc;               // USART_PRESC encoding
+    uint8_t over8;
+} uart_baud_t;
+
+// Runtime state of one port
+typedef struct uart_state {
+    // RX ring, see uart_rx_update()
+    volatile uint32_t rx_head;
+    volatile uint32_t rx_tail;
+    volatile uint32_t rx_wraps;
+    volatile uint32_t rx_last_idx;
+    volatile uint8_t rx_blocking;
+    uart_rx_notify_t rx_notify;
+
+    // TX descriptor ring, head/tail are free running counters
+    uart_tx_desc_t tx_queue[UART_TX_QUEUE_LEN];
+    volatile uint32_t tx_head;
+    volatile uint32_t tx_tail;
+    volatile uint32_t tx_offset;
+    volatile uint32_t tx_chunk;
+    volatile uint8_t tx_in_progress;
+    volatile uint8_t tx_bounce_busy;
+
+    // Soft RTS, see uart_rts_update()
+    uint32_t rts_high;
+    uint32_t rts_low;
+    volatile uint8_t rts_soft;
+    volatile uint8_t rts_off;
+
+    uint32_t baudrate;
+    uart_baud_t baud;
+    uart_config_t config;        // baudrate field unused, see baudrate
+    uart_stats_t stats;
+    uint8_t initialized;
+} uart_state_t;
+
+// Constant port description, one per USART
+typedef struct uart_port {
+    USART_TypeDef *usart;
+    IRQn_Type irq;
+    uint8_t irq_prio;
+    volatile uint32_t *rcc_enr;  // APB1LENR or APB2ENR
+    uint32_t rcc_en;
+    uint32_t ker_sel;            // D2CCIP2R kernel clock selection field
+    uart_pin_t tx_pin;
+    uart_pin_t rx_pin;
+    uart_pin_t rts_pin;          // gpio NULL if not routed
+    uart_pin_t cts_pin;
+    uart_dma_t dma_rx;
+    uart_dma_t dma_tx;
+    uint8_t *tx_buf;             // bounce buffer for TCM sources
+    uint32_t tx_size;
+    volatile uint8_t *rx_buf;    // circular DMA ring
+    uint32_t rx_size;            // power of two
+    uart_state_t *state;
+} uart_port_t;
+
+// Generic driver, called by the per-port instances
+int uart_port_open(const uart_port_t *port);
+int uart_port_close(const uart_port_t *port);
+int uart_port_read(const uart_port_t *port, void *buf, size_t count);
+int uart_port_write(const uart_port_t *port, const void *buf, size_t count);
+int uart_port_ioctrl(const uart_port_t *port, int cmd, void *arg);
+
+// Kernel clock and baudrate engine (dev_uart_baud.c)
+uart_clk_source_t uart_kernel_source(const uart_port_t *port);
+uint32_t uart_source_clock(const uart_port_t *port, uart_clk_source_t source);
+uint32_t uart_kernel_clock(const uart_port_t *port);
+int uart_baud_calc(uint32_t ker_clk, uint32_t baudrate, uart_baud_t *out);
+uint32_t uart_presc_div(uint8_t presc);
+
+// Interrupt handlers
+void uart_port_irq(const uart_port_t *port);
+void uart_port_dma_rx_irq(const uart_port_t *port);
+void uart_port_dma_tx_irq(const uart_port_t *port);
+
+#endif /* DEV_UART_PORT_H */
@@ -2,13 +2,12 @@
 // #include <stdio.h>
 
 #include "stm32h743xx.h"
-#include "memory_man.h"
 #include "ucmd.h"
-#include "uart_ping.h"
 // #include "rng_gen.h"
 
-int ucmd_mcu_reset(int argc, char** argv)
+int ucmd_mcu_reset(ucmd_session_t* s, int argc, char** argv)
 {
+    (void)s;
     (void)argc;
     (void)argv;
     
@@ -16,38 +15,6 @@ int ucmd_mcu_reset(int argc, char** argv)
     return -1;
 }
 
-// define command list
-command_t cmd_list[] = {
-    {
-        .cmd  = "help",
-        .help = "print available commands with their help text",
-        .fn   = print_help_cb,
-    },
+UCMD_REGISTER(reset, "reset", ucmd_mcu_reset, "reset mcu");
 
-    {
-        .cmd  = "reset",
-        .help = "reset mcu",
-        .fn   = ucmd_mcu_reset,
-    },
-
-    {
-      .cmd  = "mem",
-      .help = "memory man, use mem help",
-      .fn   = ucmd_mem,
-    },
-
-    {
-      .cmd  = "uping",
-      .help = "uart test utility",
-      .fn   = ucmd_uping,
-    },
-
-    //     {
-    //   .cmd  = "rng",
-    //   .help = "rng generate utility",
-    //   .fn   = ucmd_rng,
-    // },
-
-
-    {0}, // null list terminator DON'T FORGET THIS!
-};
+// UCMD_REGISTER(rng, "rng", ucmd_rng, "rng generate utility");
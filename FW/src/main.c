@@ -3,26 +3,80 @@
 
 #include "dev_list.h"
 #include "ucmd.h"
+#include "sched.h"
+#include "job.h"
+#include "systime.h"
+#include "cpuload.h"
+#include "syscalls.h"
+
+// A CLI session and the task that feeds it
+typedef struct console {
+    ucmd_session_t *session;
+    int task;
+} console_t;
+
+// Operator console on USART1 (stdio), automation console on USART2
+static console_t console = { .session = &ucmd_default, .task = -1 };
+static ucmd_session_t automation_session;
+static console_t automation = { .session = &automation_session, .task = -1 };
+
+// USART RX DMA/IDLE interrupt
+static void cli_rx_notify(void *ctx)
+{
+    sched_post(((console_t *)ctx)->task, SCHED_EV_RX);
+}
+
+// Feed the session until its input is empty
+static void cli_run(uint32_t events, void *ctx)
+{
+    (void)events;
+    while (ucmd_session_proc(((console_t *)ctx)->session) > 0) { }
+}
+
+// Sessions don't share anything, each one has its own task
+static int cli_start(console_t *c, const char *name, const interface_t *uart)
+{
+    c->task = sched_task_add(name, 4, cli_run, c);
+    if (c->task < 0) {
+        return c->task;
+    }
+    uart_rx_notify_t notify = { .fn = cli_rx_notify, .ctx = c };
+    uart->ioctrl(UART_SET_RX_NOTIFY, &notify);
+    sched_post(c->task, SCHED_EV_RX); // bytes received before the notify
+    return 0;
+}
 
 int main(void)
 {
     const interface_t* uart1 = dev_uart1_get();
     uart1->ioctrl(UART_INIT, NULL);
-    setvbuf(stdin, NULL, _IONBF, 0);  // Отключаем буферизацию stdin
     // setvbuf(stdout, NULL, _IONBF, 0); // Отключаем буферизацию stdout
     
     printf("Its work!!!\r\n");
 
     ucmd_default_init();
 
-    while (1)
-    {
-        ucmd_default_proc();
+    systime_init();
+    systimer_task_init(3);
+    cpuload_init();
 
-        for(volatile int i = 0; i < 100000; i++){
-            asm("nop");
-            asm("nop");
-            asm("nop");
-        }
+    // Long commands run as jobs below the CLI, Ctrl+C cancels them
+    job_init(6);
+    ucmd_set_sigint(job_sigint);
+
+    // CLI runs when RX data arrives, WFI otherwise
+    stdin_set_blocking(0);
+    cli_start(&console, "cli", uart1);
+
+#if DEV_UART_USE_UART2
+    // Same commands on USART2, with its own line editor, output and jobs
+    const interface_t* uart2 = dev_uart2_get();
+    if (uart2->ioctrl(UART_INIT, NULL) == 0 &&
+        ucmd_session_init(&automation_session, "uart2", uart2, NULL) == 0) {
+        ucmd_session_set_sigint(&automation_session, job_sigint);
+        cli_start(&automation, "cli2", uart2);
     }
+#endif
+
+    sched_run();
 }
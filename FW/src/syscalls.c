@@ -30,46 +30,299 @@
 #include <sys/time.h>
 #include <sys/times.h>
 #include <unistd.h>
+#include <string.h>
 
-#include "dev_uart1.h"
+#include "dev_uart.h"
+#include "syscalls.h"
+#include "stm32h743xx.h"
 
 char*  __env[1] = {0};
 char** environ  = __env;
 
+#if (STDOUT_BUFFER_SIZE & (STDOUT_BUFFER_SIZE - 1)) != 0
+#error "STDOUT_BUFFER_SIZE must be a power of two"
+#endif
+
+#define STDOUT_MASK (STDOUT_BUFFER_SIZE - 1U)
+
+// Largest DMA block, keeps something queued for drop-oldest to drop
+#define STDOUT_CHUNK (STDOUT_BUFFER_SIZE / 4U)
+
+static void stdout_tx_done(void* ctx);
+
+// stdout ring, free running counters: [tail, tail + inflight) is on the
+// wire, [rd, head) waits for DMA, [tail + inflight, rd) was dropped
+RAM_D1_DMA static char stdout_buf[STDOUT_BUFFER_SIZE];
+static volatile uint32_t stdout_head;
+static volatile uint32_t stdout_tail;
+static volatile uint32_t stdout_rd;
+static volatile uint32_t stdout_inflight;
+static volatile uint32_t stdout_drops;
+static stdout_policy_t stdout_policy = STDOUT_POLICY;
+
+static inline uint32_t stdout_lock(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    return primask;
+}
+
+// Queue the next contiguous block (irq locked or TX DMA ISR)
+static int stdout_kick(void)
+{
+    if (stdout_inflight || stdout_rd == stdout_head)
+    {
+        return 0;
+    }
+
+    // Skip what drop-oldest threw away
+    stdout_tail = stdout_rd;
+
+    uint32_t idx = stdout_rd & STDOUT_MASK;
+    uint32_t len = stdout_head - stdout_rd;
+    if (len > STDOUT_BUFFER_SIZE - idx)
+    {
+        len = STDOUT_BUFFER_SIZE - idx;
+    }
+    if (len > STDOUT_CHUNK)
+    {
+        len = STDOUT_CHUNK;
+    }
+
+    uart_tx_desc_t desc = {
+        .buf = &stdout_buf[idx],
+        .len = len,
+        .done = stdout_tx_done,
+        .ctx = NULL,
+    };
+    int ret = dev_uart1_get()->ioctrl(UART_TX_QUEUE, &desc);
+    if (ret == 0)
+    {
+        stdout_inflight = len;
+        stdout_rd += len;
+    }
+    return ret;
+}
+
+// TX DMA completion, keeps the ring draining without the writer
+static void stdout_tx_done(void* ctx)
+{
+    (void)ctx;
+    stdout_tail += stdout_inflight;
+    stdout_inflight = 0;
+    stdout_kick();
+}
+
+// Send everything queued without the TX DMA interrupt, see UART_TX_DRAIN.
+// A stalled line completes the ring unsent, which frees it as well
+static int stdout_drain(void)
+{
+    return dev_uart1_get()->ioctrl(UART_TX_DRAIN, NULL);
+}
+
+// Wait for room, returns -1 if the UART is gone
+static int stdout_make_room(uint32_t need)
+{
+    uint32_t primask = stdout_lock();
+
+    if (stdout_policy == stdout_drop_oldest)
+    {
+        // Drop the oldest queued bytes. The block on the wire can't be
+        // recalled, their space is reusable once it completes
+        uint32_t gap = stdout_rd - stdout_tail - stdout_inflight;
+        uint32_t queued = stdout_head - stdout_rd;
+        if (gap < need && queued)
+        {
+            uint32_t n = need - gap;
+            if (n > queued)
+            {
+                n = queued;
+            }
+            stdout_rd += n;
+            stdout_drops += n;
+            if (!stdout_inflight)
+            {
+                stdout_tail = stdout_rd;
+            }
+        }
+    }
+
+    int ret = stdout_kick();
+    if (ret == -ENODEV)
+    {
+        __set_PRIMASK(primask);
+        return -1;
+    }
+
+    if (STDOUT_BUFFER_SIZE - (stdout_head - stdout_tail) == 0)
+    {
+        if (primask)
+        {
+            // Masked by the caller, the TX DMA ISR would never run and
+            // WFI would return forever: the driver completes in place
+            __set_PRIMASK(primask);
+            return (stdout_drain() == -ENODEV) ? -1 : 0;
+        }
+        // Sleep until TX DMA completes (pending IRQ wakes WFI with PRIMASK set)
+        __WFI();
+    }
+    __set_PRIMASK(primask);
+    return 0;
+}
+
 int _write(int file, char* ptr, int len)
 {
-    (void) ptr;
-    (void) len;
-    if (file == STDOUT_FILENO || file == STDERR_FILENO)
+    if (file != STDOUT_FILENO && file != STDERR_FILENO)
     {
-        dev_uart1_get()->write(ptr, len);
+        errno = EIO;
         return -1;
     }
-    errno = EIO;
-    return -1;
+
+    int done = 0;
+    while (done < len)
+    {
+        // Only this side moves head, the ISR can only free more space
+        uint32_t head = stdout_head;
+        uint32_t room = STDOUT_BUFFER_SIZE - (head - stdout_tail);
+
+        if (room == 0)
+        {
+            if (stdout_policy == stdout_drop_newest)
+            {
+                stdout_drops += (uint32_t)(len - done);
+                uint32_t primask = stdout_lock();
+                stdout_kick(); // in case the TX ring was full last time
+                __set_PRIMASK(primask);
+                break;
+            }
+            uint32_t need = (uint32_t)(len - done);
+            if (need > STDOUT_BUFFER_SIZE)
+            {
+                need = STDOUT_BUFFER_SIZE;
+            }
+            if (stdout_make_room(need) < 0)
+            {
+                errno = EIO;
+                return done ? done : -1;
+            }
+            continue;
+        }
+
+        uint32_t idx = head & STDOUT_MASK;
+        uint32_t n = (uint32_t)(len - done);
+        if (n > room)
+        {
+            n = room;
+        }
+        if (n > STDOUT_BUFFER_SIZE - idx)
+        {
+            n = STDOUT_BUFFER_SIZE - idx;
+        }
+
+        memcpy(&stdout_buf[idx], ptr + done, n);
+        done += (int)n;
+
+        uint32_t primask = stdout_lock();
+        stdout_head = head + n;
+        stdout_kick();
+        __set_PRIMASK(primask);
+    }
+
+    // Dropped bytes count as written, stdio must not retry them
+    return len;
 }
 
-// Что то мне подсказывает, что это нечто кривое получилось. Но оно работает.
-int __io_getchar(void)
+int stdout_flush(void)
 {
-    uint8_t ch = 0;
-    dev_uart1_get()->read(&ch, 1);
-    return ch;
+    while (stdout_head != stdout_tail)
+    {
+        uint32_t primask = stdout_lock();
+        int ret = stdout_kick();
+        if (ret == -ENODEV)
+        {
+            __set_PRIMASK(primask);
+            return ret;
+        }
+        if (stdout_head != stdout_tail)
+        {
+            if (primask)
+            {
+                __set_PRIMASK(primask);
+                ret = stdout_drain();
+                if (ret == -ENODEV)
+                {
+                    return ret;
+                }
+                continue;
+            }
+            __WFI();
+        }
+        __set_PRIMASK(primask);
+    }
+    return 0;
 }
 
+void stdout_set_policy(stdout_policy_t policy)
+{
+    stdout_policy = policy;
+}
+
+uint32_t stdout_dropped(void)
+{
+    return stdout_drops;
+}
+
+// stdin mode is pushed to USART1 on the first read after a change
+static volatile uint8_t stdin_blocking = STDIN_BLOCKING;
+static volatile uint8_t stdin_mode_dirty = 1;
 
+void stdin_set_blocking(int blocking)
+{
+    stdin_blocking = blocking ? 1 : 0;
+    stdin_mode_dirty = 1;
+}
+
+// Returns everything already received (up to len). Blocking mode sleeps
+// in WFI until RX DMA/IDLE publishes data, non-blocking fails with EAGAIN
 int _read(int file, char* ptr, int len)
 {
-    if (file == STDIN_FILENO)
+    if (file != STDIN_FILENO)
     {
-        for (int DataIdx = 0; DataIdx < len; DataIdx++)
-        {
-            *ptr++ = (char)__io_getchar();
-        }
-        return len;
+        errno = EIO;
+        return -1;
     }
-    errno = EIO;
-    return -1;
+
+    const interface_t* uart = dev_uart1_get();
+
+    if (stdin_mode_dirty)
+    {
+        int mode = stdin_blocking;
+        uart->ioctrl(UART_SET_RX_BLOCKING, &mode);
+        stdin_mode_dirty = 0;
+    }
+
+    int ret = uart->read(ptr, (size_t)len);
+    if (ret < 0)
+    {
+        errno = -ret;
+        return -1;
+    }
+    if (ret == 0 && len > 0)
+    {
+        errno = EAGAIN;
+        return -1;
+    }
+    return ret;
+}
+
+int __io_getchar(void)
+{
+    uint8_t ch = 0;
+    if (_read(STDIN_FILENO, (char*)&ch, 1) != 1)
+    {
+        return EOF;
+    }
+    return ch;
 }
 
 
@@ -0,0 +1,47 @@
+/**
+ * @file syscalls.h
+ * @brief Buffered stdout and blocking stdin on USART1
+ *
+ * printf output goes into a ring drained by the USART1 TX DMA, _write
+ * returns as soon as the bytes are copied. What happens when the ring
+ * is full is set by the policy. Blocking with interrupts masked (fault
+ * handlers, irq locked sections) polls the TX DMA instead of sleeping.
+ */
+
+#ifndef _SYSCALLS_H
+#define _SYSCALLS_H
+
+#include <stdint.h>
+
+// Ring size in AXI SRAM (power of two)
+#ifndef STDOUT_BUFFER_SIZE
+#define STDOUT_BUFFER_SIZE 4096
+#endif
+
+typedef enum {
+    stdout_block       = 0, // wait for TX DMA
+    stdout_drop_oldest = 1, // discard queued output not yet on the wire
+    stdout_drop_newest = 2  // discard what doesn't fit
+} stdout_policy_t;
+
+// Policy at startup
+#ifndef STDOUT_POLICY
+#define STDOUT_POLICY stdout_block
+#endif
+
+// Wait until everything written is sent, -ENODEV if USART1 isn't open
+int stdout_flush(void);
+
+void stdout_set_policy(stdout_policy_t policy);
+
+// Bytes discarded by the drop policies
+uint32_t stdout_dropped(void);
+
+// stdin read sleeps until data arrives (1) or fails with EAGAIN (0)
+#ifndef STDIN_BLOCKING
+#define STDIN_BLOCKING 1
+#endif
+
+void stdin_set_blocking(int blocking);
+
+#endif /* _SYSCALLS_H */
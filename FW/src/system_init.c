@@ -2,6 +2,11 @@
 #include "dev_mco1.h"
 #include "dev_mco2.h"
 
+// Run with I/D caches, drivers keep their DMA buffers coherent
+#ifndef SYSTEM_USE_CACHE
+#define SYSTEM_USE_CACHE 1
+#endif
+
 uint32_t SystemCoreClock = 0;
 
 void enable_mco1(void);
@@ -76,6 +81,11 @@ void SystemInit(void)
 
     SystemCoreClock = 480000000U;
 
+#if SYSTEM_USE_CACHE
+    SCB_EnableICache();
+    SCB_EnableDCache();
+#endif
+
     // Есть взаимное влияние делителей MCO, вероятно ошибка в том, что mco2_prescaler максимум 8, но не проверял...
     // enable mco1
     // dev_mco1_config_t mco1_setings = {.source = mco1_source_hse, .prescaler = mco1_prescaler_4};
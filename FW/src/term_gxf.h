@@ -42,4 +42,10 @@
 #define resetcolor()             printf(ESC "[0m")
 #define set_display_atrib(color) printf(ESC "[%dm", color)
 
+// Same, to a stream (CLI session output)
+#define fclrscr(f)                   fprintf(f, ESC "[2J")
+#define fgotoxy(f, x, y)             fprintf(f, ESC "[%d;%dH", y, x)
+#define fresetcolor(f)               fprintf(f, ESC "[0m")
+#define fset_display_atrib(f, color) fprintf(f, ESC "[%dm", color)
+
 #endif /*__TERM_GFX__*/
\ No newline at end of file
@@ -0,0 +1,107 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * cmsis_host.c - Host side of the Cortex-M7 stub, see stub/stm32h743xx.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include "stm32h743xx.h"
+
+// Peripheral space, D1/D2/D3 domains up to the debug components
+#define HOST_PERIPH_BASE  (0x40000000UL)
+#define HOST_PERIPH_SIZE  (0x20000000UL)
+
+#define HOST_IRQ_MAX      (160U)
+
+uint32_t SystemCoreClock = 64000000U;
+uint32_t SystemD2Clock = 64000000U;
+
+SysTick_Type host_systick;
+SCB_Type host_scb;
+DWT_Type host_dwt;
+CoreDebug_Type host_coredebug;
+
+static uint32_t host_primask;
+static uint8_t host_pending[HOST_IRQ_MAX];
+static uint8_t host_enabled[HOST_IRQ_MAX];
+static host_irq_handler_t host_handler[HOST_IRQ_MAX];
+static void (*host_wfi)(void);
+
+// Registers read as zero until the drivers or a test write them
+__attribute__((constructor)) static void host_periph_map(void) {
+    void *p = mmap((void *)HOST_PERIPH_BASE, HOST_PERIPH_SIZE, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE | MAP_NORESERVE, -1, 0);
+
+    if (p != (void *)HOST_PERIPH_BASE) {
+        fprintf(stderr, "cmsis_host: can't map peripherals at 0x%lx\n", HOST_PERIPH_BASE);
+        exit(2);
+    }
+}
+
+static void host_irq_run(void) {
+    for (uint32_t n = 0; n < HOST_IRQ_MAX && !host_primask; n++) {
+        if (host_pending[n] && host_enabled[n]) {
+            host_pending[n] = 0;
+            if (host_handler[n] != NULL) {
+                host_handler[n]();
+            }
+        }
+    }
+}
+
+void host_irq_attach(IRQn_Type irq, host_irq_handler_t handler) {
+    host_handler[irq] = handler;
+}
+
+void host_irq_pend(IRQn_Type irq) {
+    host_pending[irq] = 1;
+    host_irq_run();
+}
+
+void host_wfi_hook(void (*hook)(void)) {
+    host_wfi = hook;
+}
+
+uint32_t __get_PRIMASK(void) {
+    return host_primask;
+}
+
+void __set_PRIMASK(uint32_t primask) {
+    host_primask = primask & 1U;
+    host_irq_run();
+}
+
+void __disable_irq(void) {
+    host_primask = 1;
+}
+
+void __enable_irq(void) {
+    __set_PRIMASK(0);
+}
+
+// The hardware runs while the core sleeps
+void __WFI(void) {
+    if (host_wfi != NULL) {
+        host_wfi();
+    }
+    host_irq_run();
+}
+
+void NVIC_EnableIRQ(IRQn_Type irq) {
+    host_enabled[irq] = 1;
+    host_irq_run();
+}
+
+void NVIC_DisableIRQ(IRQn_Type irq) {
+    host_enabled[irq] = 0;
+}
+
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority) {
+    (void)irq;
+    (void)priority;
+}
+
+void NVIC_ClearPendingIRQ(IRQn_Type irq) {
+    host_pending[irq] = 0;
+}
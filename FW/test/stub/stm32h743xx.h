@@ -0,0 +1,114 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * stm32h743xx.h - Host build of the device header for the unit tests
+ *
+ * Pulls in the real register map, replaces the Cortex-M7 core part
+ * (core_cm7.h) with host versions of the intrinsics the drivers use.
+ * Peripheral space is mapped at its real address (cmsis_host.c), so
+ * the drivers run unchanged and a test plays the hardware side.
+ * Interrupts are modelled by PRIMASK and a pending mask: a pended IRQ
+ * runs its handler as soon as PRIMASK is clear, WFI calls the hook
+ * the test installs to advance the simulated hardware.
+ */
+
+#ifndef TEST_STUB_STM32H743XX_H
+#define TEST_STUB_STM32H743XX_H
+
+#include <stdint.h>
+
+#define __CORE_CM7_H_GENERIC
+#define __CORE_CM7_H_DEPENDANT
+
+#define __I     volatile const
+#define __O     volatile
+#define __IO    volatile
+#define __IM    volatile const
+#define __OM    volatile
+#define __IOM   volatile
+
+#include "../../CMSIS/stm32h743xx.h"
+
+#define __SCB_DCACHE_LINE_SIZE  32U
+
+// Interrupt model
+typedef void (*host_irq_handler_t)(void);
+
+void host_irq_attach(IRQn_Type irq, host_irq_handler_t handler);
+void host_irq_pend(IRQn_Type irq);
+void host_wfi_hook(void (*hook)(void));
+
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t primask);
+void __disable_irq(void);
+void __enable_irq(void);
+void __WFI(void);
+
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority);
+void NVIC_ClearPendingIRQ(IRQn_Type irq);
+
+// Core peripherals are plain memory, a test writes what the hardware
+// would (SysTick->VAL, SCB->ICSR pending bits, DWT->CYCCNT)
+typedef struct {
+    __IOM uint32_t CTRL;
+    __IOM uint32_t LOAD;
+    __IOM uint32_t VAL;
+    __IM uint32_t CALIB;
+} SysTick_Type;
+
+typedef struct {
+    __IM uint32_t CPUID;
+    __IOM uint32_t ICSR;
+} SCB_Type;
+
+typedef struct {
+    __IOM uint32_t CTRL;
+    __IOM uint32_t CYCCNT;
+    __OM uint32_t LAR;
+} DWT_Type;
+
+typedef struct {
+    __IOM uint32_t DEMCR;
+} CoreDebug_Type;
+
+extern SysTick_Type host_systick;
+extern SCB_Type host_scb;
+extern DWT_Type host_dwt;
+extern CoreDebug_Type host_coredebug;
+
+#define SysTick   (&host_systick)
+#define SCB       (&host_scb)
+#define DWT       (&host_dwt)
+#define CoreDebug (&host_coredebug)
+
+#define SysTick_CTRL_ENABLE_Msk     (1UL << 0)
+#define SysTick_CTRL_TICKINT_Msk    (1UL << 1)
+#define SysTick_CTRL_CLKSOURCE_Msk  (1UL << 2)
+#define SysTick_LOAD_RELOAD_Msk     (0xFFFFFFUL)
+#define SCB_ICSR_PENDSTSET_Msk      (1UL << 26)
+#define DWT_CTRL_CYCCNTENA_Msk      (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk  (1UL << 24)
+
+// Host memory is coherent, cache maintenance has nothing to do
+static inline void SCB_CleanDCache_by_Addr(volatile void *addr, int32_t size) {
+    (void)addr;
+    (void)size;
+}
+
+static inline void SCB_InvalidateDCache_by_Addr(volatile void *addr, int32_t size) {
+    (void)addr;
+    (void)size;
+}
+
+static inline void SCB_CleanInvalidateDCache_by_Addr(volatile void *addr, int32_t size) {
+    (void)addr;
+    (void)size;
+}
+
+static inline void __DSB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __ISB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __NOP(void) { }
+static inline uint32_t __REV(uint32_t value) { return __builtin_bswap32(value); }
+
+#endif /* TEST_STUB_STM32H743XX_H */
@@ -0,0 +1,27 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * test.h - Minimal checks for the host unit tests
+ */
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+
+static int test_failed;
+static int test_checks;
+
+#define CHECK(cond) do {                                                    \
+    test_checks++;                                                          \
+    if (!(cond)) {                                                          \
+        test_failed++;                                                      \
+        printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);     \
+    }                                                                       \
+} while (0)
+
+static inline int test_summary(const char *name) {
+    printf("%s: %d checks, %d failed\n", name, test_checks, test_failed);
+    return test_failed ? 1 : 0;
+}
+
+#endif /* TEST_H */
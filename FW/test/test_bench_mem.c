@@ -0,0 +1,57 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * test_bench_mem.c - bench mem on the host heap
+ *
+ * bench_mem.c is included for its static command. Without BAREMETAL
+ * there is one region, the heap, measured on the CPU only; the rows the
+ * MDMA would add are left out.
+ */
+
+#include "../app/bench/bench_mem.c"
+#include "test.h"
+
+static char out[0x4000];
+
+static int run(const char *line) {
+    char buf[64];
+    char *argv[4];
+    int argc = 0;
+
+    snprintf(buf, sizeof(buf), "%s", line);
+    for (char *w = strtok(buf, " "); w && argc < 4; w = strtok(NULL, " ")) {
+        argv[argc++] = w;
+    }
+
+    ucmd_session_t s = {.name = "host"};
+    s.out = fmemopen(out, sizeof(out), "w");
+    int ret = ucmd_cmd_bench_mem.fn(&s, argc, argv);
+    fclose(s.out);
+    return ret;
+}
+
+static int count(const char *what) {
+    int n = 0;
+
+    for (const char *p = out; (p = strstr(p, what)) != NULL; p++) {
+        n++;
+    }
+    return n;
+}
+
+int main(void) {
+    // 4 widths of read and write, copy and fill, chase
+    CHECK(run("mem heap table") == 0);
+    CHECK(count("heap    on ") == 4 + 4 + 2 + 1);
+    CHECK(count("csv") == 0);
+    CHECK(bench_mem_run_state.count == 11);
+    fputs(out, stdout);
+
+    CHECK(run("mem all csv") == 0);
+    CHECK(count("csv,heap,on,") == 11);
+    CHECK(count("csv,heap,on,chase,cpu,") == 1);
+    CHECK(count("MB/s") == 0);
+
+    CHECK(run("mem ram_d1") == -EINVAL);
+
+    return test_summary("bench_mem");
+}
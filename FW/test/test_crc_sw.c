@@ -0,0 +1,129 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * test_crc_sw.c - Software CRC against a bit at a time reference
+ *
+ * Every model at all alignments and lengths up to 64, in one piece and
+ * in two, then byte at a time against slice-by-8 over 4 MB.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "crc_sw.h"
+#include "test.h"
+
+static uint32_t ref_reflect(uint32_t v, uint32_t width) {
+    uint32_t r = 0;
+
+    for (uint32_t i = 0; i < width; i++, v >>= 1) {
+        r = (r << 1) | (v & 1U);
+    }
+    return r;
+}
+
+// The catalogue definition, one bit per step
+static uint32_t crc_bitwise(const crc_cfg_t *m, const uint8_t *p, size_t len) {
+    uint32_t mask = 0xFFFFFFFFU >> (32U - m->width);
+    uint32_t top = 1U << (m->width - 1U);
+    uint32_t reg = m->init & mask;
+
+    for (size_t i = 0; i < len; i++) {
+        uint32_t b = m->refin ? ref_reflect(p[i], 8) : p[i];
+        for (int k = 7; k >= 0; k--) {
+            uint32_t msb = (reg & top) != 0;
+            reg = (reg << 1) & mask;
+            if (msb ^ ((b >> k) & 1U)) {
+                reg ^= m->poly & mask;
+            }
+        }
+    }
+    if (m->refout) {
+        reg = ref_reflect(reg, m->width);
+    }
+    return (reg ^ m->xorout) & mask;
+}
+
+static uint32_t crc_bytewise(const crc_sw_t *c, const uint8_t *p, size_t len) {
+    uint32_t reg = crc_sw_start(c);
+
+    while (len--) {
+        reg = c->cfg.refin ? c->table[0][(reg ^ *p++) & 0xFFU] ^ (reg >> 8)
+                           : (reg << 8) ^ c->table[0][(reg >> 24) ^ *p++];
+    }
+    return crc_sw_final(c, reg);
+}
+
+static double bench_now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static crc_sw_t c;
+
+static void test_models(void) {
+    static uint8_t buf[72];
+
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = (uint8_t)rand();
+    }
+
+    for (int m = 0; crc_model_names[m]; m++) {
+        const crc_cfg_t *cfg = &crc_models[m].cfg;
+        int before = test_failed;
+
+        CHECK(crc_sw_init(&c, cfg) == 0);
+        CHECK(crc_sw_calc(&c, "123456789", 9) == crc_models[m].check);
+        CHECK(crc_bitwise(cfg, (const uint8_t *)"123456789", 9) == crc_models[m].check);
+        for (size_t off = 0; off < 8U; off++) {
+            for (size_t len = 0; off + len <= 64U; len++) {
+                uint32_t ref = crc_bitwise(cfg, buf + off, len);
+                // In one piece and in two
+                uint32_t reg = crc_sw_update(&c, crc_sw_start(&c), buf + off, len / 3U);
+                reg = crc_sw_update(&c, reg, buf + off + len / 3U, len - len / 3U);
+                CHECK(crc_sw_calc(&c, buf + off, len) == ref);
+                CHECK(crc_sw_final(&c, reg) == ref);
+            }
+        }
+        printf("%-13s check %08x %s\n", crc_model_names[m], crc_models[m].check,
+               test_failed != before ? "FAIL" : "ok");
+    }
+    CHECK(crc32_update(crc32_update(0, "1234", 4), "56789", 5) == 0xCBF43926U);
+}
+
+static void bench_models(void) {
+    const size_t big = 4U * 1024U * 1024U;
+    uint8_t *data = malloc(big);
+
+    for (size_t i = 0; i < big; i++) {
+        data[i] = (uint8_t)rand();
+    }
+    for (int m = 0; m < 4; m += 3) {
+        const int reps = 20;
+        volatile uint32_t sink = 0;
+
+        crc_sw_init(&c, &crc_models[m].cfg);
+        double t0 = bench_now();
+        for (int r = 0; r < reps; r++) {
+            sink ^= crc_bytewise(&c, data, big);
+        }
+        double t1 = bench_now();
+        for (int r = 0; r < reps; r++) {
+            sink ^= crc_sw_calc(&c, data, big);
+        }
+        double t2 = bench_now();
+        CHECK(crc_bytewise(&c, data + 1, big - 3U) == crc_sw_calc(&c, data + 1, big - 3U));
+        printf("%-13s byte %7.1f MB/s, slice-by-8 %7.1f MB/s\n", crc_model_names[m],
+               (double)big * reps / (t1 - t0) / 1e6, (double)big * reps / (t2 - t1) / 1e6);
+    }
+    free(data);
+}
+
+int main(void) {
+    srand(1);
+    test_models();
+    bench_models();
+
+    return test_summary("crc_sw");
+}
@@ -0,0 +1,166 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * test_hexdump.c - Table driven hexdump against the printf formatter
+ *
+ * Byte groups over data without repeats match the printf per byte
+ * formatter hexdump.c replaced. The bench dumps into a line buffered
+ * stream like a CLI session, counting the writes that reach the "UART".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include "hexdump.h"
+#include "test.h"
+
+static unsigned long bench_writes;
+static unsigned long bench_bytes;
+
+static void old_dump(FILE *out, const uint8_t *buf, uint32_t len) {
+    for (uint32_t pos = 0; pos < len; pos += 16) {
+        const uint8_t *line = buf + pos;
+        uint32_t bytes_printed = 0;
+
+        fprintf(out, "0x%08lx: ", (unsigned long)line);
+        for (uint32_t j = 0; j < 16; j++) {
+            if (pos + j < len) {
+                fprintf(out, "%02x ", line[j]);
+                bytes_printed++;
+            } else {
+                fprintf(out, "   ");
+            }
+        }
+        fprintf(out, "| ");
+        for (uint32_t j = 0; j < bytes_printed; j++) {
+            fputc((line[j] >= 32 && line[j] <= 126) ? line[j] : '.', out);
+        }
+        fprintf(out, "\n");
+    }
+}
+
+// Whole dump of @buf in @n byte steps, into a malloc'ed string
+static char *dump(const void *buf, uint32_t len, int group, uint32_t n) {
+    char *s = NULL;
+    size_t size;
+    FILE *out = open_memstream(&s, &size);
+    hexdump_t h;
+
+    CHECK(hexdump_init(&h, buf, len, group) == 0);
+    while (hexdump_step(out, &h, n)) {
+    }
+    fclose(out);
+    return s;
+}
+
+static int lines(const char *s) {
+    int n = 0;
+
+    for (; *s; s++) {
+        n += *s == '\n';
+    }
+    return n;
+}
+
+static void test_old_output(const uint8_t *rnd, uint32_t len) {
+    char *a = NULL;
+    size_t na;
+    FILE *fa = open_memstream(&a, &na);
+
+    old_dump(fa, rnd, len);
+    fclose(fa);
+
+    char *b = dump(rnd, len, 1, 100);
+    CHECK(strcmp(a, b) == 0);
+    free(a);
+    free(b);
+}
+
+// Repeated lines fold into one '*', across step boundaries, the last
+// line is always shown
+static void test_fold(void) {
+    static uint8_t zero[256] __attribute__((aligned(16)));
+    char *s;
+
+    s = dump(zero, sizeof(zero), 1, 16);
+    CHECK(lines(s) == 3);
+    CHECK(strstr(s, "\n*\n") != NULL);
+    free(s);
+
+    zero[0x80] = 0x41;
+    s = dump(zero, sizeof(zero), 4, 64);
+    CHECK(lines(s) == 6);
+    CHECK(strstr(s, "00000041") != NULL && strstr(s, "| A...") != NULL);
+    free(s);
+    zero[0x80] = 0;
+
+    hexdump_t h;
+    CHECK(hexdump_init(&h, zero, 16, 3) == -EINVAL);
+}
+
+static ssize_t bench_write(void *cookie, const char *buf, size_t size) {
+    (void)cookie;
+    (void)buf;
+    bench_writes++;
+    bench_bytes += size;
+    return (ssize_t)size;
+}
+
+static double bench_now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void bench_run(const char *name, const uint8_t *buf, uint32_t len, int group) {
+    static char obuf[128];
+    cookie_io_functions_t io = {.write = bench_write};
+    FILE *out = fopencookie(NULL, "w", io);
+    const int reps = 20;
+    hexdump_t h;
+
+    setvbuf(out, obuf, _IOLBF, sizeof(obuf));
+    bench_writes = bench_bytes = 0;
+    double t0 = bench_now();
+    for (int r = 0; r < reps; r++) {
+        if (group == 0) {
+            old_dump(out, buf, len);
+        } else {
+            hexdump_init(&h, buf, len, group);
+            while (hexdump_step(out, &h, 256)) {
+            }
+        }
+        fflush(out);
+    }
+    double ns = (bench_now() - t0) * 1e9 / reps / len;
+    printf("%-22s %6.2f ns/byte %7lu writes %8lu bytes per dump\n", name, ns, bench_writes / reps,
+           bench_bytes / reps);
+    fclose(out);
+}
+
+int main(void) {
+    const uint32_t len = 64U * 1024U;
+    uint8_t *rnd = malloc(len);
+    uint8_t *mix = malloc(len);
+
+    srand(1);
+    for (uint32_t i = 0; i < len; i++) {
+        rnd[i] = (uint8_t)rand();
+        mix[i] = (i / 4096U) & 1U ? (uint8_t)rand() : 0; // erased flash and data
+    }
+
+    test_old_output(rnd, len - 5U);
+    test_fold();
+
+    bench_run("printf, random", rnd, len, 0);
+    bench_run("table 8 bit, random", rnd, len, 1);
+    bench_run("table 32 bit, random", rnd, len, 4);
+    bench_run("printf, half zero", mix, len, 0);
+    bench_run("table 8 bit, half zero", mix, len, 1);
+
+    free(rnd);
+    free(mix);
+    return test_summary("hexdump");
+}
@@ -0,0 +1,263 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * test_mem_link.c - mem get/put between mem_link.c and tools/memlink
+ *
+ * The device end runs here on a pty and serves "mem get|put <adr> <len>"
+ * lines, <adr> is an offset into a 1 MB buffer holding a pattern. The
+ * test starts memlink on the other end, clean and with every n-th byte
+ * each way flipped, and compares what arrived. A put killed halfway
+ * checks that memlink stops on ABORT and the frames still in flight
+ * don't reach the command parser.
+ *
+ * To try memlink by hand, the device alone, optionally with noise:
+ *   ./build/test_mem_link pty [n]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pty.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "mem_link.h"
+#include "test.h"
+
+#define HOST_MEM_LEN (1024U * 1024U)
+#define XFER_LEN     (0x10000U)
+
+static uint8_t host_mem[HOST_MEM_LEN];
+static unsigned host_noise;
+static unsigned host_count;
+
+static mem_link_t l;
+static char line[64];
+static size_t line_len;
+static uint32_t kill_at;        // jobs kill once this much is acknowledged, 0 never
+static unsigned lines;          // command lines parsed
+
+static uint32_t host_ms(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000U + (uint64_t)ts.tv_nsec / 1000000U);
+}
+
+static void host_flip(uint8_t *p, size_t len) {
+    for (size_t i = 0; host_noise && i < len; i++) {
+        if (++host_count % host_noise == 0) {
+            p[i] ^= 0x10;
+        }
+    }
+}
+
+static int host_write(void *ctx, const void *buf, size_t len) {
+    static uint8_t tx[MEM_LINK_CHUNK];
+    int fd = *(int *)ctx;
+
+    memcpy(tx, buf, len);
+    host_flip(tx, len);
+    for (size_t done = 0; done < len;) {
+        ssize_t n = write(fd, tx + done, len - done);
+        if (n < 0) {
+            return -errno;
+        }
+        done += (size_t)n;
+    }
+    return (int)len;
+}
+
+// One turn of the device: poll the link, or read the line and hand it
+// to the link or to the command parser
+static void device_step(int *fd) {
+    struct pollfd pfd = {.fd = *fd, .events = POLLIN};
+    uint8_t buf[256];
+
+    if (l.status == -EINPROGRESS && kill_at && l.acked >= kill_at) {
+        mem_link_fail(&l, -ECANCELED);
+        l.rx_ms = host_ms();
+    }
+    if (l.status == -EINPROGRESS && mem_link_poll(&l, host_ms())) {
+        return;
+    }
+    if (l.status != -EINPROGRESS && l.len) {
+        printf("mem %s: %d, %u bytes, %u resent, %u bad\n", l.put ? "put" : "get", l.status, l.acked,
+               l.resends, l.bad);
+        l.len = 0;
+    }
+    if (poll(&pfd, 1, 1) <= 0) {
+        return;
+    }
+    ssize_t n = read(*fd, buf, sizeof(buf));
+    if (n <= 0) {
+        return;
+    }
+    host_flip(buf, (size_t)n);
+    ssize_t i = 0;
+    if (l.status == -EINPROGRESS) {
+        i = (ssize_t)mem_link_rx(&l, buf, (size_t)n, host_ms());
+    } else if (l.status == -ECANCELED && host_ms() - l.rx_ms < MEM_LINK_IDLE_MS) {
+        // Killed, frames in flight are swallowed until the line is quiet
+        l.rx_ms = host_ms();
+        return;
+    }
+    for (; i < n && l.status != -EINPROGRESS; i++) {
+        unsigned long adr, len;
+        char op[4];
+
+        if (buf[i] == 0x15) { // Ctrl+U, like microrl
+            line_len = 0;
+            continue;
+        }
+        if (buf[i] != '\r' && buf[i] != '\n') {
+            line[line_len] = (char)buf[i];
+            line_len += line_len < sizeof(line) - 1U;
+            continue;
+        }
+        line[line_len] = '\0';
+        line_len = 0;
+        lines += line[0] != '\0';
+        if (sscanf(line, "mem %3s %lx %lx", op, &adr, &len) == 3 && adr + len <= HOST_MEM_LEN &&
+            (strcmp(op, "get") == 0 || strcmp(op, "put") == 0)) {
+            printf("%s\n", line);
+            mem_link_init(&l, (uintptr_t)(host_mem + adr), (uint32_t)len, op[0] == 'p', host_write, fd,
+                          host_ms());
+        }
+    }
+}
+
+static int device_open(int *fd, char *name) {
+    struct termios tio;
+    int sfd;
+
+    if (openpty(fd, &sfd, name, NULL, NULL) < 0) {
+        perror("openpty");
+        return -1;
+    }
+    tcgetattr(sfd, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(sfd, TCSANOW, &tio);
+    for (uint32_t i = 0; i < HOST_MEM_LEN; i++) {
+        host_mem[i] = (uint8_t)(i * 7U + (i >> 11));
+    }
+    l.status = 0;
+    return sfd;
+}
+
+// memlink with @args on the pty, the device serves it until it exits
+static int memlink(int *fd, char *const args[]) {
+    pid_t pid = fork();
+
+    if (pid == 0) {
+        int null = open("/dev/null", O_WRONLY);
+        dup2(null, STDERR_FILENO);
+        execv(MEMLINK, args);
+        _exit(127);
+    }
+    for (;;) {
+        int st;
+
+        if (waitpid(pid, &st, WNOHANG) == pid) {
+            return WIFEXITED(st) ? WEXITSTATUS(st) : -1;
+        }
+        device_step(fd);
+    }
+}
+
+static int file_equal(const char *path, const uint8_t *data, size_t len) {
+    static uint8_t buf[XFER_LEN + 1];
+    FILE *f = fopen(path, "rb");
+
+    if (f == NULL) {
+        return 0;
+    }
+    size_t n = fread(buf, 1, sizeof(buf), f);
+    fclose(f);
+    return n == len && memcmp(buf, data, len) == 0;
+}
+
+static void test_get(int *fd, char *pty, unsigned noise) {
+    char *args[] = {"memlink", "get", pty, "115200", "1000", "10000", "build/mem_link.bin", NULL};
+
+    host_noise = noise;
+    remove(args[6]);
+    CHECK(memlink(fd, args) == 0);
+    CHECK(file_equal(args[6], host_mem + 0x1000, XFER_LEN));
+    CHECK(noise == 0 || l.resends != 0);
+}
+
+static void test_put(int *fd, char *pty, unsigned noise) {
+    static uint8_t data[XFER_LEN];
+    char *args[] = {"memlink", "put", pty, "115200", "20000", "build/mem_link.bin", NULL};
+
+    for (uint32_t i = 0; i < XFER_LEN; i++) {
+        data[i] = (uint8_t)(i ^ (i >> 9) ^ noise);
+    }
+    FILE *f = fopen(args[5], "wb");
+    fwrite(data, 1, sizeof(data), f);
+    fclose(f);
+
+    host_noise = noise;
+    CHECK(memlink(fd, args) == 0);
+    CHECK(memcmp(host_mem + 0x20000, data, XFER_LEN) == 0);
+    CHECK(host_mem[0x20000 + XFER_LEN] == (uint8_t)((0x20000 + XFER_LEN) * 7U + ((0x20000 + XFER_LEN) >> 11)));
+    CHECK(noise == 0 || l.bad != 0);
+}
+
+// Killed halfway, memlink gets ABORT and stops at once, nothing it
+// still sends reaches the command parser
+static void test_kill(int *fd, char *pty) {
+    static uint8_t data[XFER_LEN];
+    char *args[] = {"memlink", "put", pty, "115200", "30000", "build/mem_link.bin", NULL};
+
+    for (uint32_t i = 0; i < XFER_LEN; i++) {
+        data[i] = (i & 1U) ? '\r' : 'x';
+    }
+    FILE *f = fopen(args[5], "wb");
+    fwrite(data, 1, sizeof(data), f);
+    fclose(f);
+
+    host_noise = 0;
+    kill_at = XFER_LEN / 2U;
+    lines = 0;
+    uint32_t t0 = host_ms();
+    CHECK(memlink(fd, args) == 1);
+    CHECK(host_ms() - t0 < MEM_LINK_TIMEOUT_MS * MEM_LINK_RETRIES);
+    CHECK(l.status == -ECANCELED && l.acked < XFER_LEN);
+    for (uint32_t t = host_ms(); host_ms() - t < 2U * MEM_LINK_IDLE_MS;) {
+        device_step(fd);
+    }
+    CHECK(lines == 1); // the mem put line itself
+    kill_at = 0;
+}
+
+int main(int argc, char *argv[]) {
+    char name[64];
+    int fd;
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    if (device_open(&fd, name) < 0) {
+        return 1;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "pty") == 0) {
+        host_noise = argc > 2 ? (unsigned)strtoul(argv[2], NULL, 0) : 0;
+        printf("device on %s, memory at %p\n", name, (void *)host_mem);
+        for (;;) {
+            device_step(&fd);
+        }
+    }
+
+    alarm(120);
+    test_get(&fd, name, 0);
+    test_put(&fd, name, 0);
+    test_get(&fd, name, 4999);
+    test_put(&fd, name, 5003);
+    test_kill(&fd, name);
+
+    return test_summary("mem_link");
+}
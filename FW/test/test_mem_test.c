@@ -0,0 +1,139 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * test_mem_test.c - RAM test engine against a RAM model with one fault
+ *
+ * mem_test.c is built with MEM_TEST_HOST, its word accesses go to
+ * model_rd32() and friends below. Every algorithm runs at both widths
+ * against every fault, the table shows which ones catch it.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "mem_test.h"
+#include "test.h"
+
+#define MODEL_WORDS    16384 // 64 KB of 32 bit cells
+#define MODEL_CELL     0x1234
+#define MODEL_VICTIM   0x2345
+#define MODEL_BIT      (1U << 5)
+#define MODEL_ADDR_BIT (1U << 11) // word address line
+
+typedef enum model_fault {
+    FAULT_NONE = 0,
+    FAULT_STUCK1,     // MODEL_BIT of MODEL_CELL reads 1
+    FAULT_TRANSITION, // MODEL_BIT of MODEL_CELL can't go 0 -> 1
+    FAULT_COUPLING,   // MODEL_BIT of MODEL_CELL going 0 -> 1 sets it in MODEL_VICTIM
+    FAULT_ADDR,       // address line stuck at 0, upper half aliases lower
+    FAULT_COUNT
+} model_fault_t;
+
+static const char *const model_fault_names[FAULT_COUNT] = {
+    "none", "stuck-at-1", "transition", "coupling", "address line",
+};
+
+static uint32_t model_ram[MODEL_WORDS];
+static model_fault_t model_fault;
+
+static uint32_t model_index(uintptr_t a) {
+    uint32_t i = (uint32_t)((a - (uintptr_t)model_ram) / 4U);
+
+    if (model_fault == FAULT_ADDR) {
+        i &= ~MODEL_ADDR_BIT;
+    }
+    return i;
+}
+
+uint32_t model_rd32(uintptr_t a) {
+    uint32_t i = model_index(a);
+    uint32_t v = model_ram[i];
+
+    if (model_fault == FAULT_STUCK1 && i == MODEL_CELL) {
+        v |= MODEL_BIT;
+    }
+    return v;
+}
+
+void model_wr32(uintptr_t a, uint32_t v) {
+    uint32_t i = model_index(a);
+    uint32_t old = model_ram[i];
+
+    if (model_fault == FAULT_TRANSITION && i == MODEL_CELL && !(old & MODEL_BIT)) {
+        v &= ~MODEL_BIT;
+    }
+    if (model_fault == FAULT_COUPLING && i == MODEL_CELL && (v & ~old & MODEL_BIT)) {
+        model_ram[MODEL_VICTIM] |= MODEL_BIT;
+    }
+    model_ram[i] = v;
+}
+
+uint64_t model_rd64(uintptr_t a) {
+    return model_rd32(a) | (uint64_t)model_rd32(a + 4U) << 32;
+}
+
+void model_wr64(uintptr_t a, uint64_t v) {
+    model_wr32(a, (uint32_t)v);
+    model_wr32(a + 4U, (uint32_t)(v >> 32));
+}
+
+static mem_test_t t;
+
+// A clean model passes, each fault fails the full run, March C- finds
+// every cell fault and the address test the aliasing
+static void test_faults(int width) {
+    printf("%d bit, errors per algorithm\n", width * 8);
+    printf("%-14s", "fault");
+    for (int alg = 0; alg < MEM_TEST_ALGS; alg++) {
+        printf(" %8s", mem_test_alg_names[alg]);
+    }
+    printf("\n");
+
+    for (int f = 0; f < FAULT_COUNT; f++) {
+        model_fault = (model_fault_t)f;
+        memset(model_ram, 0, sizeof(model_ram));
+        CHECK(mem_test_init(&t, (uintptr_t)model_ram, sizeof(model_ram), MEM_TEST_ALL, width) == 0);
+        mem_test_run(&t);
+
+        printf("%-14s", model_fault_names[f]);
+        for (int alg = 0; alg < MEM_TEST_ALGS; alg++) {
+            printf(" %8lu", (unsigned long)t.stat[alg].errors);
+        }
+        printf("\n");
+
+        CHECK((f == FAULT_NONE) == (t.errors == 0));
+        if (f == FAULT_ADDR) {
+            CHECK(t.stat[MEM_TEST_ADDR].errors != 0);
+        } else if (f != FAULT_NONE) {
+            CHECK(t.stat[MEM_TEST_MARCH].errors != 0);
+        }
+    }
+    printf("\n");
+}
+
+// The report of one fault names the failing cell
+static void test_report(void) {
+    char buf[2048];
+    FILE *out = fmemopen(buf, sizeof(buf), "w");
+
+    model_fault = FAULT_COUPLING;
+    memset(model_ram, 0, sizeof(model_ram));
+    CHECK(mem_test_init(&t, (uintptr_t)model_ram, sizeof(model_ram), MEM_TEST_MARCH, 4) == 0);
+    mem_test_run(&t);
+    mem_test_report(out, &t);
+    fclose(out);
+    fputs(buf, stdout);
+
+    CHECK(t.errors != 0 && t.log[0].addr == (uintptr_t)&model_ram[MODEL_VICTIM]);
+    CHECK(strstr(buf, "FAILED") != NULL);
+
+    // Misaligned ranges are refused
+    CHECK(mem_test_init(&t, (uintptr_t)model_ram + 4U, 64, MEM_TEST_MARCH, 8) < 0);
+}
+
+int main(void) {
+    test_faults(4);
+    test_faults(8);
+    test_report();
+
+    return test_summary("mem_test");
+}
@@ -0,0 +1,97 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * test_memory_man.c - mem subcommands on the host
+ *
+ * memory_man.c is included for its static command table. Without
+ * BAREMETAL the commands run at once on the CPU engines, here on
+ * static buffers (32 bit addresses with -no-pie).
+ */
+
+#include <stdarg.h>
+#include "../app/mem/memory_man.c"
+#include "test.h"
+
+static uint8_t a[0x1000] __attribute__((aligned(8)));
+static uint8_t b[0x1000] __attribute__((aligned(8)));
+static char out[0x2000];
+
+// Runs @cmd on the words of @fmt, its output lands in out[]
+static int run(const command_t *cmd, const char *fmt, ...) {
+    char line[128];
+    char *argv[8];
+    int argc = 0;
+    va_list ap;
+
+    va_start(ap, fmt);
+    vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    for (char *w = strtok(line, " "); w && argc < 8; w = strtok(NULL, " ")) {
+        argv[argc++] = w;
+    }
+
+    ucmd_session_t s = {.name = "host"};
+    s.out = fmemopen(out, sizeof(out), "w");
+    int ret = cmd->fn(&s, argc, argv);
+    fclose(s.out);
+    return ret;
+}
+
+static unsigned long adr(const void *p) {
+    return (unsigned long)(uintptr_t)p;
+}
+
+static void test_fill_cpy_cmp(void) {
+    memset(a, 0, sizeof(a));
+    memset(b, 0, sizeof(b));
+
+    CHECK(run(&ucmd_cmd_mem_fill, "fill %lx 100 5a", adr(a)) == 0);
+    CHECK(a[0] == 0x5a && a[0xff] == 0x5a && a[0x100] == 0);
+    CHECK(run(&ucmd_cmd_mem_fill, "fill %lx 8 12345678 cpu", adr(&a[0x100])) == 0);
+    CHECK(memcmp(&a[0x100], "\x78\x56\x34\x12\x78\x56\x34\x12", 8) == 0);
+    CHECK(run(&ucmd_cmd_mem_fill, "fill %lx 6 12345678", adr(&a[0x100])) == -EINVAL);
+
+    CHECK(run(&ucmd_cmd_mem_cpy, "cpy %lx %lx 1000", adr(b), adr(a)) == 0);
+    CHECK(memcmp(a, b, sizeof(a)) == 0);
+    CHECK(run(&ucmd_cmd_mem_cmp, "cmp %lx %lx 1000", adr(a), adr(b)) == 0);
+
+    CHECK(run(&ucmd_cmd_mem_write, "write %lx 77", adr(&b[0x123])) == 0);
+    CHECK(b[0x123] == 0x77);
+    CHECK(run(&ucmd_cmd_mem_cmp, "cmp %lx %lx 1000", adr(a), adr(b)) == -EIO);
+    CHECK(run(&ucmd_cmd_mem_read, "read %lx", adr(&b[0x123])) == 0 && strcmp(out, "0x77\n") == 0);
+}
+
+static void test_dump_crc(void) {
+    memcpy(a, "123456789", 9);
+
+    CHECK(run(&ucmd_cmd_mem_crc, "crc %lx 9 sw", adr(a)) == 0);
+    CHECK(strstr(out, ": 0xcbf43926") != NULL);
+    CHECK(run(&ucmd_cmd_mem_crc, "crc %lx 9 sw crc32c", adr(a)) == 0);
+    CHECK(strstr(out, ": 0xe3069283") != NULL);
+
+    CHECK(run(&ucmd_cmd_mem_dump, "dump %lx 10", adr(a)) == 0);
+    CHECK(strstr(out, "31 32 33 34") != NULL);
+    CHECK(run(&ucmd_cmd_mem_dump, "dump %lx 10 32", adr(a)) == 0);
+    CHECK(strstr(out, "34333231") != NULL);
+}
+
+static void test_ram(void) {
+    CHECK(run(&ucmd_cmd_mem_test, "test %lx 1000 march", adr(b)) == 0);
+    CHECK(strstr(out, "FAILED") == NULL);
+    CHECK(run(&ucmd_cmd_mem_test, "test %lx 1000 all 64", adr(b)) == 0);
+    CHECK(run(&ucmd_cmd_mem_test, "test %lx 1000 checker 64", adr(&b[4])) == -EINVAL);
+}
+
+static void test_usage(void) {
+    CHECK(run(&ucmd_cmd_mem_dump, "dump") == -EINVAL);
+    CHECK(run(&ucmd_cmd_mem_crc, "crc %lx 9 sw bogus", adr(a)) == -EINVAL);
+    CHECK(run(&ucmd_cmd_mem_map, "map") == 0 && strstr(out, "ram_d1") != NULL);
+}
+
+int main(void) {
+    test_fill_cpy_cmp();
+    test_dump_crc();
+    test_ram();
+    test_usage();
+
+    return test_summary("memory_man");
+}
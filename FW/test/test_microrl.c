@@ -0,0 +1,184 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * test_microrl.c - microrl output batching on the host
+ *
+ * Echo and redraws are collected in the line buffer and reach 'print'
+ * once per flush, ahead of the command they belong to. The bench
+ * counts 'print' calls and bytes per keystroke, one input batch per
+ * key as when typing, one per line as when pasting. Build with
+ * CFLAGS+=-D_OUT_BUF_LEN=0 for the unbuffered numbers.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "microrl.h"
+#include "test.h"
+
+static unsigned long out_calls;
+static unsigned long out_bytes;
+static char out[4096];
+static size_t out_len;
+
+static char line[128];              // last executed command, words joined
+static size_t line_echo;            // output length when it was executed
+static int executed;
+
+static void print(const char *str) {
+    size_t n = strlen(str);
+
+    out_calls++;
+    out_bytes += n;
+    if (out_len + n < sizeof(out)) {
+        memcpy(&out[out_len], str, n + 1);
+        out_len += n;
+    }
+}
+
+static int execute(int argc, const char *const *argv) {
+    line[0] = '\0';
+    for (int i = 0; i < argc; i++) {
+        if (i) {
+            strcat(line, " ");
+        }
+        strcat(line, argv[i]);
+    }
+    line_echo = out_len;
+    executed++;
+    return 0;
+}
+
+static void start(microrl_t *rl) {
+    microrl_init(rl, print);
+    microrl_set_execute_callback(rl, execute);
+    microrl_flush(rl);
+    out_calls = out_bytes = 0;
+    out_len = 0;
+    out[0] = '\0';
+    executed = 0;
+}
+
+static void type(microrl_t *rl, const char *keys) {
+    for (size_t i = 0; keys[i]; i++) {
+        microrl_insert_char(rl, keys[i]);
+        microrl_flush(rl);
+    }
+}
+
+// Typed at the end of the line, each key is one plain echo
+static void test_type(void) {
+    microrl_t rl;
+
+    start(&rl);
+    type(&rl, "mem dump");
+    CHECK(out_calls == 8 && strcmp(out, "mem dump") == 0);
+
+    type(&rl, " itcm\r");
+    CHECK(executed == 1 && strcmp(line, "mem dump itcm") == 0);
+    CHECK(line_echo >= 13 && strncmp(out, "mem dump itcm", 13) == 0);
+}
+
+// An edit in the middle of the line redraws it, the command sees the edit
+static void test_edit(void) {
+    microrl_t rl;
+
+    start(&rl);
+    type(&rl, "mem dump 24000000 10\033[D\033[D\033[D1\b2\r");
+    CHECK(executed == 1 && strcmp(line, "mem dump 240000002 10") == 0);
+}
+
+// A pasted batch is one 'print' call per buffer, echo first
+static void test_paste(void) {
+    microrl_t rl;
+    unsigned long bytes;
+
+    start(&rl);
+    for (const char *k = "mem dump ram_d1 100\r"; *k; k++) {
+        microrl_insert_char(&rl, *k);
+    }
+    CHECK(executed == 1 && strcmp(line, "mem dump ram_d1 100") == 0);
+    CHECK(strncmp(out, "mem dump ram_d1 100", 19) == 0);
+    microrl_flush(&rl);
+    CHECK(out_calls == 2);          // echo before execute, then the prompt
+    bytes = out_bytes;
+
+    // insert_str gives the same output as key by key
+    start(&rl);
+    microrl_insert_str(&rl, "mem dump ram_d1 100\r", 20);
+    microrl_flush(&rl);
+    CHECK(executed == 1 && strcmp(line, "mem dump ram_d1 100") == 0);
+    CHECK(out_bytes == bytes);
+}
+
+static void bench_run(const char *name, const char *keys, int per_key) {
+    microrl_t rl;
+    size_t n = strlen(keys);
+
+    start(&rl);
+    for (size_t i = 0; i < n; i++) {
+        microrl_insert_char(&rl, keys[i]);
+        if (per_key) {
+            microrl_flush(&rl);
+        }
+    }
+    microrl_flush(&rl);
+    printf("%-24s %4zu keys %5lu calls %6lu bytes  %5.2f calls/key %6.2f bytes/key\n",
+           name, n, out_calls, out_bytes,
+           (double)out_calls / (double)n, (double)out_bytes / (double)n);
+}
+
+// 4 KB script pasted in 64 byte reads, char by char against bulk
+static void bench_paste(void) {
+    static char script[4096];
+    static const char cmd[] = "mem read ram_d1 \r";
+    microrl_t rl;
+    clock_t t0;
+    double t_char;
+    double t_str;
+    int n = 0;
+
+    while (n + (int)sizeof(cmd) - 1 <= (int)sizeof(script)) {
+        memcpy(script + n, cmd, sizeof(cmd) - 1);
+        n += (int)sizeof(cmd) - 1;
+    }
+
+    start(&rl);
+    t0 = clock();
+    for (int rep = 0; rep < 1000; rep++) {
+        for (int i = 0; i < n; i += 64) {
+            for (int j = i; j < i + 64 && j < n; j++) {
+                microrl_insert_char(&rl, script[j]);
+            }
+            microrl_flush(&rl);
+        }
+    }
+    t_char = (double)(clock() - t0) / CLOCKS_PER_SEC / 1000.0 / n * 1e9;
+    printf("%-24s %4d bytes %5lu calls %6lu bytes out  %6.1f ns/byte\n",
+           "paste 4K, insert_char", n, out_calls / 1000, out_bytes / 1000, t_char);
+
+    start(&rl);
+    t0 = clock();
+    for (int rep = 0; rep < 1000; rep++) {
+        for (int i = 0; i < n; i += 64) {
+            microrl_insert_str(&rl, script + i, n - i < 64 ? n - i : 64);
+            microrl_flush(&rl);
+        }
+    }
+    t_str = (double)(clock() - t0) / CLOCKS_PER_SEC / 1000.0 / n * 1e9;
+    printf("%-24s %4d bytes %5lu calls %6lu bytes out  %6.1f ns/byte\n",
+           "paste 4K, insert_str", n, out_calls / 1000, out_bytes / 1000, t_str);
+}
+
+int main(void) {
+    test_type();
+    test_edit();
+    test_paste();
+
+    printf("_OUT_BUF_LEN %u\n", (unsigned int)_OUT_BUF_LEN);
+    bench_run("type line", "mem dump ram_d1 100\r", 1);
+    bench_run("type, edit mid line", "mem dump 24000000 10\033[D\033[D\033[D1\b2\r", 1);
+    bench_run("paste line", "mem dump ram_d1 100\r", 0);
+    bench_paste();
+
+    return test_summary("microrl");
+}
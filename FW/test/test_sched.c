@@ -0,0 +1,147 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * test_sched.c - Event scheduler on the host
+ *
+ * sched.c has a host port: WFI is a condition wait and sched_post()
+ * from another thread plays the interrupt. Checks priority order and
+ * event merging, then a thread posts to a high and a low priority task
+ * and both report post -> run latency.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+#include "sched.h"
+#include "test.h"
+
+#define BENCH_POSTS 20000
+
+typedef struct bench {
+    const char *name;
+    volatile uint64_t posted_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint64_t sum_ns;
+    uint32_t count;
+    uint32_t work;      // busy loop inside the task body
+} bench_t;
+
+static bench_t bench_hi = { .name = "hi", .min_ns = UINT64_MAX, .work = 100 };
+static bench_t bench_lo = { .name = "lo", .min_ns = UINT64_MAX, .work = 2000 };
+static int bench_hi_id;
+static int bench_lo_id;
+static volatile int bench_done;
+
+static char order[8];
+static uint32_t order_len;
+static uint32_t order_events[8];
+
+static uint64_t bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void order_task(uint32_t events, void *ctx)
+{
+    order_events[order_len] = events;
+    order[order_len++] = *(const char *)ctx;
+}
+
+static void bench_task(uint32_t events, void *ctx)
+{
+    bench_t *b = ctx;
+    uint64_t lat = bench_now() - b->posted_ns;
+
+    (void)events;
+    if (lat < b->min_ns) b->min_ns = lat;
+    if (lat > b->max_ns) b->max_ns = lat;
+    b->sum_ns += lat;
+    b->count++;
+
+    for (volatile uint32_t i = 0; i < b->work; i++);
+}
+
+static void* bench_irq(void *arg)
+{
+    (void)arg;
+    struct timespec gap = { 0, 20000 };
+
+    for (int i = 0; i < BENCH_POSTS; i++) {
+        bench_lo.posted_ns = bench_now();
+        sched_post(bench_lo_id, SCHED_EV_USER);
+        if (i & 1) {
+            bench_hi.posted_ns = bench_now();
+            sched_post(bench_hi_id, SCHED_EV_RX);
+        }
+        nanosleep(&gap, NULL);
+    }
+    bench_done = 1;
+    sched_post(bench_lo_id, SCHED_EV_USER);
+    return NULL;
+}
+
+// Highest priority first, posts before a run merge into one call
+static void test_order(void)
+{
+    static const char a = 'a', b = 'b', c = 'c';
+    int ida = sched_task_add("a", 2, order_task, (void *)&a);
+    int idb = sched_task_add("b", 0, order_task, (void *)&b);
+    int idc = sched_task_add("c", 1, order_task, (void *)&c);
+    sched_info_t info;
+
+    CHECK(ida >= 0 && idb >= 0 && idc >= 0);
+    sched_post(ida, SCHED_EV_RX);
+    sched_post(ida, SCHED_EV_TIMER);
+    sched_post(idc, SCHED_EV_USER);
+    sched_post(idb, SCHED_EV_TX_DONE);
+    sched_post(idb, 0);
+    sched_post(-1, SCHED_EV_RX);
+
+    while (sched_run_once());
+
+    CHECK(order_len == 3);
+    CHECK(order[0] == 'b' && order[1] == 'c' && order[2] == 'a');
+    CHECK(order_events[0] == SCHED_EV_TX_DONE);
+    CHECK(order_events[2] == (SCHED_EV_RX | SCHED_EV_TIMER));
+    CHECK(sched_task_info(ida, &info) == 0 && info.runs == 1 && info.pending == 0);
+    CHECK(sched_task_info(SCHED_MAX_TASKS, &info) == -EINVAL);
+}
+
+static void bench_latency(void)
+{
+    pthread_t irq;
+
+    bench_hi_id = sched_task_add("hi", 0, bench_task, &bench_hi);
+    bench_lo_id = sched_task_add("lo", 1, bench_task, &bench_lo);
+
+    pthread_create(&irq, NULL, bench_irq, NULL);
+    // Busy idle: sched_idle() is private, the latency is the post path
+    while (!bench_done) {
+        sched_run_once();
+    }
+    pthread_join(irq, NULL);
+    while (sched_run_once());
+
+    CHECK(bench_hi.count > 0 && bench_hi.count <= BENCH_POSTS / 2);
+    CHECK(bench_lo.count > 0 && bench_lo.count <= BENCH_POSTS + 1);
+
+    const bench_t *all[] = { &bench_hi, &bench_lo };
+    printf("task  runs     min us   avg us   max us\n");
+    for (unsigned i = 0; i < 2; i++) {
+        const bench_t *b = all[i];
+        printf("%-4s %6lu %9.2f %8.2f %8.2f\n", b->name, (unsigned long)b->count,
+               (double)b->min_ns / 1000.0,
+               b->count ? (double)b->sum_ns / b->count / 1000.0 : 0.0,
+               (double)b->max_ns / 1000.0);
+    }
+}
+
+int main(void)
+{
+    test_order();
+    bench_latency();
+    return test_summary("sched");
+}
@@ -0,0 +1,216 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * test_systime.c - Timer wheel and monotonic clock on the host
+ *
+ * systime.c is included for its wheel. SysTick is plain memory here,
+ * the test calls SysTick_Handler() as the tick IRQ and sets tick_step
+ * the way a tickless wake does. Checks that random one-shot and
+ * periodic timers expire on their tick through every cascade, that a
+ * task timer the task doesn't keep up with is merged, and the idle
+ * sleep wheel_idle_ticks() allows.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "../app/systime/systime.c"
+#include "test.h"
+
+#define RANDOM_TIMERS  2000
+#define RANDOM_SPAN    300000U  // ms, reaches the top level
+
+typedef struct rec {
+    uint64_t due;       // tick of the next expiry
+    uint32_t period;    // ticks, 0 for one-shot
+    uint32_t fired;
+    uint32_t late;      // expiries off their tick
+} rec_t;
+
+static systimer_t timers[RANDOM_TIMERS];
+static rec_t recs[RANDOM_TIMERS];
+static uint32_t posts;
+
+// The scheduler and CPU load side of systime.c
+int sched_task_add(const char *name, uint8_t prio, sched_fn_t fn, void *ctx)
+{
+    (void)name;
+    (void)prio;
+    (void)fn;
+    (void)ctx;
+    return 3;
+}
+
+void sched_post(int id, uint32_t events)
+{
+    if (id == 3 && events == SCHED_EV_TIMER) {
+        posts++;
+    }
+}
+
+void cpuload_irq_exit(uint32_t start)
+{
+    (void)start;
+}
+
+static void rec_fire(void *ctx)
+{
+    rec_t *r = ctx;
+
+    r->late += wheel_now != r->due;
+    r->fired++;
+    r->due += r->period;
+}
+
+// n ticks, one IRQ per step ticks like tickless wakes
+static void run_ticks(uint64_t n, uint32_t step)
+{
+    while (n) {
+        uint32_t k = n < step ? (uint32_t)n : step;
+
+        tick_step = k;
+        SysTick_Handler();
+        n -= k;
+    }
+}
+
+static uint32_t rnd(uint32_t n)
+{
+    return (uint32_t)(((uint64_t)rand() << 16 ^ (uint64_t)rand()) % n);
+}
+
+// Random one-shots and periodic ISR timers, stepped 1 tick and in
+// tickless bursts, each fires on its own tick
+static void test_random(uint32_t step)
+{
+    uint64_t start = wheel_now;
+
+    for (uint32_t i = 0; i < RANDOM_TIMERS; i++) {
+        uint32_t delay = 1U + rnd(RANDOM_SPAN);
+        uint32_t period = (i & 1U) ? 1U + rnd(RANDOM_SPAN / 8U) : 0U;
+
+        recs[i] = (rec_t){.due = wheel_now + delay, .period = period};
+        CHECK(systimer_start(&timers[i], delay, period, rec_fire, &recs[i], SYSTIMER_ISR) == 0);
+    }
+    run_ticks(RANDOM_SPAN + 1U, step);
+
+    uint32_t fired = 0, late = 0, count = 0;
+    for (uint32_t i = 0; i < RANDOM_TIMERS; i++) {
+        uint64_t end = wheel_now;
+        uint32_t want = 1;
+
+        if (recs[i].period) {
+            // due moved past end, count back to the first expiry
+            uint64_t first = recs[i].due - (uint64_t)recs[i].fired * recs[i].period;
+            want = first <= end ? (uint32_t)((end - first) / recs[i].period + 1U) : 0U;
+            CHECK(first > start);
+        }
+        count += recs[i].fired == want;
+        fired += recs[i].fired;
+        late += recs[i].late;
+        systimer_stop(&timers[i]);
+    }
+    printf("step %2u: %u timers, %u expiries, %u late\n", step, RANDOM_TIMERS, fired, late);
+    CHECK(count == RANDOM_TIMERS);
+    CHECK(late == 0);
+}
+
+// Delays on both sides of each level boundary, a stopped one never fires
+static void test_levels(void)
+{
+    static const uint32_t delays[] = {1, 63, 64, 65, 4095, 4096, 4097, 262144, 262145};
+    const uint32_t n = sizeof(delays) / sizeof(delays[0]);
+
+    for (uint32_t i = 0; i < n; i++) {
+        recs[i] = (rec_t){.due = wheel_now + delays[i]};
+        systimer_start(&timers[i], delays[i], 0, rec_fire, &recs[i], SYSTIMER_ISR);
+    }
+    systimer_stop(&timers[3]);
+    run_ticks(262145, 1);
+
+    uint32_t ok = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        ok += i == 3 ? recs[i].fired == 0 : recs[i].fired == 1 && recs[i].late == 0;
+    }
+    CHECK(ok == n);
+}
+
+// A task timer whose task doesn't run is queued once, later expiries
+// are counted in missed; stop drops it from the ready FIFO
+static void test_merge(void)
+{
+    rec_t r = {0};
+    systimer_t *t = &timers[0];
+
+    posts = 0;
+    CHECK(systimer_start(t, 10, 10, rec_fire, &r, 0) == 0);
+    run_ticks(35, 1);
+    CHECK(posts == 1 && t->queued && t->missed == 2 && r.fired == 0);
+
+    r.due = wheel_now;
+    timer_run(SCHED_EV_TIMER, NULL);
+    CHECK(r.fired == 1 && !t->queued && ready_head == NULL);
+
+    run_ticks(5, 1);
+    CHECK(posts == 2 && t->queued);
+    systimer_stop(t);
+    CHECK(!t->queued && ready_head == NULL);
+    timer_run(SCHED_EV_TIMER, NULL);
+    run_ticks(100, 1);
+    CHECK(r.fired == 1 && posts == 2);
+}
+
+// Idle sleep ends at the next level 0 expiry or cascade
+static void test_idle(void)
+{
+    rec_t r = {0};
+
+    run_ticks(WHEEL_SIZE - (wheel_now & WHEEL_MASK) + 1U, 1); // one past a cascade
+    CHECK(wheel_idle_ticks(1000) == WHEEL_SIZE - 1U);
+    CHECK(wheel_idle_ticks(20) == 20);
+
+    systimer_start(&timers[0], 5, 0, rec_fire, &r, SYSTIMER_ISR);
+    CHECK(wheel_idle_ticks(1000) == 5);
+    systimer_stop(&timers[0]);
+    CHECK(wheel_idle_ticks(1000) == WHEEL_SIZE - 1U);
+
+    // A level 1 timer is found by the cascade ahead of it
+    systimer_start(&timers[0], 200, 0, rec_fire, &r, SYSTIMER_ISR);
+    CHECK(wheel_idle_ticks(1000) == WHEEL_SIZE - 1U);
+    systimer_stop(&timers[0]);
+}
+
+// Cycles count within the tick from VAL, a pending wrap adds its ticks
+static void test_cycles(void)
+{
+    uint64_t base = tick_count * tick_cycles;
+
+    SysTick->VAL = tick_cycles - 1U;
+    CHECK(systime_cycles() == base);
+    SysTick->VAL = 0;
+    CHECK(systime_cycles() == base + tick_cycles - 1U);
+
+    // Tickless period of 3 ticks, wrapped but the IRQ not run yet
+    tick_step = 3;
+    SysTick->VAL = tick_cycles - 1U;
+    SCB->ICSR |= SCB_ICSR_PENDSTSET_Msk;
+    CHECK(systime_cycles() == base + 3U * tick_cycles);
+    SCB->ICSR = 0;
+    tick_step = 1;
+}
+
+int main(void)
+{
+    srand(12);
+    systime_init();
+    CHECK(tick_cycles == SystemCoreClock / SYSTIME_TICK_HZ);
+    CHECK(systimer_start(&timers[0], 1, 0, rec_fire, &recs[0], 0) == -ENODEV);
+    CHECK(systimer_task_init(1) == 0);
+
+    test_levels();
+    test_random(1);
+    test_random(29);
+    test_merge();
+    test_idle();
+    test_cycles();
+
+    return test_summary("systime");
+}
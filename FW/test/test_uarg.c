@@ -0,0 +1,215 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * test_uarg.c - Typed argument parser on the host
+ *
+ * Parses the argument shapes of the mem commands, then times uarg
+ * against the sscanf calls it replaced.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include "uarg.h"
+#include "test.h"
+
+static const uarg_region_t regions[] = {
+    {"itcm",   0x00000000, 64 * 1024},
+    {"flash",  0x08000000, 2048 * 1024},
+    {"ram_d1", 0x24000000, 512 * 1024},
+    {NULL, 0, 0},
+};
+
+static const char *const groups[] = {"8", "16", "32", NULL};
+static const char *const engines[] = {"auto", "sw", "cpu", "dma", NULL};
+static const char *const models[] = {"crc32", "crc32c", "crc16-ccitt", NULL};
+static const char *const algs[] = {"march", "walk1", "all", NULL};
+
+// Specs are file scope: their argument list is a static compound literal
+static const uarg_spec_t dump_args = UARG_SPEC("mem dump", UARG_RANGE("<adr> <len>", regions, 0, 0),
+                                               UARG_OPT_ENUM("[8|16|32]", groups, 0));
+static const uarg_spec_t crc_args = UARG_SPEC("mem crc", UARG_RANGE("<adr> <len>", regions, 0, 0),
+                                              UARG_OPT_ENUM("[engine]", engines, 0),
+                                              UARG_OPT_ENUM("[model]", models, 0));
+static const uarg_spec_t test_args = UARG_SPEC("mem test", UARG_RANGE("<adr> <len>", regions, 0, 0),
+                                               UARG_OPT_ENUM("[alg]", algs, 2));
+static const uarg_spec_t write_args = UARG_SPEC("mem write", UARG_ADDR("<adr>", regions),
+                                                UARG_HEX("<data>", 0, 0xff));
+
+static FILE *quiet;
+
+static int parse(const uarg_spec_t *spec, const char *line, uarg_val_t *val) {
+    char buf[128];
+    char *argv[8];
+    int argc = 0;
+
+    snprintf(buf, sizeof(buf), "%s", line);
+    for (char *w = strtok(buf, " "); w && argc < 8; w = strtok(NULL, " ")) {
+        argv[argc++] = w;
+    }
+    return uarg_parse(quiet, spec, argc, argv, val);
+}
+
+// <region> [optional enum]: a region takes one word, the next one is
+// the following argument and never a length
+static void test_region_enum(void) {
+    uarg_val_t v[4];
+
+    CHECK(parse(&crc_args, "crc flash sw", v) == 0);
+    CHECK(v[0].u == 0x08000000 && v[1].u == 2048 * 1024 && v[2].u == 1 && v[3].u == 0);
+    CHECK(parse(&crc_args, "crc flash dma crc32c", v) == 0);
+    CHECK(v[2].u == 3 && v[3].u == 1);
+    CHECK(parse(&crc_args, "crc ram_d1", v) == 0);
+    CHECK(v[0].u == 0x24000000 && v[1].u == 512 * 1024 && v[2].u == 0 && v[3].u == 0);
+
+    CHECK(parse(&test_args, "test ram_d1 march", v) == 0);
+    CHECK(v[0].u == 0x24000000 && v[2].u == 0);
+    CHECK(parse(&test_args, "test ram_d1", v) == 0 && v[2].u == 2);
+
+    CHECK(parse(&dump_args, "dump itcm 8", v) == 0);
+    CHECK(v[0].u == 0 && v[1].u == 64 * 1024 && v[2].u == 0);
+    CHECK(parse(&dump_args, "dump itcm 32", v) == 0 && v[2].u == 2);
+
+    // A length after a region is not an enum value
+    CHECK(parse(&dump_args, "dump itcm 100", v) == -EINVAL);
+    CHECK(parse(&crc_args, "crc flash bogus", v) == -EINVAL);
+}
+
+static void test_address_length(void) {
+    uarg_val_t v[4];
+
+    CHECK(parse(&dump_args, "dump 24001000 1f0 16", v) == 0);
+    CHECK(v[0].u == 0x24001000 && v[1].u == 0x1f0 && v[2].u == 1);
+    CHECK(parse(&crc_args, "crc 0x8000000 100 cpu", v) == 0);
+    CHECK(v[0].u == 0x08000000 && v[1].u == 0x100 && v[2].u == 2);
+
+    CHECK(parse(&dump_args, "dump 24001000", v) == -EINVAL);     // no length
+    CHECK(parse(&dump_args, "dump 24001000 zz", v) == -EINVAL);
+    CHECK(parse(&dump_args, "dump fffffff0 20", v) == -EINVAL);  // wraps
+    CHECK(parse(&dump_args, "dump", v) == -EINVAL);
+    CHECK(parse(&dump_args, "dump 0 10 8 9", v) == -EINVAL);     // extra word
+
+    CHECK(parse(&write_args, "write ram_d1 ff", v) == 0 && v[0].u == 0x24000000 && v[1].u == 0xff);
+    CHECK(parse(&write_args, "write 24000000 100", v) == -EINVAL);
+}
+
+static const char *offered[8];
+static int noffered;
+
+static void offer(const char *word) {
+    if (noffered < 8) {
+        offered[noffered++] = word;
+    }
+}
+
+static int complete(const uarg_spec_t *spec, int argn, const char *const *words) {
+    noffered = 0;
+    uarg_complete(spec, argn, words, offer);
+    return noffered;
+}
+
+// Completion counts a region as one word, like the parser
+static void test_complete(void) {
+    const char *const w1[] = {"fl"};
+    const char *const w2[] = {"flash", "d"};
+    const char *const w3[] = {"8000000", "100", "s"};
+    const char *const w4[] = {"8000000", "s"};
+
+    CHECK(complete(&crc_args, 1, w1) == 1 && strcmp(offered[0], "flash") == 0);
+    CHECK(complete(&crc_args, 2, w2) == 1 && strcmp(offered[0], "dma") == 0);
+    CHECK(complete(&crc_args, 3, w3) == 1 && strcmp(offered[0], "sw") == 0);
+    CHECK(complete(&crc_args, 2, w4) == 0);     // that's the length
+}
+
+#define BENCH_ITER 200000
+
+static double bench_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static volatile uint32_t bench_sink;
+
+// uarg against the sscanf calls it replaced
+static void bench_parse(void) {
+    char *argv[] = {"dump", "24001000", "1f0"};
+    const char *words[] = {"24001000", "1f0", "deadBEEF", "7"};
+    unsigned long v;
+    uarg_val_t val[3];
+    double t0, t1;
+
+    // Same values as sscanf first
+    for (int i = 0; i < 4; i++) {
+        uint32_t u = 0;
+        sscanf(words[i], "%lx", &v);
+        CHECK(uarg_hex(words[i], &u) == 0 && u == v);
+    }
+
+    printf("%-28s %8s\n", "path", "ns/op");
+
+    t0 = bench_ns();
+    for (int i = 0; i < BENCH_ITER; i++) {
+        sscanf(words[i & 3], "%lx", &v);
+        bench_sink += (uint32_t)v;
+    }
+    t1 = bench_ns();
+    printf("%-28s %8.1f\n", "sscanf %lx", (t1 - t0) / BENCH_ITER);
+
+    t0 = bench_ns();
+    for (int i = 0; i < BENCH_ITER; i++) {
+        uint32_t u = 0;
+        uarg_hex(words[i & 3], &u);
+        bench_sink += u;
+    }
+    t1 = bench_ns();
+    printf("%-28s %8.1f\n", "uarg_hex", (t1 - t0) / BENCH_ITER);
+
+    t0 = bench_ns();
+    for (int i = 0; i < BENCH_ITER; i++) {
+        sscanf("1024", "%lu", &v);
+        bench_sink += (uint32_t)v;
+    }
+    t1 = bench_ns();
+    printf("%-28s %8.1f\n", "sscanf %lu", (t1 - t0) / BENCH_ITER);
+
+    t0 = bench_ns();
+    for (int i = 0; i < BENCH_ITER; i++) {
+        uint32_t u = 0;
+        uarg_dec("1024", &u);
+        bench_sink += u;
+    }
+    t1 = bench_ns();
+    printf("%-28s %8.1f\n", "uarg_dec", (t1 - t0) / BENCH_ITER);
+
+    t0 = bench_ns();
+    for (int i = 0; i < BENCH_ITER; i++) {
+        unsigned long a, l;
+        if (sscanf(argv[1], "%lx", &a) == 1 && sscanf(argv[2], "%lx", &l) == 1) {
+            bench_sink += (uint32_t)(a + l);
+        }
+    }
+    t1 = bench_ns();
+    printf("%-28s %8.1f\n", "mem dump args, sscanf", (t1 - t0) / BENCH_ITER);
+
+    t0 = bench_ns();
+    for (int i = 0; i < BENCH_ITER; i++) {
+        if (uarg_parse(stdout, &dump_args, 3, argv, val) == 0) {
+            bench_sink += val[0].u + val[1].u;
+        }
+    }
+    t1 = bench_ns();
+    printf("%-28s %8.1f\n", "mem dump args, uarg_parse", (t1 - t0) / BENCH_ITER);
+}
+
+int main(void) {
+    quiet = fopen("/dev/null", "w");
+
+    test_region_enum();
+    test_address_length();
+    test_complete();
+    bench_parse();
+
+    return test_summary("uarg");
+}
@@ -0,0 +1,301 @@
+/* SPDX-License-Identifier: MIT */
+/*
+ * test_uart_tx.c - UART TX descriptor ring against a simulated DMA stream
+ *
+ * dev_uart.c runs unchanged on USART1 / DMA1 stream 1. The stream is
+ * played by sim_step(), called on every WFI: it moves up to sim.rate
+ * bytes from M0AR to the wire, raises TCIF and pends the stream IRQ
+ * when NDTR reaches zero. CTS held by the peer is sim.hold.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "dev_uart.h"
+#include "inc/dev_uart_port.h"
+#include "stm32h743xx.h"
+#include "test.h"
+
+#define WIRE_SIZE   (0x40000U)
+#define DMA_SHIFT   (6U)            // stream 1 flags in LISR
+
+static uint8_t tx_bounce[UART_TX_BUFFER_SIZE] __attribute__((aligned(32)));
+static volatile uint8_t rx_ring[UART_RX_BUFFER_SIZE] __attribute__((aligned(32)));
+static uart_state_t state;
+
+static const uart_port_t port = {
+    .usart = USART1,
+    .irq = USART1_IRQn,
+    .irq_prio = 5U,
+    .rcc_enr = &RCC->APB2ENR,
+    .rcc_en = RCC_APB2ENR_USART1EN,
+    .ker_sel = RCC_D2CCIP2R_USART16SEL,
+    .tx_pin = { GPIOB, 14U, 4U },
+    .rx_pin = { GPIOB, 15U, 4U },
+    .dma_rx = { DMA1_Stream0, DMAMUX1_Channel0, &DMA1->LISR, &DMA1->LIFCR,
+                RCC_AHB1ENR_DMA1EN, DMA1_Stream0_IRQn, 41U, 0U },
+    .dma_tx = { DMA1_Stream1, DMAMUX1_Channel1, &DMA1->LISR, &DMA1->LIFCR,
+                RCC_AHB1ENR_DMA1EN, DMA1_Stream1_IRQn, 42U, DMA_SHIFT },
+    .tx_buf = tx_bounce,
+    .tx_size = UART_TX_BUFFER_SIZE,
+    .rx_buf = rx_ring,
+    .rx_size = UART_RX_BUFFER_SIZE,
+    .state = &state,
+};
+
+static struct {
+    uint8_t wire[WIRE_SIZE];
+    uint32_t sent;
+    uint32_t rate;                  // bytes per step
+    uint8_t hold;                   // CTS deasserted, line stopped
+    uint8_t active;
+    uint32_t base;
+    uint32_t total;
+    uint32_t left;
+    uint32_t bursts[64];
+    uint32_t nbursts;
+    uint32_t steps;
+} sim;
+
+static uint8_t data[0x20000];       // static: 32 bit address with -no-pie
+static uint32_t done_order[UART_TX_QUEUE_LEN * 4];
+static uint32_t done_count;
+
+static void sim_step(void) {
+    DMA_Stream_TypeDef *s = DMA1_Stream1;
+
+    sim.steps++;
+
+    // Flag clear register is write one to clear
+    DMA1->LISR &= ~DMA1->LIFCR;
+    DMA1->LIFCR = 0;
+
+    if (!(s->CR & DMA_SxCR_EN)) {
+        sim.active = 0;
+        return;
+    }
+
+    // New burst, also one restarted by the driver since the last step
+    if (!sim.active || s->M0AR != sim.base || s->NDTR != sim.left) {
+        sim.active = 1;
+        sim.base = s->M0AR;
+        sim.total = s->NDTR;
+        sim.left = s->NDTR;
+        if (sim.nbursts < 64U) {
+            sim.bursts[sim.nbursts++] = sim.total;
+        }
+    }
+
+    if (sim.hold) {
+        return;
+    }
+
+    uint32_t n = sim.left < sim.rate ? sim.left : sim.rate;
+    const uint8_t *src = (const uint8_t *)(uintptr_t)(sim.base + sim.total - sim.left);
+    CHECK(sim.sent + n <= WIRE_SIZE);
+    memcpy(&sim.wire[sim.sent], src, n);
+    sim.sent += n;
+    sim.left -= n;
+    s->NDTR = sim.left;
+    USART1->ISR &= ~USART_ISR_TC;
+
+    if (sim.left == 0) {
+        s->CR &= ~DMA_SxCR_EN;
+        sim.active = 0;
+        USART1->ISR |= USART_ISR_TC;
+        DMA1->LISR |= UART_DMA_TCIF << DMA_SHIFT;
+        host_irq_pend(DMA1_Stream1_IRQn);
+    }
+}
+
+static void dma_tx_irq(void) {
+    uart_port_dma_tx_irq(&port);
+}
+
+static void record_done(void *ctx) {
+    done_order[done_count++] = (uint32_t)(uintptr_t)ctx;
+}
+
+static int pending(void) {
+    int n = 0;
+    uart_port_ioctrl(&port, UART_TX_PENDING, &n);
+    return n;
+}
+
+static void drain(void) {
+    for (uint32_t i = 0; pending() && i < 1000000U; i++) {
+        __WFI();
+    }
+}
+
+static void sim_reset(uint32_t rate) {
+    memset(&sim, 0, sizeof(sim));
+    sim.rate = rate;
+    done_count = 0;
+    uart_port_ioctrl(&port, UART_CLEAR_STATS, NULL);
+}
+
+static uart_tx_desc_t desc(uint32_t offset, uint32_t len, uint32_t id) {
+    uart_tx_desc_t d = {
+        .buf = &data[offset],
+        .len = len,
+        .done = record_done,
+        .ctx = (void *)(uintptr_t)id,
+    };
+    return d;
+}
+
+// Descriptors leave in queue order, one larger than NDTR is split
+static void test_order(void) {
+    static const uint32_t len[] = {1, 300, 0x12345, 17, 4096};
+    uint32_t offset = 0;
+
+    sim_reset(4096);
+    for (uint32_t i = 0; i < 5; i++) {
+        uart_tx_desc_t d = desc(offset, len[i], i);
+        CHECK(uart_port_ioctrl(&port, UART_TX_QUEUE, &d) == 0);
+        offset += len[i];
+    }
+    drain();
+
+    CHECK(sim.sent == offset);
+    CHECK(memcmp(sim.wire, data, offset) == 0);
+    CHECK(done_count == 5);
+    for (uint32_t i = 0; i < done_count; i++) {
+        CHECK(done_order[i] == i);
+    }
+    CHECK(sim.nbursts == 6);
+    CHECK(sim.bursts[2] == 0xFFFFU && sim.bursts[3] == 0x12345U - 0xFFFFU);
+}
+
+// A full ring refuses with -EAGAIN and takes more once a slot is free
+static void test_backpressure(void) {
+    uint32_t offset = 0;
+
+    sim_reset(64);
+    sim.hold = 1;
+    for (uint32_t i = 0; i < UART_TX_QUEUE_LEN; i++) {
+        uart_tx_desc_t d = desc(offset, 100, i);
+        CHECK(uart_port_ioctrl(&port, UART_TX_QUEUE, &d) == 0);
+        offset += 100;
+    }
+    uart_tx_desc_t more = desc(offset, 100, UART_TX_QUEUE_LEN);
+    CHECK(uart_port_ioctrl(&port, UART_TX_QUEUE, &more) == -EAGAIN);
+    CHECK(pending() == (int)UART_TX_QUEUE_LEN);
+
+    sim.hold = 0;
+    while (done_count == 0) {
+        __WFI();
+    }
+    CHECK(uart_port_ioctrl(&port, UART_TX_QUEUE, &more) == 0);
+    drain();
+
+    offset += 100;
+    CHECK(sim.sent == offset);
+    CHECK(memcmp(sim.wire, data, offset) == 0);
+    CHECK(done_count == UART_TX_QUEUE_LEN + 1U);
+    for (uint32_t i = 0; i < done_count; i++) {
+        CHECK(done_order[i] == i);
+    }
+}
+
+// Blocking write sleeps until its descriptor completes, queued ones first
+static void test_write(void) {
+    sim_reset(256);
+    uart_tx_desc_t d = desc(0, 1000, 0);
+    CHECK(uart_port_ioctrl(&port, UART_TX_QUEUE, &d) == 0);
+    CHECK(uart_port_write(&port, &data[1000], 5000) == 5000);
+    CHECK(pending() == 0);
+    CHECK(done_count == 1);
+    CHECK(sim.sent == 6000 && memcmp(sim.wire, data, 6000) == 0);
+    CHECK(sim.steps >= 6000U / 256U);
+}
+
+// With interrupts masked by the caller the ISR can't run, the write
+// runs the handler itself
+static void test_write_masked(void) {
+    uart_stats_t st;
+
+    sim_reset(100);
+    __disable_irq();
+    CHECK(uart_port_write(&port, data, 0x10100) == 0x10100);
+    CHECK(__get_PRIMASK() == 1);
+    __enable_irq();
+
+    CHECK(sim.sent == 0x10100 && memcmp(sim.wire, data, 0x10100) == 0);
+    CHECK(uart_port_ioctrl(&port, INTERFACE_GET_STATUS, &st) == 0);
+    CHECK(st.tx_dma_tc == 2 && st.tx_bytes == 0x10100);
+}
+
+// A stopped line times out instead of hanging, every queued
+// descriptor completes and the port keeps working
+static void test_stall(int masked) {
+    uart_stats_t st;
+
+    sim_reset(64);
+    sim.hold = 1;
+    uart_tx_desc_t d = desc(0, 500, 7);
+    CHECK(uart_port_ioctrl(&port, UART_TX_QUEUE, &d) == 0);
+
+    if (masked) {
+        __disable_irq();
+    }
+    CHECK(uart_port_write(&port, &data[500], 200) == -ETIMEDOUT);
+    if (masked) {
+        __enable_irq();
+    }
+
+    CHECK(done_count == 1 && done_order[0] == 7);
+    CHECK(pending() == 0);
+    CHECK(!(DMA1_Stream1->CR & DMA_SxCR_EN));
+    CHECK(uart_port_ioctrl(&port, INTERFACE_GET_STATUS, &st) == 0);
+    CHECK(st.tx_aborts == 1);
+
+    sim_reset(64);
+    CHECK(uart_port_write(&port, data, 300) == 300);
+    CHECK(sim.sent == 300 && memcmp(sim.wire, data, 300) == 0);
+}
+
+// Reconfiguring with UE = 0 waits for queued TX instead of cutting it
+static void test_set_config(void) {
+    uart_config_t cfg;
+
+    sim_reset(32);
+    for (uint32_t i = 0; i < 3; i++) {
+        uart_tx_desc_t d = desc(i * 700U, 700, i);
+        CHECK(uart_port_ioctrl(&port, UART_TX_QUEUE, &d) == 0);
+    }
+
+    CHECK(uart_port_ioctrl(&port, UART_GET_CONFIG, &cfg) == 0);
+    cfg.fifo = 1;
+    CHECK(uart_port_ioctrl(&port, UART_SET_CONFIG, &cfg) == 0);
+
+    CHECK(pending() == 0 && done_count == 3);
+    CHECK(sim.sent == 2100 && memcmp(sim.wire, data, 2100) == 0);
+    CHECK((USART1->CR1 & (USART_CR1_UE | USART_CR1_FIFOEN)) == (USART_CR1_UE | USART_CR1_FIFOEN));
+    CHECK(__get_PRIMASK() == 0);
+}
+
+int main(void) {
+    for (uint32_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 7U + (i >> 8));
+    }
+
+    // Enable acknowledges and an idle transmitter
+    USART1->ISR = USART_ISR_TEACK | USART_ISR_REACK | USART_ISR_TC | USART_ISR_TXE_TXFNF;
+    host_irq_attach(DMA1_Stream1_IRQn, dma_tx_irq);
+    host_wfi_hook(sim_step);
+    alarm(20);
+
+    CHECK(uart_port_open(&port) == 0);
+    test_order();
+    test_backpressure();
+    test_write();
+    test_write_masked();
+    test_stall(0);
+    test_stall(1);
+    test_set_config();
+
+    return test_summary("uart_tx");
+}
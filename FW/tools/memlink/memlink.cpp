@@ -0,0 +1,611 @@
+/**
+ * @file memlink.cpp
+ * @brief Host end of mem get/put: memory regions to and from files over
+ *        the CLI UART, framing in app/mem/mem_link.h
+ * @author Mikhael Kaa (Михаил Каа)
+ * @date 17.10.2026
+ *
+ *   g++ -O2 -std=c++17 tools/memlink/memlink.cpp -o memlink
+ *   memlink get <port> <baud> <adr> <len> <file> [--resume]
+ *   memlink put <port> <baud> <adr> <file> [--offset <n>]
+ *
+ * Values in hex like on the CLI. The CLI must be at its prompt. A get
+ * with --resume keeps the file and continues at its size, the crc at
+ * the end still covers all of it. A put that broke off prints the
+ * acknowledged offset to pass to --offset
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace
+{
+
+// Must match app/mem/mem_link.h
+constexpr uint8_t  SOF        = 0xa5;
+constexpr size_t   HDR        = 8;
+constexpr size_t   CHUNK_MAX  = 1024;
+constexpr unsigned TIMEOUT_MS = 500;
+constexpr int      IDLE_MS    = 50;
+constexpr unsigned RETRIES    = 10;
+
+enum Type : uint8_t
+{
+    HELLO = 'H',
+    DATA  = 'D',
+    ACK   = 'A',
+    NAK   = 'N',
+    END   = 'E',
+    ABORT = 'X',
+};
+
+uint32_t crc32(uint32_t crc, const uint8_t* p, size_t len)
+{
+    static uint32_t table[256];
+
+    if (table[1] == 0)
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+            {
+                c = (c & 1U) ? (c >> 1) ^ 0xedb88320U : c >> 1;
+            }
+            table[i] = c;
+        }
+    }
+    crc = ~crc;
+    while (len--)
+    {
+        crc = table[(crc ^ *p++) & 0xffU] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+uint32_t get16(const uint8_t* p)
+{
+    return uint32_t(p[0]) | uint32_t(p[1]) << 8;
+}
+
+uint32_t get32(const uint8_t* p)
+{
+    return get16(p) | get16(p + 2) << 16;
+}
+
+void put32(uint8_t* p, uint32_t v)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        p[i] = uint8_t(v >> (8 * i));
+    }
+}
+
+uint64_t now_ms()
+{
+    using namespace std::chrono;
+    return uint64_t(duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+speed_t baud_flag(unsigned long baud)
+{
+    switch (baud)
+    {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    case 230400: return B230400;
+#ifdef B460800
+    case 460800: return B460800;
+    case 921600: return B921600;
+    case 1000000: return B1000000;
+    case 2000000: return B2000000;
+    case 3000000: return B3000000;
+    case 4000000: return B4000000;
+#endif
+    default: throw std::runtime_error("unsupported baud rate " + std::to_string(baud));
+    }
+}
+
+// Raw serial port, 8N1, no flow control
+class Port
+{
+  public:
+    Port(const std::string& path, unsigned long baud)
+    {
+        fd_ = ::open(path.c_str(), O_RDWR | O_NOCTTY);
+        if (fd_ < 0)
+        {
+            throw std::runtime_error(path + ": " + std::strerror(errno));
+        }
+        termios tio{};
+        tcgetattr(fd_, &tio);
+        cfmakeraw(&tio);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cflag &= ~tcflag_t(CRTSCTS | CSTOPB);
+        cfsetispeed(&tio, baud_flag(baud));
+        cfsetospeed(&tio, baud_flag(baud));
+        if (tcsetattr(fd_, TCSANOW, &tio) < 0)
+        {
+            throw std::runtime_error(path + ": " + std::strerror(errno));
+        }
+        tcflush(fd_, TCIOFLUSH);
+    }
+
+    ~Port()
+    {
+        ::close(fd_);
+    }
+
+    Port(const Port&)            = delete;
+    Port& operator=(const Port&) = delete;
+
+    void write(const void* buf, size_t len)
+    {
+        auto p = static_cast<const uint8_t*>(buf);
+        while (len)
+        {
+            ssize_t n = ::write(fd_, p, len);
+            if (n < 0 && errno != EINTR)
+            {
+                throw std::runtime_error(std::string("write: ") + std::strerror(errno));
+            }
+            if (n > 0)
+            {
+                p += n;
+                len -= size_t(n);
+            }
+        }
+    }
+
+    // Whatever arrives within @timeout_ms, 0 if nothing did
+    size_t read(uint8_t* buf, size_t len, int timeout_ms)
+    {
+        pollfd pfd{fd_, POLLIN, 0};
+        if (::poll(&pfd, 1, timeout_ms) <= 0)
+        {
+            return 0;
+        }
+        ssize_t n = ::read(fd_, buf, len);
+        return n > 0 ? size_t(n) : 0;
+    }
+
+  private:
+    int fd_;
+};
+
+struct Frame
+{
+    uint8_t              type = 0;
+    uint32_t             off  = 0;
+    std::vector<uint8_t> data;
+};
+
+// Frames over a Port: SOF hunt, length and crc checks, bad ones dropped
+class Link
+{
+  public:
+    explicit Link(Port& port) : port_(port) {}
+
+    void send(uint8_t type, uint32_t off, const uint8_t* payload = nullptr, size_t len = 0)
+    {
+        std::vector<uint8_t> f(HDR + len + 4);
+        f[0] = SOF;
+        f[1] = type;
+        f[2] = uint8_t(len);
+        f[3] = uint8_t(len >> 8);
+        put32(&f[4], off);
+        if (len)
+        {
+            std::memcpy(&f[HDR], payload, len);
+        }
+        put32(&f[HDR + len], crc32(0, &f[1], HDR - 1 + len));
+        port_.write(f.data(), f.size());
+    }
+
+    void send_crc(uint8_t type, uint32_t off, uint32_t crc)
+    {
+        uint8_t p[4];
+        put32(p, crc);
+        send(type, off, p, sizeof(p));
+    }
+
+    // Next good frame within @timeout_ms, false on timeout
+    bool recv(Frame& f, int timeout_ms)
+    {
+        uint64_t end = now_ms() + uint64_t(timeout_ms);
+        for (;;)
+        {
+            if (take(f))
+            {
+                return true;
+            }
+            // Reads at least once, 0 only looks at what is there. A
+            // frame cut short is dropped after IDLE_MS
+            uint64_t now  = now_ms();
+            int      left = now < end ? int(end - now) : 0;
+            bool     part = !rx_.empty() && left > IDLE_MS;
+            uint8_t  buf[4096];
+            size_t   n = port_.read(buf, sizeof(buf), part ? IDLE_MS : left);
+            if (n == 0 && part)
+            {
+                drop();
+                continue;
+            }
+            if (n == 0 && left == 0)
+            {
+                return false;
+            }
+            rx_.insert(rx_.end(), buf, buf + n);
+        }
+    }
+
+    unsigned long bad = 0;
+
+  private:
+    bool take(Frame& f)
+    {
+        for (;;)
+        {
+            size_t sof = 0;
+            while (sof < rx_.size() && rx_[sof] != SOF)
+            {
+                sof++;
+            }
+            rx_.erase(rx_.begin(), rx_.begin() + long(sof));
+            if (rx_.size() < HDR)
+            {
+                return false;
+            }
+            size_t n = get16(&rx_[2]);
+            if (n > CHUNK_MAX)
+            {
+                drop();
+                continue;
+            }
+            if (rx_.size() < HDR + n + 4)
+            {
+                return false;
+            }
+            // A whole frame that fails is bad, a false SOF met on the
+            // way to the next one isn't counted
+            if (crc32(0, &rx_[1], HDR - 1 + n) != get32(&rx_[HDR + n]))
+            {
+                bad++;
+                drop();
+                continue;
+            }
+            f.type = rx_[1];
+            f.off  = get32(&rx_[4]);
+            f.data.assign(rx_.begin() + HDR, rx_.begin() + long(HDR + n));
+            rx_.erase(rx_.begin(), rx_.begin() + long(HDR + n + 4));
+            return true;
+        }
+    }
+
+    void drop()
+    {
+        rx_.erase(rx_.begin());
+    }
+
+    Port&                port_;
+    std::vector<uint8_t> rx_;
+};
+
+struct Hello
+{
+    uint32_t addr, len, chunk, window;
+};
+
+// Type the command, skip its echo and the prompt up to HELLO. Ctrl+U
+// first clears what is on the line. Typed again if it got lost, or the
+// device was still closing the last transfer
+Hello start(Port& port, Link& link, const char* op, uint32_t addr, uint32_t len)
+{
+    char     cmd[64];
+    int      n     = std::snprintf(cmd, sizeof(cmd), "\x15mem %s %x %x\r", op, addr, len);
+    uint64_t typed = 0;
+    int      tries = 0;
+
+    Frame f;
+    for (;;)
+    {
+        if (now_ms() - typed >= 3 * TIMEOUT_MS)
+        {
+            if (tries++ == 3)
+            {
+                throw std::runtime_error("no answer, is the CLI at its prompt?");
+            }
+            port.write(cmd, size_t(n));
+            typed = now_ms();
+        }
+        if (!link.recv(f, int(TIMEOUT_MS)))
+        {
+            continue;
+        }
+        if (f.type == HELLO && f.data.size() == 12)
+        {
+            Hello h{get32(&f.data[0]), get32(&f.data[4]), get16(&f.data[8]), get16(&f.data[10])};
+            if (h.len != len || h.chunk == 0 || h.chunk > CHUNK_MAX || h.window == 0)
+            {
+                link.send(ABORT, 0);
+                throw std::runtime_error("device answered with a different transfer");
+            }
+            return h;
+        }
+    }
+}
+
+// A few times a second, and at the end
+void progress(const char* op, uint32_t done, uint32_t len, uint64_t t0)
+{
+    static uint64_t shown;
+    uint64_t        now = now_ms();
+    uint64_t        ms  = now - t0;
+
+    if (done < len && now - shown < 200)
+    {
+        return;
+    }
+    shown = now;
+    std::fprintf(stderr, "\r%s %u/%u bytes, %llu KB/s ", op, done, len,
+                 (unsigned long long)(ms ? uint64_t(done) * 1000 / 1024 / ms : 0));
+}
+
+int get(Port& port, uint32_t addr, uint32_t len, const std::string& path, bool resume)
+{
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    if (!file || !resume)
+    {
+        file.close();
+        file.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    }
+    if (!file)
+    {
+        throw std::runtime_error(path + ": can't open");
+    }
+    file.seekg(0, std::ios::end);
+    uint32_t have = resume ? uint32_t(std::min<std::streamoff>(file.tellg(), len)) : 0;
+
+    Link     link(port);
+    Hello    h        = start(port, link, "get", addr, len);
+    uint32_t expected = have;
+    uint32_t top      = 0;          // highest offset seen
+    uint32_t nacked   = UINT32_MAX; // offset NAKed at, see struct mem_link
+    unsigned quiet    = 0;
+    uint64_t t0       = now_ms();
+    Frame    f;
+
+    link.send(ACK, expected);
+    for (;;)
+    {
+        // A bad frame is a gap, no need to wait for the next one
+        unsigned long bad = link.bad;
+        bool          got = link.recv(f, IDLE_MS);
+        if (link.bad != bad && nacked == UINT32_MAX)
+        {
+            nacked = top;
+            link.send(NAK, expected);
+        }
+        // The device streams, a quiet line means it waits for an ACK
+        // that got lost or the tail of the window did
+        if (!got)
+        {
+            if (++quiet > RETRIES * TIMEOUT_MS / IDLE_MS)
+            {
+                std::fprintf(stderr, "\ntimed out at %x, --resume continues\n", expected);
+                return 1;
+            }
+            link.send(NAK, expected);
+            continue;
+        }
+        quiet = 0;
+        if (f.type == HELLO)
+        {
+            link.send(ACK, expected); // the first ACK got lost
+        }
+        else if (f.type == DATA && f.off == expected && f.data.size() <= len - expected)
+        {
+            file.seekp(expected);
+            file.write(reinterpret_cast<const char*>(f.data.data()), long(f.data.size()));
+            expected += uint32_t(f.data.size());
+            top     = std::max(top, f.off);
+            nacked  = UINT32_MAX;
+            link.send(ACK, expected);
+            progress("get", expected, len, t0);
+        }
+        else if (f.type == DATA && f.off > expected)
+        {
+            // Once per go-back, the frames in flight before it don't count
+            top = std::max(top, f.off);
+            if (f.off <= nacked)
+            {
+                nacked = f.off;
+                link.send(NAK, expected);
+            }
+        }
+        else if (f.type == END && f.data.size() == 4 && expected == len)
+        {
+            break;
+        }
+        else if (f.type == ABORT)
+        {
+            std::fprintf(stderr, "\ndevice aborted at %x, --resume continues\n", expected);
+            return 1;
+        }
+    }
+
+    // The crc covers the whole range, resumed parts too
+    std::vector<uint8_t> all(len);
+    file.flush();
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(all.data()), len);
+    uint32_t crc  = crc32(0, all.data(), len);
+    uint32_t want = get32(f.data.data());
+    if (crc != want)
+    {
+        link.send(ABORT, len);
+        std::fprintf(stderr, "\ncrc %08x, device has %08x%s\n", crc, want, have ? ", get it again without --resume" : "");
+        return 1;
+    }
+
+    progress("get", len, len, t0);
+
+    // Stay a little, in case the device missed the ACK and repeats END
+    link.send_crc(ACK, len, crc);
+    while (link.recv(f, TIMEOUT_MS * 2))
+    {
+        if (f.type == END)
+        {
+            link.send_crc(ACK, len, crc);
+        }
+    }
+    std::fprintf(stderr, "\n%08x..%08x crc %08x, %lu bad frames\n", h.addr, h.addr + len, crc, link.bad);
+    return 0;
+}
+
+int put(Port& port, uint32_t addr, const std::string& path, uint32_t offset)
+{
+    std::ifstream        file(path, std::ios::binary);
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (!file && !file.eof())
+    {
+        throw std::runtime_error(path + ": can't read");
+    }
+    if (offset >= data.size())
+    {
+        throw std::runtime_error("nothing to send past the offset");
+    }
+    data.erase(data.begin(), data.begin() + offset);
+
+    uint32_t len     = uint32_t(data.size());
+    Link     link(port);
+    Hello    h       = start(port, link, "put", addr + offset, len);
+    uint32_t crc     = crc32(0, data.data(), len);
+    uint32_t next    = 0;
+    uint32_t acked   = 0;
+    bool     ended   = false;
+    unsigned retries = 0;
+    uint64_t t0      = now_ms();
+    uint64_t seen    = t0;
+    Frame    f;
+
+    for (;;)
+    {
+        bool more = !ended && next < len && next - acked < h.window * h.chunk;
+        if (more)
+        {
+            uint32_t n = std::min<uint32_t>(h.chunk, len - next);
+            link.send(DATA, next, &data[next], n);
+            next += n;
+        }
+        if (!link.recv(f, more ? 0 : 50))
+        {
+            if (now_ms() - seen < TIMEOUT_MS)
+            {
+                continue;
+            }
+            seen = now_ms();
+            if (++retries > RETRIES)
+            {
+                std::fprintf(stderr, "\ntimed out, %x acknowledged: --offset %x\n", acked, offset + acked);
+                return 1;
+            }
+            if (ended)
+            {
+                link.send_crc(END, len, crc);
+            }
+            next = acked; // go back
+            continue;
+        }
+        if (f.type == ACK && ended && f.off == len && f.data.size() == 4 && get32(f.data.data()) == crc)
+        {
+            link.send(ACK, len); // the device may go back to its prompt
+            break;
+        }
+        if ((f.type == ACK || f.type == NAK) && f.off >= acked && f.off <= len)
+        {
+            if (f.off > acked)
+            {
+                seen    = now_ms();
+                retries = 0;
+            }
+            acked = f.off;
+            if (f.type == NAK || next < acked)
+            {
+                next = acked;
+            }
+            progress("put", acked, len, t0);
+            if (acked == len && !ended)
+            {
+                ended = true;
+                seen  = now_ms();
+                link.send_crc(END, len, crc);
+            }
+        }
+        else if (f.type == ABORT)
+        {
+            std::fprintf(stderr, "\ndevice aborted%s, %x acknowledged: --offset %x\n",
+                         ended ? " on a crc mismatch" : "", acked, offset + acked);
+            return 1;
+        }
+    }
+    std::fprintf(stderr, "\n%08x..%08x crc %08x, %lu bad frames\n", h.addr, h.addr + len, crc, link.bad);
+    return 0;
+}
+
+int usage()
+{
+    std::fprintf(stderr, "memlink get <port> <baud> <adr> <len> <file> [--resume]\n"
+                         "memlink put <port> <baud> <adr> <file> [--offset <n>]\n"
+                         "values in hex\n");
+    return 2;
+}
+
+uint32_t hex(const char* s)
+{
+    return uint32_t(std::stoul(s, nullptr, 16));
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        std::vector<std::string> a(argv + 1, argv + argc);
+        if (a.size() >= 6 && a[0] == "get")
+        {
+            Port port(a[1], std::stoul(a[2]));
+            return get(port, hex(a[3].c_str()), hex(a[4].c_str()), a[5], a.size() > 6 && a[6] == "--resume");
+        }
+        if (a.size() >= 5 && a[0] == "put")
+        {
+            Port     port(a[1], std::stoul(a[2]));
+            uint32_t offset = a.size() > 6 && a[5] == "--offset" ? hex(a[6].c_str()) : 0;
+            return put(port, hex(a[3].c_str()), a[4], offset);
+        }
+        return usage();
+    }
+    catch (const std::exception& e)
+    {
+        std::fprintf(stderr, "memlink: %s\n", e.what());
+        return 1;
+    }
+}